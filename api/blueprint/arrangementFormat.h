@@ -0,0 +1,21 @@
+#ifndef ARRANGEMENT_FORMAT_18_OCT_2026
+#define ARRANGEMENT_FORMAT_18_OCT_2026
+
+#include "blueprint/cgalSettings.h"
+
+#include <ostream>
+#include <istream>
+
+namespace Blueprint
+{
+    enum ArrangementFormat
+    {
+        eArrFormat_Text,    //Arr_extended_dcel_text_formatter
+        eArrFormat_Binary   //compact DCEL tables with exact coordinates
+    };
+    
+    void writeArrangement( std::ostream& os, const Arrangement& arr, ArrangementFormat format );
+    void readArrangement( std::istream& is, Arrangement& arr, ArrangementFormat format );
+}
+
+#endif //ARRANGEMENT_FORMAT_18_OCT_2026
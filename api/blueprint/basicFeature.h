@@ -50,6 +50,8 @@ public:
     virtual void save( Ed::Node& node ) const;
     virtual std::string getStatement() const { return ""; }
     
+    //replaces the geometry with copies sharing no kernel representation with any other
+    virtual void isolateGeometry() {}
 };
 
 /////////////////////////////////////////////////////////////////
@@ -67,6 +69,7 @@ public:
     virtual void load( Factory& factory, const Ed::Node& node );
     virtual void save( Ed::Node& node ) const;
     virtual std::string getStatement() const;
+    virtual void isolateGeometry();
     
     //ControlPointCallback
     const GlyphSpec* getParent( int id ) const;
@@ -128,6 +131,7 @@ public:
     void set( int id, Float fX, Float fY );
     void setSinglePoint( Float x, Float y );
     void set( const Polygon& shape );
+    virtual void isolateGeometry();
     
     /*
     template< class T >
@@ -0,0 +1,68 @@
+#ifndef BINARY_IO_18_OCT_2026
+#define BINARY_IO_18_OCT_2026
+
+#include "common/assert_verify.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace Blueprint
+{
+    //little endian fixed width values regardless of the host
+    inline void writeUInt32( std::ostream& os, std::uint32_t value )
+    {
+        char buffer[ 4U ];
+        for( std::size_t sz = 0U; sz != 4U; ++sz )
+            buffer[ sz ] = static_cast< char >( ( value >> ( 8U * sz ) ) & 0xFF );
+        os.write( buffer, 4U );
+    }
+    
+    inline std::uint32_t readUInt32( std::istream& is )
+    {
+        char buffer[ 4U ];
+        VERIFY_RTE_MSG( is.read( buffer, 4U ), "Unexpected end of binary data" );
+        std::uint32_t value = 0U;
+        for( std::size_t sz = 0U; sz != 4U; ++sz )
+            value |= static_cast< std::uint32_t >( static_cast< unsigned char >( buffer[ sz ] ) ) << ( 8U * sz );
+        return value;
+    }
+    
+    //guards a resize by a count read from the stream.  The count must fit the limit and
+    //the stream must hold at least that many values of the given size when it can seek
+    inline void verifyAvailable( std::istream& is, std::uint64_t uiCount, std::uint64_t uiBytesEach )
+    {
+        static const std::uint64_t MAX_BYTES = 1ULL << 40;
+        VERIFY_RTE_MSG( uiBytesEach && uiCount <= MAX_BYTES / uiBytesEach, 
+            "Invalid binary data count: " << uiCount );
+        
+        const std::istream::pos_type pos = is.tellg();
+        if( pos != std::istream::pos_type( -1 ) )
+        {
+            is.seekg( 0, std::ios_base::end );
+            const std::istream::pos_type end = is.tellg();
+            is.seekg( pos );
+            VERIFY_RTE_MSG( end != std::istream::pos_type( -1 ) && 
+                static_cast< std::uint64_t >( end - pos ) >= uiCount * uiBytesEach,
+                "Unexpected end of binary data" );
+        }
+    }
+    
+    inline void writeFloat( std::ostream& os, float value )
+    {
+        std::uint32_t bits;
+        std::memcpy( &bits, &value, sizeof( bits ) );
+        writeUInt32( os, bits );
+    }
+    
+    inline float readFloat( std::istream& is )
+    {
+        const std::uint32_t bits = readUInt32( is );
+        float value;
+        std::memcpy( &value, &bits, sizeof( value ) );
+        return value;
+    }
+}
+
+#endif //BINARY_IO_18_OCT_2026
@@ -0,0 +1,29 @@
+#ifndef BOUNDS_GRID_18_OCT_2026
+#define BOUNDS_GRID_18_OCT_2026
+
+#include <vector>
+#include <cstdint>
+
+namespace Blueprint
+{
+
+//uniform grid of the items overlapping each bucket sized for roughly one item per bucket.
+//Items are given by their bounds as min x, min y, max x, max y
+class BoundsGrid
+{
+public:
+    BoundsGrid();
+    BoundsGrid( const std::vector< float >& bounds );
+    
+    //items whose bounds overlap the bucket of the point.  Empty when it is off the grid
+    void find( float fX, float fY, const std::uint32_t*& pBegin, const std::uint32_t*& pEnd ) const;
+    
+private:
+    float m_fMinX = 0.0f, m_fMinY = 0.0f, m_fBucketSize = 1.0f;
+    std::uint32_t m_uColumns = 0U, m_uRows = 0U;
+    std::vector< std::uint32_t > m_bucketStart, m_bucketItems;
+};
+
+}
+
+#endif //BOUNDS_GRID_18_OCT_2026
@@ -0,0 +1,67 @@
+#ifndef CELL_COMPLEX_18_OCT_2026
+#define CELL_COMPLEX_18_OCT_2026
+
+#include "blueprint/navMesh.h"
+#include "blueprint/boundsGrid.h"
+
+#include <boost/optional.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace Blueprint
+{
+
+//convex partition of the walkable floor by Hertel-Mehlhorn over the nav mesh.  Diagonals
+//are removed whenever both of their end points stay convex so there are at most four
+//times the optimal number of cells.  Cells are counter clockwise and edge k of a cell
+//runs from vertex k to vertex k + 1 with the neighbouring cell across it or NO_CELL
+class CellComplex
+{
+public:
+    static constexpr std::uint32_t NO_CELL = 0xFFFFFFFF;
+    
+    CellComplex();
+    CellComplex( const NavMesh& navMesh );
+    
+    std::size_t getCellCount() const { return m_cellStarts.empty() ? 0U : m_cellStarts.size() - 1U; }
+    
+    //x, y pairs
+    const std::vector< float >& getVertices() const { return m_vertices; }
+    
+    const std::uint32_t* verticesBegin( std::uint32_t uCell ) const { return m_cellVertices.data() + m_cellStarts[ uCell ]; }
+    const std::uint32_t* verticesEnd( std::uint32_t uCell ) const { return m_cellVertices.data() + m_cellStarts[ uCell + 1U ]; }
+    const std::uint32_t* neighboursBegin( std::uint32_t uCell ) const { return m_cellNeighbours.data() + m_cellStarts[ uCell ]; }
+    const std::uint32_t* neighboursEnd( std::uint32_t uCell ) const { return m_cellNeighbours.data() + m_cellStarts[ uCell + 1U ]; }
+    
+    //half plane tests against the edges of the cell including its boundary
+    bool contains( std::uint32_t uCell, float fX, float fY ) const;
+    
+    boost::optional< std::uint32_t > findCell( float fX, float fY ) const;
+    
+    //any two points within the same cell can see each other.  Only that case is detected so
+    //points in different cells are reported unreachable even when the segment stays on the floor
+    bool isStraightReachable( float fStartX, float fStartY, float fEndX, float fEndY ) const;
+    
+    void save( std::ostream& os ) const;
+    void load( std::istream& is );
+    
+private:
+    void calculateBounds();
+    
+    std::vector< float > m_vertices;
+    std::vector< std::uint32_t > m_cellStarts;
+    std::vector< std::uint32_t > m_cellVertices;
+    std::vector< std::uint32_t > m_cellNeighbours;
+    //min x, min y, max x, max y per cell
+    std::vector< float > m_bounds;
+    
+    //cells overlapping each bucket
+    BoundsGrid m_grid;
+};
+
+}
+
+#endif //CELL_COMPLEX_18_OCT_2026
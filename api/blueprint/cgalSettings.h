@@ -2,7 +2,13 @@
 #ifndef CGAL_SETINGS_26_NOV_2020
 #define CGAL_SETINGS_26_NOV_2020
 
+#include <CGAL/version.h>
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#ifdef BLUEPRINT_RATIONAL_KERNEL
+#include <CGAL/Filtered_kernel.h>
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/Exact_rational.h>
+#endif
 //#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 //#include <CGAL/Simple_cartesian.h>
 //#include <CGAL/Exact_rational.h>
@@ -72,7 +78,24 @@ namespace Blueprint
     //typedef CGAL::Cartesian< Number_type >                        Kernel;
     //typedef CGAL::Simple_cartesian< Number_type >                 Kernel;
     //typedef CGAL::Exact_predicates_inexact_constructions_kernel   Kernel;
+#ifdef BLUEPRINT_RATIONAL_KERNEL
+    //blueprint coordinates are quantised to integers and halves so exact rationals stay small.
+    //The filtered non-lazy kernel avoids the construction DAG allocated by Epeck
+    typedef CGAL::Filtered_kernel<
+        CGAL::Simple_cartesian< CGAL::Exact_rational > >            Kernel;
+#else
     typedef CGAL::Exact_predicates_exact_constructions_kernel       Kernel;
+#endif
+    
+    //copies of kernel numbers share reference counted representations and Epeck
+    //shares its lazy construction DAG.  Geometry may only be used from several threads
+    //once CGAL makes both thread safe, which is from 5.5 when built with CGAL_HAS_THREADS.
+    //Parallel stages run on the calling thread otherwise
+#if CGAL_VERSION_NR >= 1050500000 && defined( CGAL_HAS_THREADS )
+    static constexpr bool KERNEL_IS_THREAD_SAFE = true;
+#else
+    static constexpr bool KERNEL_IS_THREAD_SAFE = false;
+#endif
     
     typedef Kernel::Aff_transformation_2                            Transform;
     typedef Kernel::Line_2                                          Line;
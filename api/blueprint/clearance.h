@@ -0,0 +1,58 @@
+#ifndef CLEARANCE_18_OCT_2026
+#define CLEARANCE_18_OCT_2026
+
+#include "blueprint/buffer.h"
+
+#include <vector>
+#include <istream>
+#include <ostream>
+
+namespace Blueprint
+{
+
+class FloorAnalysis;
+
+//per pixel distance to the nearest pixel outside of the floor from the floor face 
+//rasterised at the resolution in world units per pixel.  Accurate to the pixel size
+class ClearanceField
+{
+public:
+    ClearanceField();
+    ClearanceField( const FloorAnalysis& floor, float fResolution );
+    
+    unsigned int getWidth() const { return m_uiWidth; }
+    unsigned int getHeight() const { return m_uiHeight; }
+    float getResolution() const { return m_fResolution; }
+    float getOriginX() const { return m_fOriginX; }
+    float getOriginY() const { return m_fOriginY; }
+    
+    //zero outside of the floor
+    float getClearance( float fX, float fY ) const
+    {
+        const float fColumn = ( fX - m_fOriginX ) / m_fResolution;
+        const float fRow    = ( fY - m_fOriginY ) / m_fResolution;
+        if( !( fColumn >= 0.0f && fRow >= 0.0f && fColumn < m_uiWidth && fRow < m_uiHeight ) )
+            return 0.0f;
+        return m_clearance[ static_cast< unsigned int >( fRow ) * m_uiWidth + static_cast< unsigned int >( fColumn ) ];
+    }
+    
+    bool hasClearance( float fX, float fY, float fRadius ) const
+    {
+        return getClearance( fX, fY ) >= fRadius;
+    }
+    
+    //exact squared euclidean distance in pixels from each pixel to the nearest zero pixel
+    static void calculateSquaredDistances( const NavBitmap& bitmap, std::vector< float >& distances );
+    
+    void save( std::ostream& os ) const;
+    void load( std::istream& is );
+    
+private:
+    unsigned int m_uiWidth = 0U, m_uiHeight = 0U;
+    float m_fOriginX = 0.0f, m_fOriginY = 0.0f, m_fResolution = 1.0f;
+    std::vector< float > m_clearance;
+};
+
+}
+
+#endif //CLEARANCE_18_OCT_2026
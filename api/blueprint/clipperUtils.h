@@ -0,0 +1,29 @@
+#ifndef CLIPPER_UTILS_18_OCT_2026
+#define CLIPPER_UTILS_18_OCT_2026
+
+#include "blueprint/cgalSettings.h"
+#include "blueprint/offsetCache.h"
+
+#include <vector>
+
+namespace Blueprint
+{
+
+    //integer offsets and booleans with clipper for the common case of axis aligned 
+    //polygons on the half unit grid where every result vertex is also on the grid and 
+    //so exact.  Each returns false for any other input or when the result does not have 
+    //the shape the exact kernel would produce and the caller falls back to the kernel
+    namespace Clipper
+    {
+    
+        bool calculateOffsets( const Polygon& contour, const Kernel::FT& wallWidth, OffsetCache::Offsets& offsets );
+        
+        //outer boundaries of the union of the polygons each clipped to the interior
+        bool clipUnion( const std::vector< Polygon >& polygons, const Polygon& interior, 
+            std::vector< Polygon >& results );
+        
+    }
+        
+}
+
+#endif //CLIPPER_UTILS_18_OCT_2026
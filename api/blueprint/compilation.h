@@ -7,25 +7,149 @@
 #include "blueprint/space.h"
 #include "blueprint/spacePolyInfo.h"
 #include "blueprint/cgalSettings.h"
+#include "blueprint/arrangementFormat.h"
 
 #include "boost/shared_ptr.hpp"
 #include "boost/filesystem/path.hpp"
 
 #include <memory>
 #include <map>
+#include <set>
+#include <vector>
 
 namespace Blueprint
 {
     class Blueprint;
     
+    class Compilation;
+    class Connection;
+    
+    //retains the compiled arrangement between compilations.  Only the curves of sites
+    //whose modification ticks changed are diffed and replaced, and only the connections
+    //near replaced walls are cut again, so an edit costs what it touches.  Walls removed
+    //for a doorway are restored by patch curves when their connection is undone
+    class IncrementalCompiler
+    {
+        friend class Compilation;
+    public:
+        struct Statistics
+        {
+            std::size_t szSitesUnchanged    = 0U;
+            std::size_t szSitesUpdated      = 0U;
+            std::size_t szSitesRemoved      = 0U;
+            std::size_t szCurvesRemoved     = 0U;
+            std::size_t szCurvesInserted    = 0U;
+            std::size_t szConnectionsCut    = 0U;
+        };
+        
+        void update( boost::shared_ptr< Blueprint > pBlueprint );
+        
+        const Arrangement& getArrangement() const { return m_arr; }
+        const Statistics& getStatistics() const { return m_statistics; }
+        
+    private:
+        using CurveVector = std::vector< Curve >;
+        using CurveHandleVector = std::vector< Curve_handle >;
+        //curve addresses are reused once removed so walls and patches are known by an
+        //id which is never reused
+        using CurveId = std::size_t;
+        
+        struct InsertedCurve
+        {
+            Curve curve;
+            Curve_handle hCurve;
+        };
+        using InsertedCurveVector = std::vector< InsertedCurve >;
+        
+        struct SiteCurves
+        {
+            Timing::UpdateTick tick;
+            Transform transform;
+            InsertedCurveVector interior, contour;
+            bool bVisited = false;
+        };
+        using SiteCurveMap = std::map< Site::Ptr, SiteCurves >;
+        
+        //wall piece removed for a doorway and the walls it belonged to
+        struct Doorway
+        {
+            Curve curve;
+            std::vector< CurveId > owners;
+        };
+        struct ConnectionCurves
+        {
+            Timing::UpdateTick tick;
+            Transform transform;
+            CGAL::Bbox_2 bounds;
+            CurveHandleVector curves;
+            std::vector< Doorway > doorways;
+            bool bVisited = false, bDirty = false, bCut = false;
+        };
+        using ConnectionMap = std::map< Site::Ptr, ConnectionCurves >;
+        
+        //restores a doorway of an undone connection for as long as its walls remain
+        struct Patch
+        {
+            Curve_handle hCurve;
+            std::vector< CurveId > owners;
+        };
+        using PatchMap = std::map< CurveId, Patch >;
+        
+        struct Changes
+        {
+            CurveHandleVector removedInterior, removedContour;
+            CurveVector addedInterior, addedContour;
+            std::vector< InsertedCurveVector* > addedInteriorOwners, addedContourOwners;
+            //bounds of the removed and added walls
+            std::vector< CGAL::Bbox_2 > bounds;
+            //every connection in tree order
+            std::vector< ConnectionMap::iterator > connections;
+        };
+        
+        void recurse( Site::Ptr pSite, const Transform& parentTransform, 
+            const boost::optional< DiscreteTransform >& parentDiscrete, Changes& changes );
+        static void diff( InsertedCurveVector& existing, const CurveVector& rendered,
+            CurveHandleVector& removed, InsertedCurveVector* pOwner, 
+            CurveVector& added, std::vector< InsertedCurveVector* >& addedOwners,
+            std::vector< CGAL::Bbox_2 >* pBounds );
+        void insert( const CurveVector& curves, const std::vector< InsertedCurveVector* >& owners, bool bWalls );
+        void removeWall( Curve_handle hCurve );
+        CurveId track( Curve_handle hCurve );
+        CurveId untrack( Curve_handle hCurve );
+        void cut( boost::shared_ptr< Connection > pConnection, ConnectionCurves& connectionCurves );
+        void uncut( ConnectionCurves& connectionCurves );
+        
+        Arrangement m_arr;
+        SiteCurveMap m_sites;
+        ConnectionMap m_connections;
+        PatchMap m_patches;
+        //ids of the live walls and patches by curve address
+        std::map< const Curve*, CurveId > m_curveIds;
+        CurveId m_nextCurveId = 0U;
+        std::set< CurveId > m_walls;
+        Statistics m_statistics;
+    };
+    
     class Compilation
     {
         friend class Analysis;
+        friend class IncrementalCompiler;
         Compilation();
     public:
         Compilation( boost::shared_ptr< Blueprint > pBlueprint );
+        //copies the arrangement of the compiler so is unaffected by its later updates
+        Compilation( IncrementalCompiler& compiler, boost::shared_ptr< Blueprint > pBlueprint );
+        
+        using CurveVector = std::vector< Curve >;
         
-        static void renderContour( Arrangement& arr, const Transform& transform, const Polygon& poly );
+        //collect the transformed polygon edges for a later aggregated insertion.  When set
+        //the discrete transform must equal the transform and is used instead of it
+        static void renderContour( CurveVector& curves, const Transform& transform, 
+            const boost::optional< DiscreteTransform >& discrete, const Polygon& poly );
+        static void renderContour( Arrangement& arr, const Transform& transform, 
+            const boost::optional< DiscreteTransform >& discrete, const Polygon& poly );
+        
+        const Arrangement& getArrangement() const { return m_arr; }
         
         using FaceHandle = Arrangement::Face_const_handle;
         using FaceHandleSet = std::set< FaceHandle >;
@@ -37,15 +161,19 @@ namespace Blueprint
         void renderFillers( const boost::filesystem::path& filepath );
         
         //io
-        void save( std::ostream& os ) const;
-        void load( std::istream& is );
+        void save( std::ostream& os, ArrangementFormat format = eArrFormat_Text ) const;
+        void load( std::istream& is, ArrangementFormat format = eArrFormat_Text );
     private:
-        void recurse( Site::Ptr pSpace );
-        void recursePost( Site::Ptr pSpace );
+        static void renderSpace( Space::Ptr pSpace, const Transform& transform, 
+            const boost::optional< DiscreteTransform >& discrete, CurveVector& curves );
+        void connectAndFinalise( const Site::PtrVector& sites );
+        void recurse( Site::Ptr pSpace, CurveVector& curves );
+        void recursePost( Site::Ptr pSpace, CurveVector& curves );
         void connect( Site::Ptr pConnection );
         void findSpaceFaces( Space::Ptr pSpace, FaceHandleSet& faces, FaceHandleSet& spaceFaces );
         
-        Arrangement m_arr;
+        std::unique_ptr< Arrangement > m_pArr;
+        Arrangement& m_arr;
     };
 
     
@@ -26,6 +26,7 @@ public:
     
     //Site
     virtual void evaluate( const EvaluationMode& mode, EvaluationResults& results );
+    virtual void isolateGeometry();
     
     const Segment& getFirstSegment() const { return m_firstSegment; }
     const Segment& getSecondSegment() const { return m_secondSegment; }
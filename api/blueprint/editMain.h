@@ -7,6 +7,7 @@ namespace Blueprint
 {
 
 class Analysis;
+class IncrementalCompiler;
 
 class EditMain : public EditBase
 {
@@ -29,11 +30,13 @@ public:
     const Site::EvaluationMode getEvaluationMode() const;
     
     std::shared_ptr< Analysis > loadAnalysis( const std::string& strFilePath ) const;
-    
+    //compiles the edited blueprint only recompiling the sites changed since the last call
+    std::shared_ptr< Analysis > compileAnalysis();
     
 private:
     std::string m_strFilePath;
     bool m_bViewArrangement, m_bViewCellComplex, m_bViewClearance;
+    std::shared_ptr< IncrementalCompiler > m_pCompiler;
 };
 
 }
@@ -0,0 +1,62 @@
+#ifndef FLOOR_QUERY_18_OCT_2026
+#define FLOOR_QUERY_18_OCT_2026
+
+#include "blueprint/cgalSettings.h"
+#include "blueprint/segmentBVH.h"
+
+#include <boost/optional.hpp>
+
+#include <vector>
+
+namespace Blueprint
+{
+    
+//read only segment queries against the closure of a floor face.  The boundary
+//geometry is copied out of the arrangement so queries never touch it and any number
+//of threads can share one instance
+class FloorQuery
+{
+public:
+    FloorQuery();
+    FloorQuery( Arrangement::Face_const_handle hFloorFace );
+    
+    //true if every point of the segment is within the floor face or on its boundary
+    bool isWithinFloor( const Segment& segment ) const;
+    
+    //true if the point is within the floor face or on its boundary
+    bool isWithinFloor( const Point& pt ) const;
+    
+    //grows the segment along its line to the maximal runs within the floor adjacent 
+    //to each of its end points by shooting rays both ways
+    void extendWithinFloor( const Segment& segment, Point& ptStart, Point& ptEnd ) const;
+    
+    //the extension of the segment if it runs beyond either end point, or both unless
+    //single ended ones are kept
+    boost::optional< Segment > getFloorBisector( const Segment& segment, bool bKeepSingleEnded ) const;
+    
+    //conservative visibility polygon of the origin approximated by angular sectors.
+    //Clears the flag of each point whose segment to the origin certainly crosses a 
+    //boundary between the floor and another face.  Points left flagged may still be hidden
+    void cullOccluded( const Point& ptOrigin, const std::vector< Point >& points, 
+        std::vector< bool >& visible ) const;
+    
+    //copy sharing no kernel representation with this one so it can be used on another thread
+    FloorQuery isolate() const;
+    
+private:
+    void getPointsAlong( const Segment& segment, std::vector< Point >& points ) const;
+    
+    //boundary edges with the floor on only one side
+    struct SolidEdge
+    {
+        Point ptStart, ptEnd;
+        double x1, y1, x2, y2;
+    };
+    
+    SegmentBVH m_boundary;
+    std::vector< SolidEdge > m_solidEdges;
+};
+
+}
+
+#endif //FLOOR_QUERY_18_OCT_2026
@@ -0,0 +1,23 @@
+#ifndef ISOLATE_18_OCT_2026
+#define ISOLATE_18_OCT_2026
+
+#include "blueprint/cgalSettings.h"
+
+namespace Blueprint
+{
+
+//deep copies of kernel values sharing no representation with the original.  Copies of
+//kernel numbers share reference counted representations which Epeck also evaluates
+//lazily in place, so unless KERNEL_IS_THREAD_SAFE a value may only be used by another
+//thread through a copy made by these.  The copy is made on the calling thread while no 
+//other thread uses the original and is then owned by a single thread
+Kernel::FT          isolate( const Kernel::FT& value );
+Point               isolate( const Point& pt );
+Segment             isolate( const Segment& segment );
+Curve               isolate( const Curve& curve );
+Polygon             isolate( const Polygon& polygon );
+Transform           isolate( const Transform& transform );
+
+}
+
+#endif //ISOLATE_18_OCT_2026
@@ -0,0 +1,44 @@
+#ifndef NAV_MESH_18_OCT_2026
+#define NAV_MESH_18_OCT_2026
+
+#include <vector>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace Blueprint
+{
+
+class FloorAnalysis;
+
+//flat triangle mesh of the walkable floor from a constrained delaunay triangulation of
+//the floor face.  Triangles are counter clockwise and edge k runs from index k to 
+//index k + 1 with the neighbouring triangle across it in the adjacency or NO_TRIANGLE
+class NavMesh
+{
+public:
+    static constexpr std::uint32_t NO_TRIANGLE = 0xFFFFFFFF;
+    
+    NavMesh();
+    NavMesh( const FloorAnalysis& floor );
+    
+    std::size_t getVertexCount() const { return m_vertices.size() / 2U; }
+    std::size_t getTriangleCount() const { return m_indices.size() / 3U; }
+    
+    //x, y pairs
+    const std::vector< float >& getVertices() const { return m_vertices; }
+    const std::vector< std::uint32_t >& getIndices() const { return m_indices; }
+    const std::vector< std::uint32_t >& getAdjacency() const { return m_adjacency; }
+    
+    void save( std::ostream& os ) const;
+    void load( std::istream& is );
+    
+private:
+    std::vector< float > m_vertices;
+    std::vector< std::uint32_t > m_indices;
+    std::vector< std::uint32_t > m_adjacency;
+};
+
+}
+
+#endif //NAV_MESH_18_OCT_2026
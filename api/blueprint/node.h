@@ -88,6 +88,8 @@ public:
     const PtrVector& getChildren()              const { return m_childrenOrdered; }
     std::size_t size()                          const { return m_childrenOrdered.size(); }
     const Timing::UpdateTick& getLastModifiedTick()     const { return m_lastModifiedTick; }
+    //latest modification of this node or any node below it
+    const Timing::UpdateTick& getSubtreeModifiedTick()  const { return m_subtreeModifiedTick; }
     std::size_t getIndex()                      const { return m_iIndex; }
     virtual std::string getStatement()          const = 0;
 
@@ -167,7 +169,7 @@ private:
     PtrVector m_childrenOrdered;
     PtrMap m_children;
     std::size_t m_iIndex;
-    Timing::UpdateTick m_lastModifiedTick;
+    Timing::UpdateTick m_lastModifiedTick, m_subtreeModifiedTick;
     Ed::Node m_passThroughMetaData;
 };
 
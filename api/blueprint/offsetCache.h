@@ -0,0 +1,67 @@
+#ifndef OFFSET_CACHE_18_OCT_2026
+#define OFFSET_CACHE_18_OCT_2026
+
+#include "blueprint/cgalSettings.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <unordered_map>
+#include <mutex>
+#include <vector>
+
+namespace Blueprint
+{
+
+//straight skeleton wall offsets of space contours shared by every space with the same
+//contour and wall width.  Contours are keyed with the lowest vertex first and translated
+//to the origin so pasted copies hit the same entry wherever they are placed.  Any number 
+//of threads can use one cache as it hands out isolated copies of its entries
+class OffsetCache
+{
+public:
+    typedef boost::shared_ptr< OffsetCache > Ptr;
+    
+    struct Offsets
+    {
+        //either is empty when the skeleton produced nothing
+        Polygon interior, exterior;
+    };
+    
+    //the cache used by space evaluation.  Installed by the toolbox and null otherwise
+    static Ptr getInstance();
+    static void setInstance( Ptr pCache );
+    //clears the instance only if it is still the given cache
+    static void resetInstance( Ptr pCache );
+    
+    static Offsets calculate( const Polygon& contour, const Kernel::FT& wallWidth );
+    
+    Offsets get( const Polygon& contour, const Kernel::FT& wallWidth );
+    
+    std::size_t size() const;
+    std::size_t getHits() const;
+    std::size_t getMisses() const;
+    void clear();
+    
+private:
+    struct Key
+    {
+        std::vector< Point > points;
+        Kernel::FT wallWidth;
+        bool operator==( const Key& cmp ) const;
+    };
+    struct KeyHash
+    {
+        std::size_t operator()( const Key& key ) const;
+    };
+    using OffsetMap = std::unordered_map< Key, Offsets, KeyHash >;
+    
+    static Offsets isolate( const Offsets& offsets );
+    
+    mutable std::mutex m_mutex;
+    OffsetMap m_offsets;
+    std::size_t m_szHits = 0U, m_szMisses = 0U;
+};
+
+}
+
+#endif //OFFSET_CACHE_18_OCT_2026
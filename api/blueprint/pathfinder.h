@@ -0,0 +1,80 @@
+#ifndef PATHFINDER_18_OCT_2026
+#define PATHFINDER_18_OCT_2026
+
+#include "blueprint/navMesh.h"
+#include "blueprint/boundsGrid.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace Blueprint
+{
+
+class ThreadPool;
+
+//shortest path queries over a nav mesh.  A* finds the corridor of triangles between
+//the edge midpoints and the funnel algorithm pulls the string through its portals.
+//The pathfinder is read only and all search state lives in the scratch so each
+//thread needs its own scratch and repeated queries do not allocate
+class Pathfinder
+{
+public:
+    struct Waypoint
+    {
+        float x, y;
+    };
+    using Path = std::vector< Waypoint >;
+    
+    struct Query
+    {
+        Waypoint start, goal;
+    };
+    
+    class Scratch
+    {
+        friend class Pathfinder;
+    public:
+        Scratch( const Pathfinder& pathfinder );
+    private:
+        struct HeapEntry
+        {
+            float fEstimate;
+            std::uint32_t uTriangle;
+        };
+        
+        std::uint32_t m_uGeneration = 0U;
+        std::vector< std::uint32_t > m_reached, m_closed, m_parent;
+        std::vector< float > m_cost;
+        std::vector< Waypoint > m_position;
+        std::vector< HeapEntry > m_heap;
+        std::vector< std::uint32_t > m_corridor;
+        std::vector< Waypoint > m_left, m_right;
+    };
+    
+    Pathfinder( const NavMesh& navMesh );
+    
+    //triangle containing the point or NavMesh::NO_TRIANGLE
+    std::uint32_t findTriangle( const Waypoint& pt ) const;
+    
+    //path from the start to the goal including both.  Returns false with an empty path 
+    //when either point is off the mesh or they are not connected
+    bool findPath( const Waypoint& start, const Waypoint& goal, Scratch& scratch, Path& path ) const;
+    
+    //paths of unconnected queries are empty
+    void findPaths( ThreadPool& pool, const std::vector< Query >& queries, std::vector< Path >& paths ) const;
+    
+private:
+    Waypoint getVertex( std::uint32_t uIndex ) const;
+    bool search( std::uint32_t uStart, std::uint32_t uGoal, const Waypoint& start, const Waypoint& goal, 
+        Scratch& scratch ) const;
+    void pullString( const Waypoint& start, const Waypoint& goal, Scratch& scratch, Path& path ) const;
+    
+    const NavMesh& m_navMesh;
+    
+    //triangles overlapping each bucket
+    BoundsGrid m_grid;
+};
+
+}
+
+#endif //PATHFINDER_18_OCT_2026
@@ -0,0 +1,38 @@
+#ifndef POINT_LOCATION_18_OCT_2026
+#define POINT_LOCATION_18_OCT_2026
+
+#include "blueprint/cgalSettings.h"
+
+#include <CGAL/Arr_point_location_result.h>
+
+#include <memory>
+
+namespace Blueprint
+{
+
+enum PointLocationStrategy
+{
+    ePointLocation_Landmarks,
+    ePointLocation_Trapezoid
+};
+
+//point location over an arrangement which must not change while the locator exists.
+//The search structure is built once by the constructor
+class PointLocator
+{
+public:
+    using Result = CGAL::Arr_point_location_result< Arrangement >::Type;
+    
+    PointLocator( const Arrangement& arr, PointLocationStrategy strategy );
+    ~PointLocator();
+    
+    Result locate( const Point& pt ) const;
+    
+private:
+    struct Impl;
+    std::unique_ptr< Impl > m_pImpl;
+};
+
+}
+
+#endif //POINT_LOCATION_18_OCT_2026
@@ -0,0 +1,56 @@
+#ifndef PORTAL_GRAPH_18_OCT_2026
+#define PORTAL_GRAPH_18_OCT_2026
+
+#include <vector>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace Blueprint
+{
+
+class Compilation;
+
+//room connectivity of the compiled floor.  Nodes are the faces either side of the
+//doorsteps and each portal is one doorstep between two of them.  Faces without a 
+//doorstep have no node and a node keeps only the bounds of its face, not the face or 
+//space it came from, so a point can only be matched to nodes by their bounds which may overlap
+class PortalGraph
+{
+public:
+    struct Node
+    {
+        float fMinX, fMinY, fMaxX, fMaxY;
+    };
+    
+    struct Portal
+    {
+        std::uint32_t uFirst, uSecond;
+        float fStartX, fStartY, fEndX, fEndY;
+        float fMidX, fMidY, fWidth;
+    };
+    
+    PortalGraph();
+    PortalGraph( const Compilation& compilation );
+    
+    const std::vector< Node >& getNodes() const { return m_nodes; }
+    const std::vector< Portal >& getPortals() const { return m_portals; }
+    
+    //indices of the portals of a node
+    const std::uint32_t* portalsBegin( std::uint32_t uNode ) const { return m_nodePortals.data() + m_nodePortalStart[ uNode ]; }
+    const std::uint32_t* portalsEnd( std::uint32_t uNode ) const { return m_nodePortals.data() + m_nodePortalStart[ uNode + 1U ]; }
+    
+    void save( std::ostream& os ) const;
+    void load( std::istream& is );
+    
+private:
+    void buildNodePortals();
+    
+    std::vector< Node > m_nodes;
+    std::vector< Portal > m_portals;
+    std::vector< std::uint32_t > m_nodePortalStart, m_nodePortals;
+};
+
+}
+
+#endif //PORTAL_GRAPH_18_OCT_2026
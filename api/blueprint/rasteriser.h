@@ -42,10 +42,13 @@ public:
             m_renderer.clear( ColourType( 0u ) );
     }
 
+    void setFillingRule( agg::filling_rule_e fillingRule ) { m_fillingRule = fillingRule; }
+
     template< class T >
     void renderPath( T& path, const ColourType& colour, Float fGamma = 0.0f )
     {
         RasterizerType ras;
+        ras.filling_rule( m_fillingRule );
         ras.gamma( agg::gamma_threshold( fGamma ) );
         ras.add_path( path );
         agg::render_scanlines_aa_solid( ras, m_scanLine, m_renderer, colour );
@@ -77,6 +80,7 @@ private:
     PixelFormatType m_pixelFormater;
     RendererBaseType m_renderer;
     ScanlineType m_scanLine;
+    agg::filling_rule_e m_fillingRule = agg::fill_non_zero;
 };
 
 }
@@ -0,0 +1,112 @@
+#ifndef SEGMENT_BVH_18_OCT_2026
+#define SEGMENT_BVH_18_OCT_2026
+
+#include "blueprint/cgalSettings.h"
+
+#include <CGAL/Interval_nt.h>
+
+#include <boost/optional.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace Blueprint
+{
+
+//static bounding volume hierarchy over a set of segments.  Every query first uses
+//double precision bounds and interval predicates and only evaluates the exact kernel
+//when the filter cannot decide.  Read only so any number of threads can share one
+class SegmentBVH
+{
+public:
+    SegmentBVH();
+    SegmentBVH( const std::vector< Segment >& segments );
+
+    std::size_t size() const { return m_segments.size(); }
+    
+    //copy whose segments share no kernel representation with this one
+    SegmentBVH isolate() const;
+
+    //true if the point is on any segment
+    bool isOnAny( const Point& pt ) const;
+
+    //true if the segment intersects or touches any segment
+    bool doIntersect( const Segment& segment ) const;
+
+    //appends every intersection point with the segment including both end points of
+    //any collinear overlap
+    void getIntersections( const Segment& segment, std::vector< Point >& points ) const;
+
+    //number of segments crossed by the horizontal ray from the point towards positive x
+    //using the half open rule so a closed walk yields the crossing parity of the point.
+    //Only valid for points which are not on any segment
+    std::size_t countCrossings( const Point& pt ) const;
+
+    //nearest point strictly beyond the origin where the ray in the direction hits a
+    //segment.  Shoot along the negated direction for the opposite way
+    boost::optional< Point > shootRay( const Point& ptOrigin, const Vector& direction ) const;
+
+private:
+    using Interval = CGAL::Interval_nt<>;
+    struct IPoint
+    {
+        Interval x, y;
+    };
+
+    //leaves have a count and index the segments.  Internal nodes have a zero count
+    //with the left child following the node and the right child at the index
+    struct Node
+    {
+        Bbox box;
+        std::uint32_t uIndex, uCount;
+    };
+
+    static const std::uint32_t LEAF_SIZE = 4U;
+
+    std::uint32_t build( std::vector< std::uint32_t >& order, const std::vector< Bbox >& bounds,
+        std::uint32_t uFirst, std::uint32_t uCount );
+
+    static IPoint toInterval( const Point& pt );
+    static CGAL::Uncertain< CGAL::Sign > orientation( const IPoint& a, const IPoint& b, const IPoint& c );
+    static CGAL::Uncertain< bool > intersects( const IPoint& a1, const IPoint& a2, 
+        const IPoint& b1, const IPoint& b2 );
+
+    //visits the segments whose bounds overlap the box until the functor returns false
+    template< typename Functor >
+    void visitOverlapping( const Bbox& box, Functor&& functor ) const
+    {
+        if( m_nodes.empty() )
+            return;
+        std::vector< std::uint32_t > stack( 1U, 0U );
+        while( !stack.empty() )
+        {
+            const Node& node = m_nodes[ stack.back() ];
+            const std::uint32_t uNode = stack.back();
+            stack.pop_back();
+            if( !CGAL::do_overlap( node.box, box ) )
+                continue;
+            if( node.uCount )
+            {
+                for( std::uint32_t u = node.uIndex; u != node.uIndex + node.uCount; ++u )
+                {
+                    if( CGAL::do_overlap( m_bounds[ u ], box ) && !functor( u ) )
+                        return;
+                }
+            }
+            else
+            {
+                stack.push_back( node.uIndex );
+                stack.push_back( uNode + 1U );
+            }
+        }
+    }
+
+    std::vector< Segment > m_segments;
+    std::vector< Bbox > m_bounds;
+    std::vector< IPoint > m_sources, m_targets;
+    std::vector< Node > m_nodes;
+};
+
+}
+
+#endif //SEGMENT_BVH_18_OCT_2026
@@ -14,6 +14,7 @@
 
 #include <list>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -22,6 +23,7 @@ namespace Blueprint
     
 class Factory;
 class Site;
+class ThreadPool;
 
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -53,22 +55,43 @@ public:
     struct EvaluationResults
     {
         std::vector< std::string > errors;
+        std::size_t szSitesEvaluated    = 0U;
+        std::size_t szSitesSkipped      = 0U;
     };
     struct EvaluationMode
     {
         bool bArrangement   = false;
         bool bCellComplex   = false;
         bool bClearance     = false;
+        //integer offsets and booleans for axis aligned spaces
+        bool bClipper       = false;
+        //sibling subtrees are evaluated as pool tasks when set.  Unless KERNEL_IS_THREAD_SAFE
+        //each subtree is isolated before its task starts.  Not part of the evaluated state
+        ThreadPool* pPool   = nullptr;
+        
+        bool operator==( const EvaluationMode& cmp ) const
+        {
+            return bArrangement == cmp.bArrangement && bCellComplex == cmp.bCellComplex &&
+                bClearance == cmp.bClearance && bClipper == cmp.bClipper;
+        }
     };
     virtual void evaluate( const EvaluationMode& mode, EvaluationResults& results );
+    
+    //true if nothing within the site changed since it was last evaluated in the mode
+    bool isEvaluated( const EvaluationMode& mode ) const;
 
     //GlyphSpec
     virtual bool canEdit() const { return true; }
     virtual const std::string& getName() const { return Node::getName(); }
     virtual const GlyphSpec* getParent() const { return m_pSiteParent.lock().get(); }
     
-    //origin transform
+    //origin transform.  The absolute transform is cached until the site or one of
+    //its ancestors is modified
     Transform getAbsoluteTransform() const;
+    TransformDouble getAbsoluteTransformDouble() const;
+    //set whenever the transform is exactly a quarter turn, mirror and half unit translation
+    const boost::optional< DiscreteTransform >& getDiscreteTransform() const { return m_discreteTransform; }
+    boost::optional< DiscreteTransform > getAbsoluteDiscreteTransform() const;
     virtual void setTransform( const Transform& transform );
     virtual const MarkupPolygonGroup* getMarkupContour() const
     {
@@ -81,6 +104,7 @@ public:
         if( getTranslation( m_transform ) != Vector( fNewValueX, fNewValueY ) )
         {
             setTranslation( m_transform, fNewValueX, fNewValueY );
+            updateDiscreteTransform();
             setModified();
         }
     }
@@ -105,7 +129,35 @@ public:
     virtual Feature_Contour::Ptr getContour() const = 0;
     const Polygon& getContourPolygon() const { return m_contourPolygon; }
     
+private:
+    struct AbsoluteTransform
+    {
+        Transform transform;
+        TransformDouble transformDouble;
+        boost::optional< DiscreteTransform > discrete;
+        //latest modification of the site and its ancestors
+        Timing::UpdateTick tick;
+        //what the cached transform was composed from
+        Timing::UpdateTick siteTick, parentTick;
+        const Site* pParent = nullptr;
+    };
+    AbsoluteTransform getAbsolute() const;
+    
+    mutable std::mutex m_absoluteMutex;
+    mutable boost::optional< AbsoluteTransform > m_absoluteTransform;
+    boost::optional< DiscreteTransform > m_discreteTransform;
+    
 protected:
+    //must follow every change to m_transform
+    void updateDiscreteTransform();
+    
+    //evaluates the child sites which changed since their last evaluation and skips the rest
+    void evaluateChildren( const EvaluationMode& mode, EvaluationResults& results );
+    
+    //replaces the geometry of the subtree with copies sharing no kernel representation
+    //with anything outside it so the subtree can be evaluated on another thread
+    virtual void isolateGeometry();
+    
     using PropertyVector = std::vector< Property::Ptr >;
     
     Site::WeakPtr m_pSiteParent;
@@ -118,6 +170,10 @@ protected:
     std::unique_ptr< TextImpl > m_pLabel;
     
     Site::PtrVector m_sites;
+    
+    Timing::UpdateTick m_evaluatedTick;
+    boost::optional< EvaluationMode > m_evaluatedMode;
+    std::size_t m_szEvaluatedSites = 1U;
 };
 
 }
@@ -25,6 +25,7 @@ public:
     
     //Site
     virtual void evaluate( const EvaluationMode& mode, EvaluationResults& results );
+    virtual void isolateGeometry();
     
     //GlyphSpecProducer
     virtual void getMarkupPolygonGroups( MarkupPolygonGroup::List& polyGroups )
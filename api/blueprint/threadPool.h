@@ -0,0 +1,63 @@
+#ifndef THREAD_POOL_18_OCT_2026
+#define THREAD_POOL_18_OCT_2026
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <deque>
+#include <vector>
+
+namespace Blueprint
+{
+    
+//fixed set of worker threads servicing a shared task queue.
+//Threads waiting on a TaskGroup execute queued tasks themselves so groups can be nested
+//and a pool of a single thread runs everything inline on the waiting thread
+class ThreadPool
+{
+    ThreadPool( const ThreadPool& ) = delete;
+    ThreadPool& operator=( const ThreadPool& ) = delete;
+public:
+    using Task = std::function< void() >;
+    
+    //zero threads selects the hardware concurrency
+    ThreadPool( std::size_t szThreads = 0U );
+    ~ThreadPool();
+    
+    std::size_t getThreadCount() const { return m_szThreads; }
+    
+    class TaskGroup
+    {
+        TaskGroup( const TaskGroup& ) = delete;
+        TaskGroup& operator=( const TaskGroup& ) = delete;
+    public:
+        TaskGroup( ThreadPool& pool );
+        ~TaskGroup();
+        
+        void run( Task task );
+        
+        //blocks until all tasks of the group completed and rethrows the first exception
+        void wait();
+        
+    private:
+        ThreadPool& m_pool;
+        std::size_t m_szPending = 0U;
+        std::exception_ptr m_pException;
+    };
+    
+private:
+    void worker();
+    
+    const std::size_t m_szThreads;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque< Task > m_tasks;
+    std::vector< std::thread > m_threads;
+    bool m_bStop = false;
+};
+
+}
+
+#endif //THREAD_POOL_18_OCT_2026
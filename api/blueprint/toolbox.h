@@ -2,6 +2,7 @@
 #define TOOLBOX_23_09_2013
 
 #include "site.h"
+#include "offsetCache.h"
 
 #include "common/tick.hpp"
 
@@ -57,6 +58,7 @@ public:
     typedef boost::shared_ptr< Toolbox > Ptr;
 
     Toolbox( const std::string& strDirectoryPath );
+    ~Toolbox();
     
     void reload();
 
@@ -76,6 +78,9 @@ public:
     }
     void remove( Palette::Ptr pPalette );
     
+    //shared by every space evaluated while the toolbox is loaded
+    OffsetCache::Ptr getOffsetCache() const { return m_pOffsetCache; }
+    
     template< typename TValue >
     void getConfigValue( const std::string& strKey, TValue& value ) const
     {
@@ -124,6 +129,7 @@ private:
     boost::filesystem::path m_rootPath;
     Palette::PtrMap m_palettes;
     Palette::Ptr m_pCurrentPalette;
+    OffsetCache::Ptr m_pOffsetCache;
     
     Ed::Node m_config;
 };
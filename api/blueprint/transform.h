@@ -5,11 +5,18 @@
 #include "blueprint/cgalSettings.h"
 
 #include "common/angle.hpp"
+#include "common/assert_verify.hpp"
 
 #include "ed/nodeio.hpp"
 
+#include <boost/optional.hpp>
+
 #include <string>
 #include <sstream>
+#include <cstdint>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
 
 namespace Blueprint
 {
@@ -25,6 +32,15 @@ namespace Blueprint
         //Math::toVectorDiscrete< Math::Angle< 8 >, Float >( angle, dx, dy );
         //return Transform( CGAL::ROTATION, Direction( dx, dy ), 1, 100 );
         
+        //quarter turns are exact so they remain representable as a DiscreteTransform
+        if( ( angle * 4 ) % Math::Angle< 8 >::TOTAL_ANGLES == 0 )
+        {
+            static const int sines[]    = { 0, 1,  0, -1 };
+            static const int cosines[]  = { 1, 0, -1,  0 };
+            const int iQuarterTurns = ( angle * 4 ) / Math::Angle< 8 >::TOTAL_ANGLES;
+            return Transform( CGAL::ROTATION, sines[ iQuarterTurns ], cosines[ iQuarterTurns ] );
+        }
+        
         const double a = ( angle * MY_PI * 2.0 ) / Math::Angle< 8 >::TOTAL_ANGLES;
         return Transform( CGAL::ROTATION, sin( a ), cos( a ) );
     }
@@ -77,6 +93,199 @@ namespace Blueprint
                         CGAL::to_double( transform.m( 0, 0 ) ) );
     }*/
     
+    //double precision copy of a transform for rendering where exactness is not needed
+    struct TransformDouble
+    {
+        TransformDouble()
+            :   m{ { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 } }
+        {
+        }
+        
+        TransformDouble( const Transform& transform )
+            :   m{ { CGAL::to_double( transform.m( 0, 0 ) ), CGAL::to_double( transform.m( 0, 1 ) ), CGAL::to_double( transform.m( 0, 2 ) ) },
+                   { CGAL::to_double( transform.m( 1, 0 ) ), CGAL::to_double( transform.m( 1, 1 ) ), CGAL::to_double( transform.m( 1, 2 ) ) } }
+        {
+        }
+        
+        void operator()( double& x, double& y ) const
+        {
+            const double tx = m[ 0 ][ 0 ] * x + m[ 0 ][ 1 ] * y + m[ 0 ][ 2 ];
+            y               = m[ 1 ][ 0 ] * x + m[ 1 ][ 1 ] * y + m[ 1 ][ 2 ];
+            x = tx;
+        }
+        
+        double m[ 2 ][ 3 ];
+    };
+    
+    //transform restricted to quarter turns, mirrors and half unit translations which is
+    //everything the editor produces.  The orientation is a signed permutation matrix so
+    //composition, inversion and mapping grid points are integer operations
+    class DiscreteTransform
+    {
+    public:
+        //identity
+        DiscreteTransform()
+        {
+        }
+        
+        //translation is in half units
+        DiscreteTransform( int m00, int m01, int m10, int m11, std::int64_t iHalfX, std::int64_t iHalfY )
+            :   m_m00( m00 ), m_m01( m01 ), m_m10( m10 ), m_m11( m11 ),
+                m_iHalfX( iHalfX ), m_iHalfY( iHalfY )
+        {
+            VERIFY_RTE_MSG( isOrientation( m00, m01, m10, m11 ), "Invalid discrete transform orientation" );
+        }
+        
+        static DiscreteTransform translation( std::int64_t iHalfX, std::int64_t iHalfY )
+        {
+            return DiscreteTransform( 1, 0, 0, 1, iHalfX, iHalfY );
+        }
+        
+        //anti clockwise
+        static DiscreteTransform quarterTurns( int iQuarterTurns )
+        {
+            static const int sines[]    = { 0, 1,  0, -1 };
+            static const int cosines[]  = { 1, 0, -1,  0 };
+            const int q = ( ( iQuarterTurns % 4 ) + 4 ) % 4;
+            return DiscreteTransform( cosines[ q ], -sines[ q ], sines[ q ], cosines[ q ], 0, 0 );
+        }
+        
+        //reflections matching mirrorX and mirrorY
+        static DiscreteTransform mirrorX() { return DiscreteTransform( 1, 0, 0, -1, 0, 0 ); }
+        static DiscreteTransform mirrorY() { return DiscreteTransform( -1, 0, 0, 1, 0, 0 ); }
+        
+        //only succeeds when the transform is exactly representable so mapping with
+        //the result is identical to mapping with the transform
+        static boost::optional< DiscreteTransform > fromTransform( const Transform& transform )
+        {
+            std::int64_t m[ 2 ][ 3 ];
+            for( int i = 0; i != 2; ++i )
+            {
+                for( int j = 0; j != 3; ++j )
+                {
+                    if( !toHalfUnits( transform.m( i, j ), m[ i ][ j ] ) )
+                        return boost::none;
+                }
+            }
+            for( int i = 0; i != 2; ++i )
+            {
+                for( int j = 0; j != 2; ++j )
+                {
+                    if( m[ i ][ j ] % 2 != 0 )
+                        return boost::none;
+                    m[ i ][ j ] /= 2;
+                }
+            }
+            if( !isOrientation( m[ 0 ][ 0 ], m[ 0 ][ 1 ], m[ 1 ][ 0 ], m[ 1 ][ 1 ] ) )
+                return boost::none;
+            return DiscreteTransform( 
+                static_cast< int >( m[ 0 ][ 0 ] ), static_cast< int >( m[ 0 ][ 1 ] ), 
+                static_cast< int >( m[ 1 ][ 0 ] ), static_cast< int >( m[ 1 ][ 1 ] ), 
+                m[ 0 ][ 2 ], m[ 1 ][ 2 ] );
+        }
+        
+        Transform toTransform() const
+        {
+            return Transform( 
+                m_m00, m_m01, static_cast< double >( m_iHalfX ) / 2.0,
+                m_m10, m_m11, static_cast< double >( m_iHalfY ) / 2.0 );
+        }
+        
+        //number of anti clockwise quarter turns plus four when mirrored
+        int getOrientationCode() const
+        {
+            //the first column is the rotation for both proper and mirrored orientations
+            const int iQuarterTurns = m_m00 == 1 ? 0 : m_m10 == 1 ? 1 : m_m00 == -1 ? 2 : 3;
+            return isMirrored() ? iQuarterTurns + 4 : iQuarterTurns;
+        }
+        bool isMirrored() const { return m_m00 * m_m11 - m_m01 * m_m10 < 0; }
+        
+        std::int64_t getHalfX() const { return m_iHalfX; }
+        std::int64_t getHalfY() const { return m_iHalfY; }
+        
+        //applies the right hand side first matching Transform
+        DiscreteTransform operator*( const DiscreteTransform& rhs ) const
+        {
+            std::int64_t iHalfX = rhs.m_iHalfX, iHalfY = rhs.m_iHalfY;
+            ( *this )( iHalfX, iHalfY );
+            return DiscreteTransform( 
+                m_m00 * rhs.m_m00 + m_m01 * rhs.m_m10, m_m00 * rhs.m_m01 + m_m01 * rhs.m_m11,
+                m_m10 * rhs.m_m00 + m_m11 * rhs.m_m10, m_m10 * rhs.m_m01 + m_m11 * rhs.m_m11,
+                iHalfX, iHalfY );
+        }
+        
+        DiscreteTransform inverse() const
+        {
+            //orthogonal so the inverse orientation is the transpose
+            return DiscreteTransform( 
+                m_m00, m_m10, m_m01, m_m11,
+                -( m_m00 * m_iHalfX + m_m10 * m_iHalfY ),
+                -( m_m01 * m_iHalfX + m_m11 * m_iHalfY ) );
+        }
+        
+        bool operator==( const DiscreteTransform& cmp ) const
+        {
+            return m_m00 == cmp.m_m00 && m_m01 == cmp.m_m01 && m_m10 == cmp.m_m10 && m_m11 == cmp.m_m11 &&
+                m_iHalfX == cmp.m_iHalfX && m_iHalfY == cmp.m_iHalfY;
+        }
+        bool operator!=( const DiscreteTransform& cmp ) const { return !( *this == cmp ); }
+        
+        //maps a point in half units
+        void operator()( std::int64_t& iHalfX, std::int64_t& iHalfY ) const
+        {
+            const std::int64_t x = m_m00 * iHalfX + m_m01 * iHalfY + m_iHalfX;
+            iHalfY               = m_m10 * iHalfX + m_m11 * iHalfY + m_iHalfY;
+            iHalfX = x;
+        }
+        
+        Point operator()( const Point& pt ) const
+        {
+            //grid points held exactly as doubles never touch the exact number type
+            std::int64_t x, y;
+            if( toHalfUnits( pt.x(), x ) && toHalfUnits( pt.y(), y ) )
+            {
+                ( *this )( x, y );
+                if( std::abs( x ) < MAX_HALF_UNITS && std::abs( y ) < MAX_HALF_UNITS )
+                    return Point( static_cast< double >( x ) / 2.0, static_cast< double >( y ) / 2.0 );
+            }
+            
+            //otherwise only negations and additions
+            const Kernel::FT fx = m_m00 ? ( m_m00 > 0 ? pt.x() : -pt.x() ) : ( m_m01 > 0 ? pt.y() : -pt.y() );
+            const Kernel::FT fy = m_m10 ? ( m_m10 > 0 ? pt.x() : -pt.x() ) : ( m_m11 > 0 ? pt.y() : -pt.y() );
+            return Point( 
+                m_iHalfX ? fx + Kernel::FT( static_cast< double >( m_iHalfX ) / 2.0 ) : fx, 
+                m_iHalfY ? fy + Kernel::FT( static_cast< double >( m_iHalfY ) / 2.0 ) : fy );
+        }
+        
+    private:
+        //keeps every intermediate value exact as a double
+        static constexpr std::int64_t MAX_HALF_UNITS = std::int64_t( 1 ) << 50;
+        
+        static bool isOrientation( std::int64_t m00, std::int64_t m01, std::int64_t m10, std::int64_t m11 )
+        {
+            const auto isUnit = []( std::int64_t i ){ return i == 1 || i == -1; };
+            return ( isUnit( m00 ) && isUnit( m11 ) && m01 == 0 && m10 == 0 ) ||
+                   ( isUnit( m01 ) && isUnit( m10 ) && m00 == 0 && m11 == 0 );
+        }
+        
+        //true if the number is exactly a multiple of a half within range
+        static bool toHalfUnits( const Kernel::FT& value, std::int64_t& iHalfUnits )
+        {
+            const std::pair< double, double > interval = CGAL::to_interval( value );
+            if( interval.first != interval.second )
+                return false;
+            const double dHalfUnits = interval.first * 2.0;
+            if( !( std::fabs( dHalfUnits ) < static_cast< double >( MAX_HALF_UNITS ) ) || 
+                std::floor( dHalfUnits ) != dHalfUnits )
+                return false;
+            iHalfUnits = static_cast< std::int64_t >( dHalfUnits );
+            return true;
+        }
+        
+        int m_m00 = 1, m_m01 = 0, m_m10 = 0, m_m11 = 1;
+        std::int64_t m_iHalfX = 0, m_iHalfY = 0;
+    };
+    
     inline Vector getTranslation( const Transform& transform )
     {
         return Vector( transform.m( 0, 2 ), transform.m( 1, 2 ) );
@@ -0,0 +1,49 @@
+#ifndef VERTEX_INDEX_18_OCT_2026
+#define VERTEX_INDEX_18_OCT_2026
+
+#include "blueprint/cgalSettings.h"
+
+#include <CGAL/Arr_observer.h>
+
+#include <boost/optional.hpp>
+
+#include <unordered_map>
+
+namespace Blueprint
+{
+
+//exact point to vertex lookup kept in sync with the arrangement by observing it
+class VertexIndex : public CGAL::Arr_observer< Arrangement >
+{
+public:
+    VertexIndex( Arrangement& arr );
+    
+    boost::optional< Arrangement::Vertex_const_handle > find( const Point& pt ) const;
+    std::size_t size() const { return m_vertices.size(); }
+    
+    //Arr_observer
+    virtual void after_attach();
+    virtual void after_assign();
+    virtual void after_clear();
+    virtual void after_global_change();
+    virtual void after_create_vertex( Arrangement::Vertex_handle v );
+    virtual void before_modify_vertex( Arrangement::Vertex_handle v, const Point& pt );
+    virtual void after_modify_vertex( Arrangement::Vertex_handle v );
+    virtual void before_remove_vertex( Arrangement::Vertex_handle v );
+    
+private:
+    //hash of the exact coordinates so equal points always collide
+    struct PointHash
+    {
+        std::size_t operator()( const Point& pt ) const;
+    };
+    using VertexMap = std::unordered_map< Point, Arrangement::Vertex_handle, PointHash >;
+    
+    void rebuild();
+    
+    VertexMap m_vertices;
+};
+
+}
+
+#endif //VERTEX_INDEX_18_OCT_2026
@@ -3,9 +3,29 @@
 #define VISIBILITY_15_DEC_2020
 
 #include "blueprint/cgalSettings.h"
+#include "blueprint/cellComplex.h"
+#include "blueprint/clearance.h"
 #include "blueprint/compilation.h"
+#include "blueprint/floorQuery.h"
+#include "blueprint/navMesh.h"
+#include "blueprint/portalGraph.h"
+#include "blueprint/pointLocation.h"
+#include "blueprint/threadPool.h"
+#include "blueprint/vertexIndex.h"
 
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace boost
+{
+    namespace iostreams
+    {
+        class mapped_file_source;
+    }
+}
 
 namespace Blueprint
 {
@@ -21,9 +41,12 @@ public:
         Arrangement::Vertex_const_handle;
         
     FloorAnalysis( Compilation& compilation, boost::shared_ptr< Blueprint > pBlueprint );
+    //floor of a single connected region such as an inward offset of another floor
+    FloorAnalysis( const Polygon_with_holes& region );
     
     const Arrangement& getFloor() const { return m_arr; }
     const Arrangement::Face_const_handle getFloorFace() const { return m_hFloorFace; }
+    const FloorQuery& getQuery() const { return m_query; }
     
     bool isWithinFloor( VertexHandle v1, VertexHandle v2 ) const;
     boost::optional< Curve > getFloorBisector( VertexHandle v1, VertexHandle v2, bool bKeepSingleEnded ) const;
@@ -31,17 +54,17 @@ public:
     
     void render( const boost::filesystem::path& filepath );
     
-    void save( std::ostream& os ) const;
-    void load( std::istream& is );
+    void save( std::ostream& os, ArrangementFormat format = eArrFormat_Text ) const;
+    void load( std::istream& is, ArrangementFormat format = eArrFormat_Text );
 private:
     void findFloorFace();
-    void calculateBounds();
 
-    void recurseObjects( Site::Ptr pSpace );
+    void recurseObjects( Site::Ptr pSpace, Compilation::CurveVector& curves );
 
-    mutable Arrangement m_arr;
+    Arrangement m_arr;
+    VertexIndex m_vertexIndex;
     Arrangement::Face_handle m_hFloorFace;
-    Rect m_boundingBox;
+    FloorQuery m_query;
     
 };
 
@@ -54,16 +77,61 @@ class Visibility
     Visibility();
 public:
     Visibility( FloorAnalysis& floor );
+    Visibility( FloorAnalysis& floor, ThreadPool& pool );
     
     const Arrangement& getArrangement() const { return m_arr; }
     
+    //how many reflex vertex pairs the occlusion cull saved from the exact test.
+    //Only set when constructed rather than loaded
+    struct Statistics
+    {
+        std::size_t szReflexPairs   = 0U;
+        std::size_t szCulled        = 0U;
+        std::size_t szVisible       = 0U;
+    };
+    const Statistics& getStatistics() const { return m_statistics; }
+    
     void render( const boost::filesystem::path& filepath );
     
-    void save( std::ostream& os ) const;
-    void load( std::istream& is );
+    void save( std::ostream& os, ArrangementFormat format = eArrFormat_Text ) const;
+    void load( std::istream& is, ArrangementFormat format = eArrFormat_Text );
     
 private:
+    void construct( FloorAnalysis& floor, ThreadPool& pool );
+    
     Arrangement m_arr;
+    Statistics m_statistics;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+//walkable floor for an agent of a given radius.  The floor face is offset inwards by 
+//the radius which also grows the object holes.  The offset can split the floor so each 
+//connected region has its own floor and visibility
+class AgentFloor
+{
+public:
+    AgentFloor( const FloorAnalysis& floor, float fRadius );
+    AgentFloor( const FloorAnalysis& floor, float fRadius, ThreadPool& pool );
+    
+    float getRadius() const { return m_fRadius; }
+    std::size_t getRegionCount() const { return m_regions.size(); }
+    const FloorAnalysis& getFloorAnalysis( std::size_t szRegion ) const { return *m_regions[ szRegion ].pFloor; }
+    const Visibility& getVisibility( std::size_t szRegion ) const { return *m_regions[ szRegion ].pVisibility; }
+    
+    //the region containing the point if the agent can stand there
+    boost::optional< std::size_t > findRegion( const Point& pt ) const;
+    
+private:
+    void construct( const FloorAnalysis& floor, ThreadPool& pool );
+    
+    struct Region
+    {
+        std::unique_ptr< FloorAnalysis > pFloor;
+        std::unique_ptr< Visibility > pVisibility;
+    };
+    float m_fRadius;
+    std::vector< Region > m_regions;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -72,11 +140,41 @@ class Analysis
 {
     Analysis();
     Analysis( boost::shared_ptr< Blueprint > pBlueprint );
+    Analysis( IncrementalCompiler& compiler, boost::shared_ptr< Blueprint > pBlueprint );
+    Analysis( ThreadPool& pool, boost::shared_ptr< Blueprint > pBlueprint );
 public:
     using Ptr = std::shared_ptr< Analysis >;
 
     static Ptr constructFromBlueprint( boost::shared_ptr< Blueprint > pBlueprint );
+    static Ptr constructFromBlueprint( IncrementalCompiler& compiler, boost::shared_ptr< Blueprint > pBlueprint );
+    static Ptr constructFromBlueprint( ThreadPool& pool, boost::shared_ptr< Blueprint > pBlueprint );
+    //detects the format from the header and falls back to the headerless text format
     static Ptr constructFromStream( std::istream& is );
+    //maps the file and only materialises each part on first access.  The mapping is
+    //released once the required parts are loaded, copying out any optional sections left
+    static Ptr constructFromFile( const boost::filesystem::path& filePath );
+    
+    const Compilation&      getCompilation() const;
+    const FloorAnalysis&    getFloorAnalysis() const;
+    const Visibility&       getVisibility() const;
+    //loaded from its section or triangulated from the floor for files without one
+    const NavMesh&          getNavMesh() const;
+    //loaded from its section or built from the compilation for files without one
+    const PortalGraph&      getPortalGraph() const;
+    //loaded from its section or rasterised from the floor at the clearance resolution
+    const ClearanceField&   getClearance() const;
+    //loaded from its section or partitioned from the nav mesh
+    const CellComplex&      getCellComplex() const;
+    
+    //a positive resolution in world units per pixel adds the clearance section on save
+    void setClearanceResolution( float fResolution );
+    //adds the convex cell section on save
+    void setCellComplex( bool bCellComplex ) { m_bCellComplex = bCellComplex; }
+    
+    //agent floors are derived from the floor on first access and cached per radius
+    void setAgentRadii( const std::vector< float >& radii );
+    std::size_t getAgentCount() const { return m_agents.size(); }
+    const AgentFloor& getAgentFloor( std::size_t szAgent ) const;
     
     struct IPainter
     {
@@ -85,13 +183,78 @@ public:
     };
     
     void renderFloor( IPainter& painter ) const;
+    
+    //point location over the floor and the visibility cells built on the first query.
+    //The strategy can only be chosen before then
+    using FaceOpt = boost::optional< Arrangement::Face_const_handle >;
+    void setPointLocationStrategy( PointLocationStrategy strategy );
+    FaceOpt locateFloor( const Point& pt ) const;
+    FaceOpt locateCell( const Point& pt ) const;
+    void locateCells( const std::vector< Point >& points, std::vector< FaceOpt >& cells ) const;
 
-    void save( std::ostream& os ) const;
+    void save( std::ostream& os, ArrangementFormat format = eArrFormat_Binary ) const;
+    
+    //file version and section set of the saved analysis
+    static std::string getFormatVersion();
     
 private:
-    Compilation     m_compilation;
-    FloorAnalysis   m_floor;
-    Visibility      m_visibility;
+    enum SectionType
+    {
+        eSection_Compilation,
+        eSection_Floor,
+        eSection_Visibility,
+        eSection_NavMesh,
+        eSection_Portals,
+        eSection_Clearance,
+        eSection_Cells,
+        TOTAL_SECTIONS
+    };
+    struct Section
+    {
+        std::once_flag loaded;
+        bool bPresent = false;
+        //into the mapping or the buffer until the section is loaded
+        const char* pData = nullptr;
+        std::size_t szSize = 0U;
+        std::string buffer;
+    };
+    template< typename Loader >
+    void loadSection( Section& section, Loader&& loader ) const;
+    template< typename T >
+    void materialise( SectionType sectionType, T& part ) const;
+    //for optional sections which can be derived from the required ones
+    template< typename T, typename Builder >
+    void materialiseOrBuild( SectionType sectionType, T& part, Builder&& builder ) const;
+    void buildPointLocation() const;
+    bool isCell( Arrangement::Face_const_handle hFace ) const;
+    
+    mutable std::mutex m_mappingMutex;
+    mutable std::shared_ptr< boost::iostreams::mapped_file_source > m_pMappedFile;
+    ArrangementFormat m_format = eArrFormat_Text;
+    mutable Section m_sections[ TOTAL_SECTIONS ];
+    
+    mutable Compilation     m_compilation;
+    mutable FloorAnalysis   m_floor;
+    mutable Visibility      m_visibility;
+    mutable NavMesh         m_navMesh;
+    mutable PortalGraph     m_portalGraph;
+    mutable ClearanceField  m_clearance;
+    float m_fClearanceResolution = 0.0f;
+    mutable CellComplex     m_cellComplex;
+    bool m_bCellComplex = false;
+    
+    PointLocationStrategy m_locationStrategy = ePointLocation_Landmarks;
+    mutable std::once_flag m_locationBuilt;
+    mutable std::unique_ptr< PointLocator > m_pFloorLocator, m_pCellLocator;
+    mutable std::unordered_set< const Arrangement::Face* > m_cells;
+    
+    struct Agent
+    {
+        float fRadius;
+        std::once_flag built;
+        std::unique_ptr< AgentFloor > pFloor;
+    };
+    std::vector< std::unique_ptr< Agent > > m_agents;
 };
 
 }
@@ -0,0 +1,265 @@
+
+#include "blueprint/arrangementFormat.h"
+
+#include "common/assert_verify.hpp"
+
+#include <sstream>
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    using namespace Blueprint;
+    
+    //Binary implementation of the CGAL arrangement formatter concept.  The arrangement
+    //writer drives it with the vertex table, the edge table of twin halfedge pairs and
+    //the face table with its outer and inner ccb halfedge indices.  Sizes and indices are
+    //written as variable length integers.  Coordinates are written as doubles when the
+    //exact value is representable and otherwise as the exact rational text.
+    class BinaryFormatter : public Formatter
+    {
+        enum NumberTag : unsigned char
+        {
+            eNumber_Double,
+            eNumber_Rational
+        };
+        
+#ifdef BLUEPRINT_RATIONAL_KERNEL
+        using ExactNumber = Kernel::FT;
+        static const ExactNumber& getExact( const Kernel::FT& x ) { return x; }
+#else
+        using ExactNumber = Kernel::Exact_kernel::FT;
+        static const ExactNumber& getExact( const Kernel::FT& x ) { return CGAL::exact( x ); }
+#endif
+    public:
+        using Size = Formatter::Size;
+        
+        //arrangement
+        void write_arrangement_begin() {}
+        void write_arrangement_end() {}
+        void write_size( const char*, Size size ) { writeUnsigned( size ); }
+        void write_vertices_begin() {}
+        void write_vertices_end() {}
+        void write_edges_begin() {}
+        void write_edges_end() {}
+        void write_faces_begin() {}
+        void write_faces_end() {}
+        
+        //vertices
+        void write_vertex_begin() {}
+        void write_vertex_end() {}
+        void write_vertex_index( std::size_t idx ) { writeUnsigned( idx ); }
+        void write_point( const Point_2& p )
+        {
+            writeNumber( p.x() );
+            writeNumber( p.y() );
+        }
+        void write_vertex_data( Vertex_const_handle v ) { writeBool( v->data().get() ); }
+        
+        //edges
+        void write_edge_begin() {}
+        void write_edge_end() {}
+        void write_halfedge_index( std::size_t idx ) { writeUnsigned( idx ); }
+        void write_x_monotone_curve( const X_monotone_curve_2& cv )
+        {
+            write_point( cv.source() );
+            write_point( cv.target() );
+        }
+        void write_halfedge_data( Halfedge_const_handle h ) { writeBool( h->data().get() ); }
+        
+        //faces
+        void write_face_begin() {}
+        void write_face_end() {}
+        void write_outer_ccbs_begin() {}
+        void write_outer_ccbs_end() {}
+        void write_inner_ccbs_begin() {}
+        void write_inner_ccbs_end() {}
+        void write_ccb_halfedges_begin() {}
+        void write_ccb_halfedges_end() {}
+        void write_isolated_vertices_begin() {}
+        void write_isolated_vertices_end() {}
+        void write_face_data( Face_const_handle f ) { writeBool( f->data().get() ); }
+        
+        //arrangement
+        void read_arrangement_begin() {}
+        void read_arrangement_end() {}
+        Size read_size( const char* = nullptr ) { return static_cast< Size >( readUnsigned() ); }
+        void read_vertices_begin() {}
+        void read_vertices_end() {}
+        void read_edges_begin() {}
+        void read_edges_end() {}
+        void read_faces_begin() {}
+        void read_faces_end() {}
+        
+        //vertices
+        void read_vertex_begin() {}
+        void read_vertex_end() {}
+        std::size_t read_vertex_index() { return static_cast< std::size_t >( readUnsigned() ); }
+        void read_point( Point_2& p )
+        {
+            const Kernel::FT x = readNumber();
+            const Kernel::FT y = readNumber();
+            p = Point_2( x, y );
+        }
+        void read_vertex_data( Vertex_handle v ) { v->set_data( readBool() ); }
+        
+        //edges
+        void read_edge_begin() {}
+        void read_edge_end() {}
+        std::size_t read_halfedge_index() { return static_cast< std::size_t >( readUnsigned() ); }
+        void read_x_monotone_curve( X_monotone_curve_2& cv )
+        {
+            Point_2 ptSource, ptTarget;
+            read_point( ptSource );
+            read_point( ptTarget );
+            cv = X_monotone_curve_2( ptSource, ptTarget );
+        }
+        void read_halfedge_data( Halfedge_handle h ) { h->set_data( readBool() ); }
+        
+        //faces
+        void read_face_begin() {}
+        void read_face_end() {}
+        void read_outer_ccbs_begin() {}
+        void read_outer_ccbs_end() {}
+        void read_inner_ccbs_begin() {}
+        void read_inner_ccbs_end() {}
+        void read_ccb_halfedges_begin() {}
+        void read_ccb_halfedges_end() {}
+        void read_isolated_vertices_begin() {}
+        void read_isolated_vertices_end() {}
+        void read_face_data( Face_handle f ) { f->set_data( readBool() ); }
+        
+    private:
+        void writeUnsigned( std::uint64_t value )
+        {
+            do
+            {
+                unsigned char c = static_cast< unsigned char >( value & 0x7F );
+                value >>= 7;
+                if( value )
+                    c |= 0x80;
+                out().put( c );
+            }
+            while( value );
+        }
+        
+        std::uint64_t readUnsigned()
+        {
+            std::uint64_t value = 0U;
+            for( int iShift = 0; ; iShift += 7 )
+            {
+                const int c = in().get();
+                VERIFY_RTE_MSG( c != std::char_traits< char >::eof() && iShift < 64, 
+                    "Corrupt binary arrangement" );
+                value |= static_cast< std::uint64_t >( c & 0x7F ) << iShift;
+                if( !( c & 0x80 ) )
+                    return value;
+            }
+        }
+        
+        void writeBool( bool bValue ) { out().put( bValue ? 1 : 0 ); }
+        DefaultedBool readBool()
+        {
+            const int c = in().get();
+            VERIFY_RTE_MSG( c == 0 || c == 1, "Corrupt binary arrangement" );
+            return DefaultedBool( c == 1 );
+        }
+        
+        void writeNumber( const Kernel::FT& number )
+        {
+            const ExactNumber& exact = getExact( number );
+            const std::pair< double, double > interval = CGAL::to_interval( exact );
+            if( interval.first == interval.second )
+            {
+                out().put( eNumber_Double );
+                char buffer[ sizeof( double ) ];
+                std::memcpy( buffer, &interval.first, sizeof( double ) );
+                out().write( buffer, sizeof( double ) );
+            }
+            else
+            {
+                std::ostringstream os;
+                CGAL::set_ascii_mode( os );
+                os << exact;
+                const std::string str = os.str();
+                out().put( eNumber_Rational );
+                writeUnsigned( str.size() );
+                out().write( str.data(), str.size() );
+            }
+        }
+        
+        Kernel::FT readNumber()
+        {
+            const int tag = in().get();
+            if( tag == eNumber_Double )
+            {
+                char buffer[ sizeof( double ) ];
+                in().read( buffer, sizeof( double ) );
+                VERIFY_RTE_MSG( in(), "Corrupt binary arrangement" );
+                double value;
+                std::memcpy( &value, buffer, sizeof( double ) );
+                return Kernel::FT( value );
+            }
+            else
+            {
+                VERIFY_RTE_MSG( tag == eNumber_Rational, "Corrupt binary arrangement" );
+                std::string str( static_cast< std::size_t >( readUnsigned() ), '\0' );
+                in().read( &str[ 0 ], str.size() );
+                VERIFY_RTE_MSG( in(), "Corrupt binary arrangement" );
+                std::istringstream is( str );
+                CGAL::set_ascii_mode( is );
+                ExactNumber exact;
+                is >> exact;
+                return Kernel::FT( exact );
+            }
+        }
+    };
+}
+
+namespace Blueprint
+{
+
+void writeArrangement( std::ostream& os, const Arrangement& arr, ArrangementFormat format )
+{
+    switch( format )
+    {
+        case eArrFormat_Text:
+            {
+                Formatter formatter;
+                CGAL::write( arr, os, formatter );
+            }
+            break;
+        case eArrFormat_Binary:
+            {
+                BinaryFormatter formatter;
+                CGAL::write( arr, os, formatter );
+            }
+            break;
+        default:
+            THROW_RTE( "Unknown arrangement format" );
+    }
+}
+
+void readArrangement( std::istream& is, Arrangement& arr, ArrangementFormat format )
+{
+    switch( format )
+    {
+        case eArrFormat_Text:
+            {
+                Formatter formatter;
+                CGAL::read( arr, is, formatter );
+            }
+            break;
+        case eArrFormat_Binary:
+            {
+                BinaryFormatter formatter;
+                CGAL::read( arr, is, formatter );
+            }
+            break;
+        default:
+            THROW_RTE( "Unknown arrangement format" );
+    }
+}
+
+}
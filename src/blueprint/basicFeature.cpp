@@ -1,5 +1,6 @@
 #include "blueprint/basicFeature.h"
 #include "blueprint/blueprint.h"
+#include "blueprint/isolate.h"
 
 #include "blueprint/factory.h"
 #include "blueprint/serialisation.h"
@@ -103,6 +104,11 @@ std::string Feature_Point::getStatement() const
     }
     return os.str();
 }
+
+void Feature_Point::isolateGeometry()
+{
+    m_ptOrigin = isolate( m_ptOrigin );
+}
     
 const GlyphSpec* Feature_Point::getParent( int id ) const 
 { 
@@ -240,6 +246,7 @@ void Feature_Contour::setSinglePoint( Float x, Float y )
     m_polygon.clear();
     m_polygon.push_back( Point( Map_FloorAverage()( x ), Map_FloorAverage()( y ) ) );
     recalculateControlPoints();
+    setModified();
 }
 
 void Feature_Contour::set( const Polygon& shape )
@@ -253,9 +260,15 @@ void Feature_Contour::set( const Polygon& shape )
             *i = Point( Map_FloorAverage()( CGAL::to_double( i->x() ) ), 
                         Map_FloorAverage()( CGAL::to_double( i->y() ) ) );
         recalculateControlPoints();
+        setModified();
     }
 }
 
+void Feature_Contour::isolateGeometry()
+{
+    m_polygon = isolate( m_polygon );
+}
+
 void Feature_Contour::recalculateControlPoints()
 {
     generics::deleteAndClear( m_points );
@@ -62,9 +62,7 @@ void Blueprint::save( Ed::Node& node ) const
 
 void Blueprint::evaluate( const EvaluationMode& mode, EvaluationResults& results )
 {
-    for( Site::PtrVector::iterator i = m_sites.begin(),
-        iEnd = m_sites.end(); i!=iEnd; ++i )
-        (*i)->evaluate( mode, results );
+    evaluateChildren( mode, results );
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "blueprint/boundsGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Blueprint
+{
+
+BoundsGrid::BoundsGrid()
+{
+}
+
+BoundsGrid::BoundsGrid( const std::vector< float >& bounds )
+{
+    const std::uint32_t uItems = static_cast< std::uint32_t >( bounds.size() / 4U );
+    if( !uItems )
+        return;
+    
+    float fMaxX = bounds[ 2 ], fMaxY = bounds[ 3 ];
+    m_fMinX = bounds[ 0 ];
+    m_fMinY = bounds[ 1 ];
+    for( std::uint32_t uItem = 0U; uItem != uItems; ++uItem )
+    {
+        const float* pBounds = bounds.data() + uItem * 4U;
+        m_fMinX = std::min( m_fMinX, pBounds[ 0 ] );
+        m_fMinY = std::min( m_fMinY, pBounds[ 1 ] );
+        fMaxX   = std::max( fMaxX, pBounds[ 2 ] );
+        fMaxY   = std::max( fMaxY, pBounds[ 3 ] );
+    }
+    
+    const float fWidth  = std::max( fMaxX - m_fMinX, 1e-3f );
+    const float fHeight = std::max( fMaxY - m_fMinY, 1e-3f );
+    m_fBucketSize = std::sqrt( fWidth * fHeight / static_cast< float >( uItems ) );
+    m_uColumns    = std::min( 4096U, static_cast< std::uint32_t >( fWidth / m_fBucketSize ) + 1U );
+    m_uRows       = std::min( 4096U, static_cast< std::uint32_t >( fHeight / m_fBucketSize ) + 1U );
+    m_fBucketSize = std::max( fWidth / m_uColumns, fHeight / m_uRows ) * 1.0001f;
+    
+    //bucket the items by counting then filling
+    auto forEachBucket = [ this, &bounds ]( std::uint32_t uItem, auto&& functor )
+    {
+        const float* pBounds = bounds.data() + uItem * 4U;
+        const std::uint32_t uX1 = std::min( m_uColumns - 1U, static_cast< std::uint32_t >( ( pBounds[ 0 ] - m_fMinX ) / m_fBucketSize ) );
+        const std::uint32_t uX2 = std::min( m_uColumns - 1U, static_cast< std::uint32_t >( ( pBounds[ 2 ] - m_fMinX ) / m_fBucketSize ) );
+        const std::uint32_t uY1 = std::min( m_uRows - 1U, static_cast< std::uint32_t >( ( pBounds[ 1 ] - m_fMinY ) / m_fBucketSize ) );
+        const std::uint32_t uY2 = std::min( m_uRows - 1U, static_cast< std::uint32_t >( ( pBounds[ 3 ] - m_fMinY ) / m_fBucketSize ) );
+        for( std::uint32_t uY = uY1; uY <= uY2; ++uY )
+            for( std::uint32_t uX = uX1; uX <= uX2; ++uX )
+                functor( uY * m_uColumns + uX );
+    };
+    
+    m_bucketStart.assign( m_uColumns * m_uRows + 1U, 0U );
+    for( std::uint32_t uItem = 0U; uItem != uItems; ++uItem )
+    {
+        forEachBucket( uItem, [ this ]( std::uint32_t uBucket ){ ++m_bucketStart[ uBucket + 1U ]; } );
+    }
+    for( std::size_t sz = 1U; sz < m_bucketStart.size(); ++sz )
+    {
+        m_bucketStart[ sz ] += m_bucketStart[ sz - 1U ];
+    }
+    m_bucketItems.resize( m_bucketStart.back() );
+    std::vector< std::uint32_t > fill( m_bucketStart.begin(), m_bucketStart.end() - 1 );
+    for( std::uint32_t uItem = 0U; uItem != uItems; ++uItem )
+    {
+        forEachBucket( uItem, [ this, &fill, uItem ]( std::uint32_t uBucket )
+        { 
+            m_bucketItems[ fill[ uBucket ]++ ] = uItem; 
+        } );
+    }
+}
+
+void BoundsGrid::find( float fX, float fY, const std::uint32_t*& pBegin, const std::uint32_t*& pEnd ) const
+{
+    pBegin = pEnd = nullptr;
+    if( m_bucketStart.empty() )
+        return;
+    
+    const float fColumn = ( fX - m_fMinX ) / m_fBucketSize;
+    const float fRow    = ( fY - m_fMinY ) / m_fBucketSize;
+    if( !( fColumn >= 0.0f && fRow >= 0.0f && fColumn < m_uColumns && fRow < m_uRows ) )
+        return;
+    
+    const std::uint32_t uBucket = static_cast< std::uint32_t >( fRow ) * m_uColumns + static_cast< std::uint32_t >( fColumn );
+    pBegin  = m_bucketItems.data() + m_bucketStart[ uBucket ];
+    pEnd    = m_bucketItems.data() + m_bucketStart[ uBucket + 1U ];
+}
+
+}
@@ -0,0 +1,313 @@
+#include "blueprint/cellComplex.h"
+#include "blueprint/binaryIO.h"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+    //twice the signed area of the triangle so positive when counter clockwise
+    inline double orientation( const std::vector< float >& vertices, 
+        std::uint32_t a, std::uint32_t b, std::uint32_t c )
+    {
+        const double ax = vertices[ a * 2U ], ay = vertices[ a * 2U + 1U ];
+        const double bx = vertices[ b * 2U ], by = vertices[ b * 2U + 1U ];
+        const double cx = vertices[ c * 2U ], cy = vertices[ c * 2U + 1U ];
+        return ( bx - ax ) * ( cy - ay ) - ( by - ay ) * ( cx - ax );
+    }
+    
+    //collinear vertices are allowed but not spikes which turn back along the same line
+    inline bool isConvex( const std::vector< float >& vertices, 
+        std::uint32_t uPrev, std::uint32_t u, std::uint32_t uNext )
+    {
+        const double dOrientation = orientation( vertices, uPrev, u, uNext );
+        if( dOrientation != 0.0 )
+            return dOrientation > 0.0;
+        const double dx1 = vertices[ u * 2U ] - vertices[ uPrev * 2U ];
+        const double dy1 = vertices[ u * 2U + 1U ] - vertices[ uPrev * 2U + 1U ];
+        const double dx2 = vertices[ uNext * 2U ] - vertices[ u * 2U ];
+        const double dy2 = vertices[ uNext * 2U + 1U ] - vertices[ u * 2U + 1U ];
+        return dx1 * dx2 + dy1 * dy2 > 0.0;
+    }
+    
+    std::uint32_t findRoot( std::vector< std::uint32_t >& parents, std::uint32_t u )
+    {
+        while( parents[ u ] != u )
+        {
+            parents[ u ] = parents[ parents[ u ] ];
+            u = parents[ u ];
+        }
+        return u;
+    }
+}
+
+namespace Blueprint
+{
+
+CellComplex::CellComplex()
+{
+}
+
+CellComplex::CellComplex( const NavMesh& navMesh )
+    :   m_vertices( navMesh.getVertices() )
+{
+    const std::vector< std::uint32_t >& indices     = navMesh.getIndices();
+    const std::vector< std::uint32_t >& adjacency   = navMesh.getAdjacency();
+    const std::uint32_t uTriangles = static_cast< std::uint32_t >( navMesh.getTriangleCount() );
+    
+    //each cell is a loop of vertices and the triangle across each edge.  Cells are 
+    //identified by the root of their triangles and merged loops stay with the root
+    struct Edge
+    {
+        std::uint32_t uVertex, uTriangle;
+    };
+    using Loop = std::vector< Edge >;
+    std::vector< Loop > loops( uTriangles );
+    std::vector< std::uint32_t > parents( uTriangles );
+    std::iota( parents.begin(), parents.end(), 0U );
+    for( std::uint32_t t = 0U; t != uTriangles; ++t )
+    {
+        for( std::uint32_t k = 0U; k != 3U; ++k )
+            loops[ t ].push_back( Edge{ indices[ t * 3U + k ], adjacency[ t * 3U + k ] } );
+    }
+    
+    auto findEdge = []( const Loop& loop, std::uint32_t uFrom, std::uint32_t uTo ) -> std::size_t
+    {
+        const std::size_t szSize = loop.size();
+        for( std::size_t sz = 0U; sz != szSize; ++sz )
+        {
+            if( loop[ sz ].uVertex == uFrom && loop[ ( sz + 1U ) % szSize ].uVertex == uTo )
+                return sz;
+        }
+        return szSize;
+    };
+    
+    //visit each diagonal once from the lower triangle and repeat while cells merge since 
+    //a merge can make diagonals visited earlier removable
+    bool bMerged = true;
+    while( bMerged )
+    {
+        bMerged = false;
+        for( std::uint32_t t = 0U; t != uTriangles; ++t )
+        {
+            for( std::uint32_t k = 0U; k != 3U; ++k )
+            {
+                const std::uint32_t uNeighbour = adjacency[ t * 3U + k ];
+                if( uNeighbour == NavMesh::NO_TRIANGLE || uNeighbour < t )
+                    continue;
+                
+                const std::uint32_t uFirst  = findRoot( parents, t );
+                const std::uint32_t uSecond = findRoot( parents, uNeighbour );
+                if( uFirst == uSecond )
+                    continue;
+                
+                const std::uint32_t a = indices[ t * 3U + k ];
+                const std::uint32_t b = indices[ t * 3U + ( k + 1U ) % 3U ];
+            
+                Loop& first = loops[ uFirst ];
+                Loop& second = loops[ uSecond ];
+                const std::size_t szFirst = first.size(), szSecond = second.size();
+                std::size_t i = findEdge( first, a, b );
+                std::size_t j = findEdge( second, b, a );
+                VERIFY_RTE_MSG( i != szFirst && j != szSecond, "Nav mesh adjacency is inconsistent" );
+            
+                //extend to the whole shared chain since collinear vertices can split the boundary 
+                //between two cells into several edges.  The chain is edges i to i + n - 1 of the 
+                //first loop from A to B and edges j - n + 1 to j of the second from B to A
+                std::size_t n = 1U;
+                const std::size_t szMaxChain = std::min( szFirst, szSecond ) - 1U;
+                while( n < szMaxChain && 
+                    first[ ( i + szFirst - 1U ) % szFirst ].uVertex == second[ ( j + 2U ) % szSecond ].uVertex )
+                {
+                    i = ( i + szFirst - 1U ) % szFirst;
+                    j = ( j + 1U ) % szSecond;
+                    ++n;
+                }
+                while( n < szMaxChain && 
+                    first[ ( i + n + 1U ) % szFirst ].uVertex == second[ ( j + szSecond - n ) % szSecond ].uVertex )
+                {
+                    ++n;
+                }
+            
+                //removing the chain must leave both of its end points convex
+                const std::uint32_t uA = first[ i ].uVertex;
+                const std::uint32_t uB = first[ ( i + n ) % szFirst ].uVertex;
+                const std::uint32_t uBeforeA    = first[ ( i + szFirst - 1U ) % szFirst ].uVertex;
+                const std::uint32_t uAfterA     = second[ ( j + 2U ) % szSecond ].uVertex;
+                const std::uint32_t uBeforeB    = second[ ( j + szSecond - n ) % szSecond ].uVertex;
+                const std::uint32_t uAfterB     = first[ ( i + n + 1U ) % szFirst ].uVertex;
+                if( !isConvex( m_vertices, uBeforeA, uA, uAfterA ) ||
+                    !isConvex( m_vertices, uBeforeB, uB, uAfterB ) )
+                    continue;
+            
+                //the first loop from B around to A followed by the second loop from A up to B
+                Loop merged;
+                merged.reserve( szFirst + szSecond - 2U * n );
+                for( std::size_t sz = n; sz != szFirst; ++sz )
+                    merged.push_back( first[ ( i + sz ) % szFirst ] );
+                for( std::size_t sz = 0U; sz != szSecond - n; ++sz )
+                    merged.push_back( second[ ( j + 1U + sz ) % szSecond ] );
+            
+                parents[ uSecond ] = uFirst;
+                first.swap( merged );
+                Loop().swap( second );
+                bMerged = true;
+            }
+        }
+    }
+    
+    std::vector< std::uint32_t > cells( uTriangles, NO_CELL );
+    std::uint32_t uCells = 0U;
+    for( std::uint32_t t = 0U; t != uTriangles; ++t )
+    {
+        if( findRoot( parents, t ) == t )
+            cells[ t ] = uCells++;
+    }
+    
+    m_cellStarts.reserve( uCells + 1U );
+    m_cellStarts.push_back( 0U );
+    for( std::uint32_t t = 0U; t != uTriangles; ++t )
+    {
+        if( cells[ t ] == NO_CELL )
+            continue;
+        for( const Edge& edge : loops[ t ] )
+        {
+            m_cellVertices.push_back( edge.uVertex );
+            m_cellNeighbours.push_back( edge.uTriangle == NavMesh::NO_TRIANGLE ? 
+                NO_CELL : cells[ findRoot( parents, edge.uTriangle ) ] );
+        }
+        m_cellStarts.push_back( static_cast< std::uint32_t >( m_cellVertices.size() ) );
+    }
+    
+    calculateBounds();
+    m_grid = BoundsGrid( m_bounds );
+}
+
+void CellComplex::calculateBounds()
+{
+    const std::uint32_t uCells = static_cast< std::uint32_t >( getCellCount() );
+    m_bounds.resize( uCells * 4U );
+    for( std::uint32_t uCell = 0U; uCell != uCells; ++uCell )
+    {
+        float* pBounds = m_bounds.data() + uCell * 4U;
+        pBounds[ 0 ] = pBounds[ 1 ] = std::numeric_limits< float >::max();
+        pBounds[ 2 ] = pBounds[ 3 ] = -std::numeric_limits< float >::max();
+        for( const std::uint32_t* p = verticesBegin( uCell ); p != verticesEnd( uCell ); ++p )
+        {
+            const float fX = m_vertices[ *p * 2U ], fY = m_vertices[ *p * 2U + 1U ];
+            pBounds[ 0 ] = std::min( pBounds[ 0 ], fX );
+            pBounds[ 1 ] = std::min( pBounds[ 1 ], fY );
+            pBounds[ 2 ] = std::max( pBounds[ 2 ], fX );
+            pBounds[ 3 ] = std::max( pBounds[ 3 ], fY );
+        }
+    }
+}
+
+bool CellComplex::contains( std::uint32_t uCell, float fX, float fY ) const
+{
+    const float* pBounds = m_bounds.data() + uCell * 4U;
+    if( fX < pBounds[ 0 ] || fY < pBounds[ 1 ] || fX > pBounds[ 2 ] || fY > pBounds[ 3 ] )
+        return false;
+        
+    const std::uint32_t* pBegin = verticesBegin( uCell );
+    const std::uint32_t* pEnd   = verticesEnd( uCell );
+    for( const std::uint32_t* p = pBegin; p != pEnd; ++p )
+    {
+        const std::uint32_t uNext = ( p + 1 == pEnd ) ? *pBegin : *( p + 1 );
+        const double ax = m_vertices[ *p * 2U ], ay = m_vertices[ *p * 2U + 1U ];
+        const double bx = m_vertices[ uNext * 2U ], by = m_vertices[ uNext * 2U + 1U ];
+        if( ( bx - ax ) * ( fY - ay ) - ( by - ay ) * ( fX - ax ) < 0.0 )
+            return false;
+    }
+    return true;
+}
+
+boost::optional< std::uint32_t > CellComplex::findCell( float fX, float fY ) const
+{
+    const std::uint32_t* pBegin = nullptr;
+    const std::uint32_t* pEnd   = nullptr;
+    m_grid.find( fX, fY, pBegin, pEnd );
+    for( const std::uint32_t* p = pBegin; p != pEnd; ++p )
+    {
+        if( contains( *p, fX, fY ) )
+            return *p;
+    }
+    return boost::optional< std::uint32_t >();
+}
+
+bool CellComplex::isStraightReachable( float fStartX, float fStartY, float fEndX, float fEndY ) const
+{
+    //the start can lie on the boundary between several cells so try each of them
+    const std::uint32_t* pBegin = nullptr;
+    const std::uint32_t* pEnd   = nullptr;
+    m_grid.find( fStartX, fStartY, pBegin, pEnd );
+    for( const std::uint32_t* p = pBegin; p != pEnd; ++p )
+    {
+        if( contains( *p, fStartX, fStartY ) && contains( *p, fEndX, fEndY ) )
+            return true;
+    }
+    return false;
+}
+
+void CellComplex::save( std::ostream& os ) const
+{
+    writeUInt32( os, static_cast< std::uint32_t >( m_vertices.size() / 2U ) );
+    writeUInt32( os, static_cast< std::uint32_t >( getCellCount() ) );
+    writeUInt32( os, static_cast< std::uint32_t >( m_cellVertices.size() ) );
+    for( float f : m_vertices )
+        writeFloat( os, f );
+    for( std::uint32_t uStart : m_cellStarts )
+        writeUInt32( os, uStart );
+    for( std::uint32_t uVertex : m_cellVertices )
+        writeUInt32( os, uVertex );
+    for( std::uint32_t uNeighbour : m_cellNeighbours )
+        writeUInt32( os, uNeighbour );
+}
+
+void CellComplex::load( std::istream& is )
+{
+    const std::uint32_t uVertices   = readUInt32( is );
+    const std::uint32_t uCells      = readUInt32( is );
+    const std::uint32_t uEdges      = readUInt32( is );
+    //two floats per vertex, the starts then a vertex and a neighbour per edge
+    verifyAvailable( is, static_cast< std::uint64_t >( uVertices ) * 2U + 
+        static_cast< std::uint64_t >( uCells ) + 1U + static_cast< std::uint64_t >( uEdges ) * 2U, 4U );
+    
+    m_vertices.resize( static_cast< std::size_t >( uVertices ) * 2U );
+    for( float& f : m_vertices )
+        f = readFloat( is );
+    
+    //cells of at least three edges run from the first edge to the last without overlapping
+    m_cellStarts.resize( static_cast< std::size_t >( uCells ) + 1U );
+    for( std::size_t sz = 0U; sz != m_cellStarts.size(); ++sz )
+    {
+        const std::uint32_t uStart = readUInt32( is );
+        VERIFY_RTE_MSG( sz ? ( uStart >= static_cast< std::uint64_t >( m_cellStarts[ sz - 1U ] ) + 3U && uStart <= uEdges ) : uStart == 0U, 
+            "Invalid cell start: " << uStart );
+        m_cellStarts[ sz ] = uStart;
+    }
+    VERIFY_RTE_MSG( m_cellStarts.back() == uEdges, "Cell starts do not cover the edges" );
+    
+    m_cellVertices.resize( uEdges );
+    for( std::uint32_t& uVertex : m_cellVertices )
+    {
+        uVertex = readUInt32( is );
+        VERIFY_RTE_MSG( uVertex < uVertices, "Invalid cell vertex: " << uVertex );
+    }
+    
+    m_cellNeighbours.resize( uEdges );
+    for( std::uint32_t& uNeighbour : m_cellNeighbours )
+    {
+        uNeighbour = readUInt32( is );
+        VERIFY_RTE_MSG( uNeighbour < uCells || uNeighbour == NO_CELL, "Invalid cell neighbour: " << uNeighbour );
+    }
+    
+    calculateBounds();
+    m_grid = BoundsGrid( m_bounds );
+}
+
+}
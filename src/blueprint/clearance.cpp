@@ -0,0 +1,195 @@
+#include "blueprint/clearance.h"
+#include "blueprint/rasteriser.h"
+#include "blueprint/visibility.h"
+#include "blueprint/binaryIO.h"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Blueprint
+{
+
+ClearanceField::ClearanceField()
+{
+}
+
+ClearanceField::ClearanceField( const FloorAnalysis& floor, float fResolution )
+    :   m_fResolution( fResolution )
+{
+    VERIFY_RTE_MSG( fResolution > 0.0f, "Invalid clearance resolution: " << fResolution );
+    
+    const Arrangement::Face_const_handle hFloorFace = floor.getFloorFace();
+    
+    //the outer boundary bounds the floor and a one pixel margin keeps the border outside
+    double dMinX = std::numeric_limits< double >::max(), dMinY = dMinX;
+    double dMaxX = -dMinX, dMaxY = -dMinX;
+    {
+        Arrangement::Ccb_halfedge_const_circulator iter = hFloorFace->outer_ccb();
+        Arrangement::Ccb_halfedge_const_circulator start = iter;
+        do
+        {
+            const double dX = CGAL::to_double( iter->target()->point().x() );
+            const double dY = CGAL::to_double( iter->target()->point().y() );
+            dMinX = std::min( dMinX, dX ); dMaxX = std::max( dMaxX, dX );
+            dMinY = std::min( dMinY, dY ); dMaxY = std::max( dMaxY, dY );
+            ++iter;
+        }
+        while( iter != start );
+    }
+    m_fOriginX  = static_cast< float >( dMinX - fResolution );
+    m_fOriginY  = static_cast< float >( dMinY - fResolution );
+    m_uiWidth   = static_cast< unsigned int >( std::ceil( ( dMaxX - dMinX ) / fResolution ) ) + 2U;
+    m_uiHeight  = static_cast< unsigned int >( std::ceil( ( dMaxY - dMinY ) / fResolution ) ) + 2U;
+    
+    //even odd filling of the outer boundary and holes.  Antennas enclose no area
+    NavBitmap::Ptr pBitmap( new NavBitmap( m_uiWidth, m_uiHeight ) );
+    {
+        agg::path_storage path;
+        auto addCcb = [ this, &path ]( Arrangement::Ccb_halfedge_const_circulator iter )
+        {
+            Arrangement::Ccb_halfedge_const_circulator start = iter;
+            bool bFirst = true;
+            do
+            {
+                const double dX = ( CGAL::to_double( iter->source()->point().x() ) - m_fOriginX ) / m_fResolution;
+                const double dY = ( CGAL::to_double( iter->source()->point().y() ) - m_fOriginY ) / m_fResolution;
+                if( bFirst )
+                    path.move_to( dX, dY );
+                else
+                    path.line_to( dX, dY );
+                bFirst = false;
+                ++iter;
+            }
+            while( iter != start );
+            path.close_polygon();
+        };
+        addCcb( hFloorFace->outer_ccb() );
+        for( Arrangement::Hole_const_iterator
+            holeIter = hFloorFace->holes_begin(),
+            holeIterEnd = hFloorFace->holes_end();
+                holeIter != holeIterEnd; ++holeIter )
+        {
+            addCcb( *holeIter );
+        }
+        
+        //pixels at least half covered are walkable
+        Rasteriser rasteriser( pBitmap );
+        rasteriser.setFillingRule( agg::fill_even_odd );
+        rasteriser.renderPath( path, Rasteriser::ColourType( 255u ), 0.5 );
+    }
+    
+    calculateSquaredDistances( *pBitmap, m_clearance );
+    for( float& fDistance : m_clearance )
+    {
+        fDistance = std::sqrt( fDistance ) * m_fResolution;
+    }
+}
+
+//Meijster's separable algorithm.  The column pass runs a row at a time over every
+//column so the inner loops are branch free over contiguous memory and vectorise.
+//The row pass computes the lower envelope of the parabolas of each row
+void ClearanceField::calculateSquaredDistances( const NavBitmap& bitmap, std::vector< float >& distances )
+{
+    const unsigned int uiWidth  = bitmap.getWidth();
+    const unsigned int uiHeight = bitmap.getHeight();
+    const float fInfinity = static_cast< float >( uiWidth + uiHeight );
+    
+    //distance to the nearest zero pixel within the column
+    std::vector< float > columns( static_cast< std::size_t >( uiWidth ) * uiHeight );
+    {
+        const unsigned char* pRow = bitmap.get();
+        float* pColumns = columns.data();
+        for( unsigned int x = 0U; x != uiWidth; ++x )
+            pColumns[ x ] = pRow[ x ] ? fInfinity : 0.0f;
+        for( unsigned int y = 1U; y < uiHeight; ++y )
+        {
+            const unsigned char* pPixels = pRow + y * bitmap.getStride();
+            const float* pAbove = pColumns + ( y - 1U ) * uiWidth;
+            float* pCurrent = pColumns + y * uiWidth;
+            for( unsigned int x = 0U; x != uiWidth; ++x )
+                pCurrent[ x ] = pPixels[ x ] ? std::min( pAbove[ x ] + 1.0f, fInfinity ) : 0.0f;
+        }
+        for( unsigned int y = uiHeight - 1U; y-- > 0U; )
+        {
+            const float* pBelow = pColumns + ( y + 1U ) * uiWidth;
+            float* pCurrent = pColumns + y * uiWidth;
+            for( unsigned int x = 0U; x != uiWidth; ++x )
+                pCurrent[ x ] = std::min( pCurrent[ x ], pBelow[ x ] + 1.0f );
+        }
+    }
+    
+    distances.resize( static_cast< std::size_t >( uiWidth ) * uiHeight );
+    std::vector< unsigned int > parabolas( uiWidth );
+    std::vector< double > boundaries( uiWidth + 1U );
+    for( unsigned int y = 0U; y < uiHeight; ++y )
+    {
+        const float* pColumns = columns.data() + y * uiWidth;
+        auto f = [ pColumns ]( unsigned int q )
+        {
+            return static_cast< double >( pColumns[ q ] ) * pColumns[ q ];
+        };
+        auto intersection = [ &f ]( unsigned int p, unsigned int q )
+        {
+            return ( ( f( q ) + static_cast< double >( q ) * q ) - ( f( p ) + static_cast< double >( p ) * p ) ) / 
+                ( 2.0 * q - 2.0 * p );
+        };
+        
+        int k = 0;
+        parabolas[ 0 ] = 0U;
+        boundaries[ 0 ] = -std::numeric_limits< double >::max();
+        boundaries[ 1 ] = std::numeric_limits< double >::max();
+        for( unsigned int q = 1U; q < uiWidth; ++q )
+        {
+            double s = intersection( parabolas[ k ], q );
+            while( s <= boundaries[ k ] )
+            {
+                --k;
+                s = intersection( parabolas[ k ], q );
+            }
+            ++k;
+            parabolas[ k ] = q;
+            boundaries[ k ] = s;
+            boundaries[ k + 1 ] = std::numeric_limits< double >::max();
+        }
+        
+        k = 0;
+        float* pDistances = distances.data() + y * uiWidth;
+        for( unsigned int q = 0U; q < uiWidth; ++q )
+        {
+            while( boundaries[ k + 1 ] < q )
+                ++k;
+            const double dOffset = static_cast< double >( q ) - parabolas[ k ];
+            pDistances[ q ] = static_cast< float >( dOffset * dOffset + f( parabolas[ k ] ) );
+        }
+    }
+}
+
+void ClearanceField::save( std::ostream& os ) const
+{
+    writeUInt32( os, m_uiWidth );
+    writeUInt32( os, m_uiHeight );
+    writeFloat( os, m_fOriginX );
+    writeFloat( os, m_fOriginY );
+    writeFloat( os, m_fResolution );
+    for( float fClearance : m_clearance )
+        writeFloat( os, fClearance );
+}
+
+void ClearanceField::load( std::istream& is )
+{
+    m_uiWidth       = readUInt32( is );
+    m_uiHeight      = readUInt32( is );
+    m_fOriginX      = readFloat( is );
+    m_fOriginY      = readFloat( is );
+    m_fResolution   = readFloat( is );
+    VERIFY_RTE_MSG( m_fResolution > 0.0f, "Invalid clearance resolution: " << m_fResolution );
+    verifyAvailable( is, static_cast< std::uint64_t >( m_uiWidth ) * m_uiHeight, 4U );
+    m_clearance.resize( static_cast< std::size_t >( m_uiWidth ) * m_uiHeight );
+    for( float& fClearance : m_clearance )
+        fClearance = readFloat( is );
+}
+
+}
@@ -0,0 +1,153 @@
+#include "blueprint/clipperUtils.h"
+
+#include "clipper.hpp"
+
+#include <cmath>
+
+namespace
+{
+    //the half unit grid is scaled to integers
+    const double GRID_SCALE = 2.0;
+    const double GRID_LIMIT = 1.0e15;
+    
+    bool toGrid( const Blueprint::Kernel::FT& value, ClipperLib::cInt& result )
+    {
+        const double dValue = CGAL::to_double( value );
+        const double dScaled = dValue * GRID_SCALE;
+        if( std::abs( dScaled ) > GRID_LIMIT || std::floor( dScaled ) != dScaled || 
+            Blueprint::Kernel::FT( dValue ) != value )
+            return false;
+        result = static_cast< ClipperLib::cInt >( dScaled );
+        return true;
+    }
+    
+    Blueprint::Kernel::FT fromGrid( ClipperLib::cInt value )
+    {
+        return Blueprint::Kernel::FT( static_cast< double >( value ) ) / Blueprint::Kernel::FT( GRID_SCALE );
+    }
+    
+    bool toPath( const Blueprint::Polygon& polygon, ClipperLib::Path& path )
+    {
+        path.clear();
+        path.reserve( polygon.size() );
+        for( const Blueprint::Point& pt : polygon )
+        {
+            ClipperLib::IntPoint point;
+            if( !toGrid( pt.x(), point.X ) || !toGrid( pt.y(), point.Y ) )
+                return false;
+            path.push_back( point );
+        }
+        
+        //only axis aligned edges keep every intersection and offset vertex on the grid
+        for( std::size_t sz = 0U; sz != path.size(); ++sz )
+        {
+            const ClipperLib::IntPoint& p1 = path[ sz ];
+            const ClipperLib::IntPoint& p2 = path[ ( sz + 1U ) % path.size() ];
+            if( p1.X != p2.X && p1.Y != p2.Y )
+                return false;
+        }
+        return !path.empty();
+    }
+    
+    Blueprint::Polygon fromPath( const ClipperLib::Path& path, bool bCounterClockwise )
+    {
+        Blueprint::Polygon polygon;
+        for( const ClipperLib::IntPoint& point : path )
+        {
+            polygon.push_back( Blueprint::Point( fromGrid( point.X ), fromGrid( point.Y ) ) );
+        }
+        if( polygon.is_counterclockwise_oriented() != bCounterClockwise )
+            polygon.reverse_orientation();
+        return polygon;
+    }
+}
+
+namespace Blueprint
+{
+namespace Clipper
+{
+    
+bool calculateOffsets( const Polygon& contour, const Kernel::FT& wallWidth, OffsetCache::Offsets& offsets )
+{
+    ClipperLib::Path path;
+    ClipperLib::cInt delta;
+    if( !toPath( contour, path ) || !toGrid( wallWidth, delta ) )
+        return false;
+    const bool bCounterClockwise = contour.is_counterclockwise_oriented();
+    
+    //mitred offsets of axis aligned polygons match the straight skeleton offsets
+    ClipperLib::ClipperOffset offsetter( 2.0 );
+    offsetter.AddPath( path, ClipperLib::jtMiter, ClipperLib::etClosedPolygon );
+    
+    //the skeleton gives the first of several interior pieces so leave those to the kernel
+    {
+        ClipperLib::Paths interior;
+        offsetter.Execute( interior, -static_cast< double >( delta ) );
+        if( interior.size() > 1U )
+            return false;
+        offsets.interior = interior.empty() ? Polygon() : fromPath( interior.front(), bCounterClockwise );
+    }
+    
+    //and the exterior must be a single boundary without holes
+    {
+        ClipperLib::PolyTree exterior;
+        offsetter.Execute( exterior, static_cast< double >( delta ) );
+        if( exterior.Total() != 1 )
+            return false;
+        offsets.exterior = fromPath( exterior.GetFirst()->Contour, bCounterClockwise );
+    }
+    
+    return true;
+}
+
+bool clipUnion( const std::vector< Polygon >& polygons, const Polygon& interior, 
+    std::vector< Polygon >& results )
+{
+    ClipperLib::Paths paths( polygons.size() );
+    for( std::size_t sz = 0U; sz != polygons.size(); ++sz )
+    {
+        if( !toPath( polygons[ sz ], paths[ sz ] ) )
+            return false;
+    }
+    ClipperLib::Path interiorPath;
+    if( !toPath( interior, interiorPath ) )
+        return false;
+    
+    ClipperLib::PolyTree unionTree;
+    {
+        ClipperLib::Clipper clipper;
+        clipper.AddPaths( paths, ClipperLib::ptSubject, true );
+        clipper.Execute( ClipperLib::ctUnion, unionTree, ClipperLib::pftNonZero, ClipperLib::pftNonZero );
+    }
+    
+    //every outer boundary including islands within holes is clipped on its own
+    std::vector< Polygon > clipped;
+    for( ClipperLib::PolyNode* pNode = unionTree.GetFirst(); pNode; pNode = pNode->GetNext() )
+    {
+        if( pNode->IsHole() )
+            continue;
+            
+        ClipperLib::PolyTree clipTree;
+        {
+            ClipperLib::Clipper clipper;
+            clipper.AddPath( pNode->Contour, ClipperLib::ptSubject, true );
+            clipper.AddPath( interiorPath, ClipperLib::ptClip, true );
+            clipper.Execute( ClipperLib::ctIntersection, clipTree, ClipperLib::pftNonZero, ClipperLib::pftNonZero );
+        }
+        for( ClipperLib::PolyNode* pClip = clipTree.GetFirst(); pClip; pClip = pClip->GetNext() )
+        {
+            if( !pClip->IsHole() )
+            {
+                Polygon polygon = fromPath( pClip->Contour, true );
+                if( !polygon.is_empty() && polygon.is_simple() )
+                    clipped.push_back( polygon );
+            }
+        }
+    }
+    
+    results.insert( results.end(), clipped.begin(), clipped.end() );
+    return true;
+}
+
+}
+}
@@ -5,6 +5,8 @@
 #include "blueprint/connection.h"
 
 #include <algorithm>
+#include <array>
+#include <iterator>
 
 namespace
 {
@@ -51,17 +53,41 @@ namespace Blueprint
 {
 
 Compilation::Compilation()
+    :   m_pArr( new Arrangement ),
+        m_arr( *m_pArr )
 {
     
 }
 
 Compilation::Compilation( Blueprint::Ptr pBlueprint )
+    :   m_pArr( new Arrangement ),
+        m_arr( *m_pArr )
 {
-    for( Site::Ptr pSite : pBlueprint->getSites() )
+    //gather all interior and inner exterior contours and insert them with a single sweep
     {
-        recurse( pSite );
+        CurveVector curves;
+        for( Site::Ptr pSite : pBlueprint->getSites() )
+        {
+            recurse( pSite, curves );
+        }
+        CGAL::insert( m_arr, curves.begin(), curves.end() );
     }
-    for( Site::Ptr pSite : pBlueprint->getSites() )
+    
+    connectAndFinalise( pBlueprint->getSites() );
+}
+
+Compilation::Compilation( IncrementalCompiler& compiler, Blueprint::Ptr pBlueprint )
+    :   m_pArr( new Arrangement ),
+        m_arr( *m_pArr )
+{
+    //the compiler keeps its arrangement fully compiled and owns it for the next update
+    compiler.update( pBlueprint );
+    m_arr = compiler.m_arr;
+}
+
+void Compilation::connectAndFinalise( const Site::PtrVector& sites )
+{
+    for( Site::Ptr pSite : sites )
     {
         connect( pSite );
     }
@@ -76,9 +102,14 @@ Compilation::Compilation( Blueprint::Ptr pBlueprint )
         }
     }
     
-    for( Site::Ptr pSite : pBlueprint->getSites() )
+    //the site contours are swept into the connected arrangement in one pass
     {
-        recursePost( pSite );
+        CurveVector curves;
+        for( Site::Ptr pSite : sites )
+        {
+            recursePost( pSite, curves );
+        }
+        CGAL::insert( m_arr, curves.begin(), curves.end() );
     }
     
     for( Arrangement::Halfedge_handle i : edges )
@@ -90,17 +121,28 @@ Compilation::Compilation( Blueprint::Ptr pBlueprint )
     }
 }
 
-void Compilation::renderContour( Arrangement& arr, const Transform& transform, const Polygon& polyOriginal )
+void Compilation::renderContour( CurveVector& curves, const Transform& transform, 
+    const boost::optional< DiscreteTransform >& discrete, const Polygon& polyOriginal )
 {
     Polygon poly = polyOriginal;
     
-    //transform to absolute coordinates
-    for( Point& pt : poly )
+    //transform to absolute coordinates avoiding the exact matrix for editor transforms
+    if( discrete )
+    {
+        for( Point& pt : poly )
+        {
+            pt = discrete.get()( pt );
+        }
+    }
+    else
     {
-        pt = transform( pt );
+        for( Point& pt : poly )
+        {
+            pt = transform( pt );
+        }
     }
 
-    //render the line segments
+    //collect the line segments
     for( auto i = poly.begin(),
         iNext = poly.begin(),
         iEnd = poly.end();
@@ -108,118 +150,199 @@ void Compilation::renderContour( Arrangement& arr, const Transform& transform, c
     {
         ++iNext;
         if( iNext == iEnd ) iNext = poly.begin();
-        CGAL::insert( arr, Curve( *i, *iNext ) );
+        curves.push_back( Curve( *i, *iNext ) );
     }
 }
 
-void Compilation::recurse( Site::Ptr pSite )
+void Compilation::renderContour( Arrangement& arr, const Transform& transform, 
+    const boost::optional< DiscreteTransform >& discrete, const Polygon& poly )
 {
-    if( Space::Ptr pSpace = boost::dynamic_pointer_cast< Space >( pSite ) )
-    {
-        const Transform transform = pSpace->getAbsoluteTransform();
+    CurveVector curves;
+    renderContour( curves, transform, discrete, poly );
+    CGAL::insert( arr, curves.begin(), curves.end() );
+}
 
-        //render the interior polygon
-        renderContour( m_arr, transform, pSpace->getInteriorPolygon() );
+void Compilation::renderSpace( Space::Ptr pSpace, const Transform& transform, 
+    const boost::optional< DiscreteTransform >& discrete, CurveVector& curves )
+{
+    //render the interior polygon
+    renderContour( curves, transform, discrete, pSpace->getInteriorPolygon() );
 
-        //render the exterior polygons
+    //render the exterior polygons
+    {
+        for( const auto& p : pSpace->getInnerAreaExteriorPolygons() )
         {
-            for( const auto& p : pSpace->getInnerAreaExteriorPolygons() )
-            {
-                renderContour( m_arr, transform, p.second );
-            }
+            renderContour( curves, transform, discrete, p.second );
         }
     }
+}
+
+void Compilation::recurse( Site::Ptr pSite, CurveVector& curves )
+{
+    if( Space::Ptr pSpace = boost::dynamic_pointer_cast< Space >( pSite ) )
+    {
+        renderSpace( pSpace, pSpace->getAbsoluteTransform(), pSpace->getAbsoluteDiscreteTransform(), curves );
+    }
 
     for( Site::Ptr pNestedSite : pSite->getSites() )
     {
-        recurse( pNestedSite );
+        recurse( pNestedSite, curves );
     }
 }
 
-void Compilation::recursePost( Site::Ptr pSite )
+void Compilation::recursePost( Site::Ptr pSite, CurveVector& curves )
 {
     if( Space::Ptr pSpace = boost::dynamic_pointer_cast< Space >( pSite ) )
     {
         const Transform transform = pSpace->getAbsoluteTransform();
 
         //render the site polygon
-        renderContour( m_arr, transform, pSpace->getContourPolygon() );
+        renderContour( curves, transform, pSpace->getAbsoluteDiscreteTransform(), pSpace->getContourPolygon() );
     }
 
     for( Site::Ptr pNestedSite : pSite->getSites() )
     {
-        recursePost( pNestedSite );
+        recursePost( pNestedSite, curves );
     }
 }
 
-void constructConnectionEdges( Arrangement& arr, Connection::Ptr pConnection,
-        Arrangement::Halfedge_handle firstBisectorEdge,
-        Arrangement::Halfedge_handle secondBisectorEdge )
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+namespace
 {
-
-    Arrangement::Vertex_handle vFirstStart  = firstBisectorEdge->source();
-    Arrangement::Vertex_handle vFirstEnd    = firstBisectorEdge->target();
-    Arrangement::Vertex_handle vSecondStart = secondBisectorEdge->source();
-    Arrangement::Vertex_handle vSecondEnd   = secondBisectorEdge->target();
-
-    const Point ptFirstStart  = vFirstStart->point();
-    const Point ptFirstEnd    = vFirstEnd->point();
-    const Point ptSecondStart = vSecondStart->point();
-    const Point ptSecondEnd   = vSecondEnd->point();
-    const Point ptFirstMid    = ptFirstStart  + ( ptFirstEnd - ptFirstStart )   / 2.0;
-    const Point ptSecondMid   = ptSecondStart + ( ptSecondEnd - ptSecondStart ) / 2.0;
-
-    Arrangement::Halfedge_handle hFirstStartToMid =
-        arr.split_edge( firstBisectorEdge, ptFirstMid );
-    Arrangement::Vertex_handle vFirstMid = hFirstStartToMid->target();
-
-    Arrangement::Halfedge_handle hSecondStartToMid =
-        arr.split_edge( secondBisectorEdge, ptSecondMid );
-    Arrangement::Vertex_handle vSecondMid = hSecondStartToMid->target();
-
-    //create edge between mid points
-    Arrangement::Halfedge_handle m_hDoorStep;
+    //everything connecting a connection changed so the incremental compiler can undo it
+    struct ConnectionEdits
+    {
+        std::vector< Curve_handle > curves;
+        //removed edges and the curves which induced them
+        std::vector< std::pair< Curve, std::vector< const Curve* > > > removedEdges;
+    };
+    
+    void removeEdge( Arrangement& arr, Arrangement::Halfedge_handle h, ConnectionEdits& edits )
     {
-        const Curve segDoorStep( ptFirstMid, ptSecondMid );
-        m_hDoorStep = arr.insert_at_vertices( segDoorStep, vFirstMid, vSecondMid );
+        std::vector< const Curve* > curves;
+        for( auto i = arr.originating_curves_begin( h ); i != arr.originating_curves_end( h ); ++i )
+        {
+            const Curve& curve = *i;
+            curves.push_back( &curve );
+        }
+        edits.removedEdges.push_back( std::make_pair( Curve( h->source()->point(), h->target()->point() ), curves ) );
+        arr.remove_edge( h );
     }
-
-    m_hDoorStep->set_data( (DefaultedBool( true )) );
-    m_hDoorStep->twin()->set_data( (DefaultedBool( true )) );
-
+    
+    void removeEdgeTo( Arrangement& arr, Arrangement::Vertex_handle vFrom, 
+        Arrangement::Vertex_handle vFirstTo, Arrangement::Vertex_handle vSecondTo, ConnectionEdits& edits )
     {
-        bool bFound = false;
         Arrangement::Halfedge_around_vertex_circulator first, iter;
-        first = iter = vFirstStart->incident_halfedges();
+        first = iter = vFrom->incident_halfedges();
         do
         {
-            if( ( iter->source() == vSecondStart ) || ( iter->source() == vSecondEnd ) )
+            if( ( iter->source() == vFirstTo ) || ( iter->source() == vSecondTo ) )
             {
-                arr.remove_edge( iter );
-                bFound = true;
-                break;
+                removeEdge( arr, iter, edits );
+                return;
             }
             ++iter;
         }
         while( iter != first );
-        VERIFY_RTE( bFound );
+        THROW_RTE( "Failed to find connection wall edge" );
     }
+
+    void constructConnectionEdges( Arrangement& arr,
+            Arrangement::Halfedge_handle firstBisectorEdge,
+            Arrangement::Halfedge_handle secondBisectorEdge,
+            ConnectionEdits& edits )
     {
+        Arrangement::Vertex_handle vFirstStart  = firstBisectorEdge->source();
+        Arrangement::Vertex_handle vFirstEnd    = firstBisectorEdge->target();
+        Arrangement::Vertex_handle vSecondStart = secondBisectorEdge->source();
+        Arrangement::Vertex_handle vSecondEnd   = secondBisectorEdge->target();
+
+        const Point ptFirstStart  = vFirstStart->point();
+        const Point ptFirstEnd    = vFirstEnd->point();
+        const Point ptSecondStart = vSecondStart->point();
+        const Point ptSecondEnd   = vSecondEnd->point();
+        const Point ptFirstMid    = ptFirstStart  + ( ptFirstEnd - ptFirstStart )   / 2.0;
+        const Point ptSecondMid   = ptSecondStart + ( ptSecondEnd - ptSecondStart ) / 2.0;
+
+        arr.split_edge( firstBisectorEdge, ptFirstMid );
+        arr.split_edge( secondBisectorEdge, ptSecondMid );
+
+        //the doorstep between the mid points is a curve of its own so it survives the
+        //removal of any curve overlapping it
+        {
+            Curve_handle hDoorStep = CGAL::insert( arr, Curve( ptFirstMid, ptSecondMid ) );
+            for( auto i = arr.induced_edges_begin( hDoorStep ); i != arr.induced_edges_end( hDoorStep ); ++i )
+            {
+                Arrangement::Halfedge_handle h = *i;
+                h->set_data( (DefaultedBool( true )) );
+                h->twin()->set_data( (DefaultedBool( true )) );
+            }
+            edits.curves.push_back( hDoorStep );
+        }
+
+        //open the walls either side of the doorstep
+        removeEdgeTo( arr, vFirstStart, vSecondStart, vSecondEnd, edits );
+        removeEdgeTo( arr, vFirstEnd,   vSecondStart, vSecondEnd, edits );
+    }
+    
+    //inserts one connection segment returning the edge between the walls and the
+    //edges reaching the segment end points which are removed
+    Arrangement::Halfedge_handle insertConnectionSegment( Arrangement& arr, Connection::Ptr pConnection,
+        const Point& ptStart, const Point& ptEnd, 
+        std::vector< Arrangement::Halfedge_handle >& toRemove, ConnectionEdits& edits )
+    {
+        Curve_handle hCurve = CGAL::insert( arr, Curve( ptStart, ptEnd ) );
+        edits.curves.push_back( hCurve );
+        
+        Arrangement::Halfedge_handle bisectorEdge;
         bool bFound = false;
-        Arrangement::Halfedge_around_vertex_circulator first, iter;
-        first = iter = vFirstEnd->incident_halfedges();
-        do
+        for( auto i = arr.induced_edges_begin( hCurve ); i != arr.induced_edges_end( hCurve ); ++i )
         {
-            if( ( iter->source() == vSecondStart ) || ( iter->source() == vSecondEnd ) )
+            Arrangement::Halfedge_handle h = *i;
+            if( ( h->source()->point() == ptStart ) ||
+                ( h->source()->point() == ptEnd   ) ||
+                ( h->target()->point() == ptStart ) ||
+                ( h->target()->point() == ptEnd   ) )
             {
-                arr.remove_edge( iter );
+                toRemove.push_back( h );
+            }
+            else
+            {
+                VERIFY_RTE_MSG( !bFound, "Failed to construct connection: " << pConnection->Node::getName() );
+                bisectorEdge = h;
                 bFound = true;
-                break;
             }
-            ++iter;
         }
-        while( iter != first );
-        VERIFY_RTE( bFound );
+        VERIFY_RTE_MSG( bFound, "Failed to construct connection: " << pConnection->Node::getName() );
+        return bisectorEdge;
+    }
+    
+    void connectConnection( Arrangement& arr, Connection::Ptr pConnection, 
+        const Transform& transform, ConnectionEdits& edits )
+    {
+        std::vector< Arrangement::Halfedge_handle > toRemove;
+        
+        const Segment firstSeg  = pConnection->getFirstSegment().transform( transform );
+        const Segment secondSeg = pConnection->getSecondSegment().transform( transform );
+        
+        Arrangement::Halfedge_handle firstBisectorEdge = 
+            insertConnectionSegment( arr, pConnection, firstSeg[ 0 ], firstSeg[ 1 ], toRemove, edits );
+        Arrangement::Halfedge_handle secondBisectorEdge = 
+            insertConnectionSegment( arr, pConnection, secondSeg[ 1 ], secondSeg[ 0 ], toRemove, edits );
+        
+        constructConnectionEdges( arr, firstBisectorEdge, secondBisectorEdge, edits );
+
+        for( Arrangement::Halfedge_handle h : toRemove )
+        {
+            removeEdge( arr, h, edits );
+        }
+    }
+    
+    CGAL::Bbox_2 getConnectionBounds( Connection::Ptr pConnection, const Transform& transform )
+    {
+        return pConnection->getFirstSegment().transform( transform ).bbox() + 
+            pConnection->getSecondSegment().transform( transform ).bbox();
     }
 }
 
@@ -227,88 +350,465 @@ void Compilation::connect( Site::Ptr pSite )
 {
     if( Connection::Ptr pConnection = boost::dynamic_pointer_cast< Connection >( pSite ) )
     {
-        const Transform transform = pConnection->getAbsoluteTransform();
-
-        //attempt to find the four connection vertices
-        std::vector< Arrangement::Halfedge_handle > toRemove;
-        Arrangement::Halfedge_handle firstBisectorEdge, secondBisectorEdge;
-        bool bFoundFirst = false, bFoundSecond = false;
-        {
-            const Segment firstSeg = 
-                pConnection->getFirstSegment().transform( transform );
-
-            const Point ptFirstStart( firstSeg[ 0 ] );
-            const Point ptFirstEnd(   firstSeg[ 1 ] );
+        ConnectionEdits edits;
+        connectConnection( m_arr, pConnection, pConnection->getAbsoluteTransform(), edits );
+    }
 
-            Curve_handle firstCurve = CGAL::insert( m_arr,
-                Curve( ptFirstStart, ptFirstEnd ) );
+    for( Site::Ptr pNestedSite : pSite->getSites() )
+    {
+        connect( pNestedSite );
+    }
+}
 
-            for( auto   i = m_arr.induced_edges_begin( firstCurve );
-                        i != m_arr.induced_edges_end( firstCurve ); ++i )
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+    bool isTransformEqual( const Transform& left, const Transform& right )
+    {
+        for( int i = 0; i != 2; ++i )
+        {
+            for( int j = 0; j != 3; ++j )
             {
-                Arrangement::Halfedge_handle h = *i;
+                if( left.m( i, j ) != right.m( i, j ) )
+                    return false;
+            }
+        }
+        return true;
+    }
+    
+    using CurveKeyTuple = std::array< double, 4 >;
+    CurveKeyTuple getApproxKey( const Curve& curve )
+    {
+        return CurveKeyTuple{ 
+            CGAL::to_double( curve.source().x() ), CGAL::to_double( curve.source().y() ),
+            CGAL::to_double( curve.target().x() ), CGAL::to_double( curve.target().y() ) };
+    }
+}
 
-                if( ( h->source()->point() == ptFirstStart ) ||
-                    ( h->source()->point() == ptFirstEnd   ) ||
-                    ( h->target()->point() == ptFirstStart ) ||
-                    ( h->target()->point() == ptFirstEnd   ) )
-                {
-                    toRemove.push_back( h );
-                }
-                else
-                {
-                    firstBisectorEdge = h;
-                    VERIFY_RTE( !bFoundFirst );
-                    bFoundFirst = true;
-                }
+void IncrementalCompiler::diff( InsertedCurveVector& existing, const Compilation::CurveVector& rendered,
+        std::vector< Curve_handle >& removed, InsertedCurveVector* pOwner, 
+        Compilation::CurveVector& added, std::vector< InsertedCurveVector* >& addedOwners,
+        std::vector< CGAL::Bbox_2 >* pBounds )
+{
+    //match the rendered curves against the inserted ones so an edit only replaces
+    //the curves which actually changed
+    std::multimap< CurveKeyTuple, std::size_t > lookup;
+    for( std::size_t sz = 0U; sz != existing.size(); ++sz )
+        lookup.insert( std::make_pair( getApproxKey( existing[ sz ].curve ), sz ) );
+    
+    std::vector< bool > matched( existing.size(), false );
+    for( const Curve& curve : rendered )
+    {
+        bool bMatched = false;
+        const auto range = lookup.equal_range( getApproxKey( curve ) );
+        for( auto i = range.first; i != range.second; ++i )
+        {
+            const InsertedCurveVector::value_type& inserted = existing[ i->second ];
+            if( !matched[ i->second ] && 
+                inserted.curve.source() == curve.source() && inserted.curve.target() == curve.target() )
+            {
+                matched[ i->second ] = true;
+                bMatched = true;
+                break;
             }
         }
+        if( !bMatched )
+        {
+            added.push_back( curve );
+            addedOwners.push_back( pOwner );
+            if( pBounds )
+                pBounds->push_back( curve.bbox() );
+        }
+    }
+    
+    InsertedCurveVector kept;
+    for( std::size_t sz = 0U; sz != existing.size(); ++sz )
+    {
+        if( matched[ sz ] )
+        {
+            kept.push_back( existing[ sz ] );
+        }
+        else
+        {
+            removed.push_back( existing[ sz ].hCurve );
+            if( pBounds )
+                pBounds->push_back( existing[ sz ].curve.bbox() );
+        }
+    }
+    existing.swap( kept );
+}
 
+void IncrementalCompiler::recurse( Site::Ptr pSite, const Transform& parentTransform, 
+    const boost::optional< DiscreteTransform >& parentDiscrete, Changes& changes )
+{
+    const Transform transform = parentTransform * pSite->getTransform();
+    boost::optional< DiscreteTransform > discrete;
+    if( parentDiscrete && pSite->getDiscreteTransform() )
+        discrete = parentDiscrete.get() * pSite->getDiscreteTransform().get();
+    
+    //the site curves depend on its own transform and contour, the exteriors of
+    //its nested spaces and the transforms of its parents
+    const Timing::UpdateTick& latestTick = pSite->getSubtreeModifiedTick();
+    
+    if( Space::Ptr pSpace = boost::dynamic_pointer_cast< Space >( pSite ) )
+    {
+        SiteCurveMap::iterator iFind = m_sites.find( pSite );
+        bool bDirty = true;
+        if( iFind == m_sites.end() )
         {
-            const Segment secondSeg = 
-                pConnection->getSecondSegment().transform( transform );
+            iFind = m_sites.insert( std::make_pair( pSite, SiteCurves() ) ).first;
+        }
+        else if( !( iFind->second.tick < latestTick ) && 
+            isTransformEqual( iFind->second.transform, transform ) )
+        {
+            bDirty = false;
+        }
+        
+        SiteCurves& siteCurves = iFind->second;
+        siteCurves.bVisited = true;
+        if( bDirty )
+        {
+            siteCurves.tick         = latestTick;
+            siteCurves.transform    = transform;
+            
+            Compilation::CurveVector interior, contour;
+            Compilation::renderSpace( pSpace, transform, discrete, interior );
+            Compilation::renderContour( contour, transform, discrete, pSpace->getContourPolygon() );
+            
+            diff( siteCurves.interior, interior, changes.removedInterior, &siteCurves.interior,
+                changes.addedInterior, changes.addedInteriorOwners, &changes.bounds );
+            diff( siteCurves.contour, contour, changes.removedContour, &siteCurves.contour,
+                changes.addedContour, changes.addedContourOwners, nullptr );
+            ++m_statistics.szSitesUpdated;
+        }
+        else
+        {
+            ++m_statistics.szSitesUnchanged;
+        }
+    }
+    else if( Connection::Ptr pConnection = boost::dynamic_pointer_cast< Connection >( pSite ) )
+    {
+        ConnectionMap::iterator iFind = m_connections.find( pSite );
+        bool bDirty = true;
+        if( iFind == m_connections.end() )
+        {
+            iFind = m_connections.insert( std::make_pair( pSite, ConnectionCurves() ) ).first;
+        }
+        else if( !( iFind->second.tick < latestTick ) && 
+            isTransformEqual( iFind->second.transform, transform ) )
+        {
+            bDirty = false;
+        }
+        
+        ConnectionCurves& connectionCurves = iFind->second;
+        connectionCurves.bVisited   = true;
+        connectionCurves.bDirty     = bDirty;
+        if( bDirty )
+        {
+            connectionCurves.tick       = latestTick;
+            connectionCurves.transform  = transform;
+            connectionCurves.bounds     = getConnectionBounds( pConnection, transform );
+        }
+        changes.connections.push_back( iFind );
+    }
+    
+    for( Site::Ptr pNestedSite : pSite->getSites() )
+    {
+        recurse( pNestedSite, transform, discrete, changes );
+    }
+}
 
-            const Point ptSecondStart( secondSeg[ 1 ] );
-            const Point ptSecondEnd(   secondSeg[ 0 ] );
+IncrementalCompiler::CurveId IncrementalCompiler::track( Curve_handle hCurve )
+{
+    const CurveId id = m_nextCurveId++;
+    VERIFY_RTE( m_curveIds.insert( std::make_pair( &*hCurve, id ) ).second );
+    return id;
+}
 
-            Curve_handle secondCurve = CGAL::insert( m_arr,
-                Curve( ptSecondStart, ptSecondEnd ) );
+IncrementalCompiler::CurveId IncrementalCompiler::untrack( Curve_handle hCurve )
+{
+    std::map< const Curve*, CurveId >::iterator iFind = m_curveIds.find( &*hCurve );
+    VERIFY_RTE( iFind != m_curveIds.end() );
+    const CurveId id = iFind->second;
+    m_curveIds.erase( iFind );
+    return id;
+}
 
-            for( auto   i = m_arr.induced_edges_begin( secondCurve );
-                        i != m_arr.induced_edges_end( secondCurve ); ++i )
+void IncrementalCompiler::removeWall( Curve_handle hCurve )
+{
+    const CurveId id = untrack( hCurve );
+    m_walls.erase( id );
+    CGAL::remove_curve( m_arr, hCurve );
+    ++m_statistics.szCurvesRemoved;
+    
+    //patches only go once none of the walls they restore remain
+    for( PatchMap::iterator i = m_patches.begin(); i != m_patches.end(); )
+    {
+        std::vector< CurveId >& owners = i->second.owners;
+        owners.erase( std::remove( owners.begin(), owners.end(), id ), owners.end() );
+        if( owners.empty() )
+        {
+            untrack( i->second.hCurve );
+            CGAL::remove_curve( m_arr, i->second.hCurve );
+            i = m_patches.erase( i );
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void IncrementalCompiler::uncut( ConnectionCurves& connectionCurves )
+{
+    if( !connectionCurves.bCut )
+        return;
+    
+    for( Curve_handle hCurve : connectionCurves.curves )
+    {
+        CGAL::remove_curve( m_arr, hCurve );
+        ++m_statistics.szCurvesRemoved;
+    }
+    connectionCurves.curves.clear();
+    
+    //restore the wall pieces removed for the doorway
+    for( const Doorway& doorway : connectionCurves.doorways )
+    {
+        std::vector< CurveId > owners;
+        for( CurveId id : doorway.owners )
+        {
+            if( m_walls.count( id ) )
+                owners.push_back( id );
+        }
+        if( !owners.empty() )
+        {
+            Curve_handle hPatch = CGAL::insert( m_arr, doorway.curve );
+            m_patches.insert( std::make_pair( track( hPatch ), Patch{ hPatch, owners } ) );
+            ++m_statistics.szCurvesInserted;
+        }
+    }
+    connectionCurves.doorways.clear();
+    connectionCurves.bCut = false;
+}
+
+void IncrementalCompiler::cut( Connection::Ptr pConnection, ConnectionCurves& connectionCurves )
+{
+    ConnectionEdits edits;
+    connectConnection( m_arr, pConnection, connectionCurves.transform, edits );
+    
+    connectionCurves.curves = edits.curves;
+    m_statistics.szCurvesInserted += edits.curves.size();
+    for( const auto& removed : edits.removedEdges )
+    {
+        //only wall pieces need restoring when the connection is undone.  The originating
+        //curves are all still live so their addresses identify them
+        std::vector< CurveId > owners;
+        for( const Curve* pCurve : removed.second )
+        {
+            std::map< const Curve*, CurveId >::const_iterator iId = m_curveIds.find( pCurve );
+            if( iId == m_curveIds.end() )
+                continue;
+            if( m_walls.count( iId->second ) )
             {
-                Arrangement::Halfedge_handle h = *i;
+                owners.push_back( iId->second );
+            }
+            else
+            {
+                PatchMap::const_iterator iFind = m_patches.find( iId->second );
+                if( iFind != m_patches.end() )
+                    owners.insert( owners.end(), iFind->second.owners.begin(), iFind->second.owners.end() );
+            }
+        }
+        std::sort( owners.begin(), owners.end() );
+        owners.erase( std::unique( owners.begin(), owners.end() ), owners.end() );
+        if( !owners.empty() )
+            connectionCurves.doorways.push_back( Doorway{ removed.first, owners } );
+    }
+    connectionCurves.bCut = true;
+    ++m_statistics.szConnectionsCut;
+}
+
+void IncrementalCompiler::insert( const Compilation::CurveVector& curves, 
+    const std::vector< InsertedCurveVector* >& owners, bool bWalls )
+{
+    if( curves.empty() )
+        return;
+    
+    //the aggregated insertion appends the new curves to the curve list in input 
+    //order so the handles can be recovered
+    const std::size_t szExisting = m_arr.number_of_curves();
+    CGAL::insert( m_arr, curves.begin(), curves.end() );
+    VERIFY_RTE( m_arr.number_of_curves() == szExisting + curves.size() );
+    
+    Arrangement::Curve_iterator iCurve = m_arr.curves_begin();
+    std::advance( iCurve, szExisting );
+    for( std::size_t sz = 0U; sz != curves.size(); ++sz, ++iCurve )
+    {
+        owners[ sz ]->push_back( InsertedCurve{ curves[ sz ], iCurve } );
+        if( bWalls )
+            m_walls.insert( track( iCurve ) );
+    }
+    m_statistics.szCurvesInserted += curves.size();
+}
 
-                if( ( h->source()->point() == ptSecondStart ) ||
-                    ( h->source()->point() == ptSecondEnd   ) ||
-                    ( h->target()->point() == ptSecondStart ) ||
-                    ( h->target()->point() == ptSecondEnd   ) )
+void IncrementalCompiler::update( Blueprint::Ptr pBlueprint )
+{
+    m_statistics = Statistics();
+    
+    for( auto& site : m_sites )
+        site.second.bVisited = false;
+    for( auto& connection : m_connections )
+        connection.second.bVisited = false;
+    
+    //diff the curves of the changed sites
+    Changes changes;
+    {
+        const Transform identity( CGAL::IDENTITY );
+        for( Site::Ptr pSite : pBlueprint->getSites() )
+        {
+            recurse( pSite, identity, DiscreteTransform(), changes );
+        }
+    }
+    for( SiteCurveMap::iterator i = m_sites.begin(); i != m_sites.end(); )
+    {
+        if( !i->second.bVisited )
+        {
+            for( const InsertedCurve& curve : i->second.interior )
+            {
+                changes.removedInterior.push_back( curve.hCurve );
+                changes.bounds.push_back( curve.curve.bbox() );
+            }
+            for( const InsertedCurve& curve : i->second.contour )
+                changes.removedContour.push_back( curve.hCurve );
+            ++m_statistics.szSitesRemoved;
+            i = m_sites.erase( i );
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    
+    //connections near changed walls are cut again
+    std::vector< ConnectionMap::iterator > cuts;
+    for( ConnectionMap::iterator iConnection : changes.connections )
+    {
+        ConnectionCurves& connectionCurves = iConnection->second;
+        if( !connectionCurves.bDirty )
+        {
+            for( const CGAL::Bbox_2& bounds : changes.bounds )
+            {
+                if( CGAL::do_overlap( bounds, connectionCurves.bounds ) )
+                {
+                    connectionCurves.bDirty = true;
+                    break;
+                }
+            }
+        }
+        if( connectionCurves.bDirty )
+            cuts.push_back( iConnection );
+    }
+    
+    //the contours go in after the connections so lift those crossing a connection to be cut
+    for( CurveHandleVector::const_iterator i = changes.removedContour.begin(); 
+        i != changes.removedContour.end(); ++i )
+    {
+        CGAL::remove_curve( m_arr, *i );
+        ++m_statistics.szCurvesRemoved;
+    }
+    if( !cuts.empty() )
+    {
+        for( auto& site : m_sites )
+        {
+            InsertedCurveVector kept;
+            for( const InsertedCurve& curve : site.second.contour )
+            {
+                const CGAL::Bbox_2 bounds = curve.curve.bbox();
+                bool bLift = false;
+                for( ConnectionMap::iterator iConnection : cuts )
                 {
-                    toRemove.push_back( h );
+                    if( CGAL::do_overlap( bounds, iConnection->second.bounds ) )
+                    {
+                        bLift = true;
+                        break;
+                    }
+                }
+                if( bLift )
+                {
+                    CGAL::remove_curve( m_arr, curve.hCurve );
+                    ++m_statistics.szCurvesRemoved;
+                    changes.addedContour.push_back( curve.curve );
+                    changes.addedContourOwners.push_back( &site.second.contour );
                 }
                 else
                 {
-                    secondBisectorEdge = h;
-                    VERIFY_RTE( !bFoundSecond );
-                    bFoundSecond = true;
+                    kept.push_back( curve );
                 }
             }
+            site.second.contour.swap( kept );
         }
-
-        VERIFY_RTE_MSG( bFoundFirst && bFoundSecond, "Failed to construct connection: " << pConnection->Node::getName() );
-        constructConnectionEdges( m_arr, pConnection, firstBisectorEdge, secondBisectorEdge );
-
-        //VERIFY_RTE_MSG( toRemove.size() == 4, "Bad connection" );
-        for( Arrangement::Halfedge_handle h : toRemove )
+    }
+    
+    //undo the connections being cut again or deleted
+    for( ConnectionMap::iterator iConnection : cuts )
+    {
+        uncut( iConnection->second );
+    }
+    for( ConnectionMap::iterator i = m_connections.begin(); i != m_connections.end(); )
+    {
+        if( !i->second.bVisited )
         {
-            m_arr.remove_edge( h );
+            uncut( i->second );
+            ++m_statistics.szSitesRemoved;
+            i = m_connections.erase( i );
+        }
+        else
+        {
+            ++i;
         }
-
     }
-
-    for( Site::Ptr pNestedSite : pSite->getSites() )
+    
+    //replace the changed walls
+    for( Curve_handle hCurve : changes.removedInterior )
     {
-        connect( pNestedSite );
+        removeWall( hCurve );
+    }
+    insert( changes.addedInterior, changes.addedInteriorOwners, true );
+    
+    //cut the connections in tree order matching a full compilation
+    for( ConnectionMap::iterator iConnection : cuts )
+    {
+        cut( boost::dynamic_pointer_cast< Connection >( iConnection->first ), iConnection->second );
+    }
+    
+    //drop patches which the connections cut away entirely
+    for( PatchMap::iterator i = m_patches.begin(); i != m_patches.end(); )
+    {
+        if( m_arr.number_of_induced_edges( i->second.hCurve ) == 0U )
+        {
+            untrack( i->second.hCurve );
+            CGAL::remove_curve( m_arr, i->second.hCurve );
+            i = m_patches.erase( i );
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    
+    insert( changes.addedContour, changes.addedContourOwners, false );
+    
+    for( ConnectionMap::iterator iConnection : cuts )
+    {
+        if( iConnection->second.curves.empty() )
+            continue;
+        //the doorstep is the last curve of a connection
+        const Curve_handle hDoorStep = iConnection->second.curves.back();
+        for( auto i = m_arr.induced_edges_begin( hDoorStep ); i != m_arr.induced_edges_end( hDoorStep ); ++i )
+        {
+            VERIFY_RTE_MSG( ( *i )->data().get(), "Doorstep edge lost after recursePost" );
+        }
     }
 }
 
@@ -495,16 +995,14 @@ void Compilation::renderFillers( const boost::filesystem::path& filepath )
     generateHTML( filepath, m_arr, edgeGroups, style );
 }
 
-void Compilation::save( std::ostream& os ) const
+void Compilation::save( std::ostream& os, ArrangementFormat format ) const
 {
-    Formatter formatter;
-    CGAL::write( m_arr, os, formatter );
+    writeArrangement( os, m_arr, format );
 }
 
-void Compilation::load( std::istream& is )
+void Compilation::load( std::istream& is, ArrangementFormat format )
 {
-    Formatter formatter;
-    CGAL::read( m_arr, is, formatter );
+    readArrangement( is, m_arr, format );
 }
 
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "blueprint/connection.h"
 #include "blueprint/cgalUtils.h"
+#include "blueprint/isolate.h"
 
 #include "common/assert_verify.hpp"
 #include "common/rounding.hpp"
@@ -64,16 +65,13 @@ void Connection::init( Float x, Float y )
     Site::init();
     
     setTranslation( m_transform, Map_FloorAverage()( x ), Map_FloorAverage()( y ) );
+    updateDiscreteTransform();
 }
     
 void Connection::evaluate( const EvaluationMode& mode, EvaluationResults& results )
 {
     //bottom up recursion
-    for( PtrVector::iterator i = m_sites.begin(),
-        iEnd = m_sites.end(); i!=iEnd; ++i )
-    {
-        (*i)->evaluate( mode, results );
-    }
+    evaluateChildren( mode, results );
         
     const Float fWidth                  = fabs( Math::quantize< Float >( m_pControlPoint->getX( 0 ), 1.0 ) );
     const Float fConnectionHalfHeight   = fabs( Math::quantize< Float >( m_pControlPoint->getY( 0 ), 1.0 ) );
@@ -120,6 +118,13 @@ void Connection::evaluate( const EvaluationMode& mode, EvaluationResults& result
     }
 
 }
-  
 
-}
\ No newline at end of file
+void Connection::isolateGeometry()
+{
+    Site::isolateGeometry();
+    
+    m_firstSegment  = isolate( m_firstSegment );
+    m_secondSegment = isolate( m_secondSegment );
+}
+
+}
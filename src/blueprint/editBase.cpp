@@ -18,6 +18,7 @@
 #include <sstream>
 #include <map>
 #include <iomanip>
+#include <iostream>
 
 namespace Blueprint
 {
@@ -224,6 +225,8 @@ void EditBase::interaction_evaluate()
 
     Site::EvaluationResults results;
     m_pSite->evaluate( mode, results );
+    std::cout << "Evaluated sites: " << results.szSitesEvaluated << 
+        " skipped: " << results.szSitesSkipped << std::endl;
     
     interaction_update();
 
@@ -42,11 +42,11 @@ Interaction::Interaction( EditBase& edit, IEditContext::ToolMode toolMode,
                 {
                     m_interacted.push_back( *i );
                     
-                    const Vector v = getTranslation( p->getOrigin()->getTransform() );
+                    const TransformDouble transform( p->getOrigin()->getTransform() );
                     
                     m_initialValues.push_back( 
-                        InitialValue( CGAL::to_double( v.x() ), 
-                                      CGAL::to_double( v.y() ) ) );
+                        InitialValue( transform.m[ 0 ][ 2 ], 
+                                      transform.m[ 1 ][ 2 ] ) );
                 }
             }
         }
@@ -9,6 +9,7 @@
 #include "blueprint/dataBitmap.h"
 #include "blueprint/factory.h"
 #include "blueprint/visibility.h"
+#include "blueprint/compilation.h"
 
 #include "common/assert_verify.hpp"
 #include "common/rounding.hpp"
@@ -104,12 +105,22 @@ std::shared_ptr< Analysis > EditMain::loadAnalysis( const std::string& strFilePa
 
     if( boost::filesystem::exists( visibilityPath ) )
     {
-        std::unique_ptr< boost::filesystem::ifstream > pOutFile =
-            boost::filesystem::createBinaryInputFileStream( visibilityPath );
-        pAnalysis = Analysis::constructFromStream( *pOutFile );
+        pAnalysis = Analysis::constructFromFile( visibilityPath );
     }
     
     return pAnalysis;
 }
 
+std::shared_ptr< Analysis > EditMain::compileAnalysis()
+{
+    Blueprint::Ptr pBlueprint = boost::dynamic_pointer_cast< Blueprint >( getSite() );
+    VERIFY_RTE( pBlueprint );
+    
+    if( !m_pCompiler )
+    {
+        m_pCompiler = std::make_shared< IncrementalCompiler >();
+    }
+    return Analysis::constructFromBlueprint( *m_pCompiler, pBlueprint );
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,240 @@
+
+#include "blueprint/floorQuery.h"
+#include "blueprint/isolate.h"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Blueprint
+{
+
+FloorQuery::FloorQuery()
+{
+}
+
+FloorQuery::FloorQuery( Arrangement::Face_const_handle hFloorFace )
+{
+    VERIFY_RTE( !hFloorFace->is_unbounded() );
+    
+    std::vector< Segment > boundary;
+    auto collectCcb = [ this, hFloorFace, &boundary ]( Arrangement::Ccb_halfedge_const_circulator iter )
+    {
+        Arrangement::Ccb_halfedge_const_circulator start = iter;
+        do
+        {
+            const Point& ptSource = iter->source()->point();
+            const Point& ptTarget = iter->target()->point();
+            boundary.push_back( Segment( ptSource, ptTarget ) );
+            
+            //antennas within the floor never occlude.  Each solid edge appears once
+            if( iter->twin()->face() != hFloorFace )
+            {
+                m_solidEdges.push_back( SolidEdge{ ptSource, ptTarget,
+                    CGAL::to_double( ptSource.x() ), CGAL::to_double( ptSource.y() ),
+                    CGAL::to_double( ptTarget.x() ), CGAL::to_double( ptTarget.y() ) } );
+            }
+            ++iter;
+        }
+        while( iter != start );
+    };
+    
+    collectCcb( hFloorFace->outer_ccb() );
+    
+    for( Arrangement::Hole_const_iterator
+        holeIter = hFloorFace->holes_begin(),
+        holeIterEnd = hFloorFace->holes_end();
+            holeIter != holeIterEnd; ++holeIter )
+    {
+        collectCcb( *holeIter );
+    }
+    
+    m_boundary = SegmentBVH( boundary );
+}
+
+//the holes of a face are disjoint and within its outer boundary so the crossing parity
+//over every boundary walk is odd exactly within the floor.  Antennas are walked in both
+//directions and cancel out
+bool FloorQuery::isWithinFloor( const Point& pt ) const
+{
+    if( m_boundary.isOnAny( pt ) )
+        return true;
+    
+    return ( m_boundary.countCrossings( pt ) % 2U ) == 1U;
+}
+
+//adds all boundary intersections along the segment and its end points to any existing
+//points on it and orders them from its source
+void FloorQuery::getPointsAlong( const Segment& segment, std::vector< Point >& points ) const
+{
+    points.push_back( segment.source() );
+    points.push_back( segment.target() );
+    
+    m_boundary.getIntersections( segment, points );
+    
+    const Point ptOrigin = segment.source();
+    std::sort( points.begin(), points.end(), 
+        [ &ptOrigin ]( const Point& left, const Point& right )
+        {
+            return CGAL::has_smaller_distance_to_point( ptOrigin, left, right );
+        } );
+    points.erase( std::unique( points.begin(), points.end() ), points.end() );
+}
+
+bool FloorQuery::isWithinFloor( const Segment& segment ) const
+{
+    std::vector< Point > points;
+    getPointsAlong( segment, points );
+    
+    if( points.size() == 1U )
+        return isWithinFloor( points.front() );
+    
+    //between consecutive boundary intersections the segment is either entirely within
+    //the floor, on its boundary or outside of it
+    for( std::size_t i = 1U; i < points.size(); ++i )
+    {
+        if( !isWithinFloor( CGAL::midpoint( points[ i - 1U ], points[ i ] ) ) )
+            return false;
+    }
+    return true;
+}
+
+void FloorQuery::extendWithinFloor( const Segment& segment, Point& ptStart, Point& ptEnd ) const
+{
+    VERIFY_RTE_MSG( !segment.is_degenerate(), "Cannot extend degenerate segment: " << segment );
+    
+    //between consecutive boundary hits the line is either within the floor or not
+    auto extend = [ this ]( Point& pt, const Vector& direction )
+    {
+        while( boost::optional< Point > hit = m_boundary.shootRay( pt, direction ) )
+        {
+            if( !isWithinFloor( CGAL::midpoint( pt, hit.get() ) ) )
+                break;
+            pt = hit.get();
+        }
+    };
+    
+    const Vector direction = segment.to_vector();
+    ptStart = segment.source();
+    ptEnd   = segment.target();
+    extend( ptStart, -direction );
+    extend( ptEnd, direction );
+}
+
+boost::optional< Segment > FloorQuery::getFloorBisector( const Segment& segment, bool bKeepSingleEnded ) const
+{
+    boost::optional< Segment > result;
+    
+    if( !segment.is_degenerate() )
+    {
+        //find the floor runs along the bisector either side of the segment
+        Point ptFirst, ptLast;
+        extendWithinFloor( segment, ptFirst, ptLast );
+        
+        const bool bExtendsFirst    = ptFirst != segment.source();
+        const bool bExtendsLast     = ptLast  != segment.target();
+        
+        //insiste on the bisector extending beyond the originating segment
+        if( bKeepSingleEnded ? ( bExtendsFirst || bExtendsLast ) : ( bExtendsFirst && bExtendsLast ) )
+        {
+            result = Segment( ptFirst, ptLast );
+        }
+    }
+    
+    return result;
+}
+
+FloorQuery FloorQuery::isolate() const
+{
+    FloorQuery result;
+    result.m_boundary = m_boundary.isolate();
+    result.m_solidEdges.reserve( m_solidEdges.size() );
+    for( const SolidEdge& edge : m_solidEdges )
+    {
+        result.m_solidEdges.push_back( SolidEdge{ 
+            Blueprint::isolate( edge.ptStart ), Blueprint::isolate( edge.ptEnd ), 
+            edge.x1, edge.y1, edge.x2, edge.y2 } );
+    }
+    return result;
+}
+
+void FloorQuery::cullOccluded( const Point& ptOrigin, const std::vector< Point >& points, 
+        std::vector< bool >& visible ) const
+{
+    //A ray from the origin through the interior of a solid edge crosses from the floor into
+    //another face so every point beyond the edge along the ray is hidden.  Each sector records
+    //the nearest distance beyond which an edge spanning the entire sector hides everything.
+    //The angular and distance margins are far larger than the double precision errors so
+    //points are only ever culled when they are certainly occluded.
+    static const int SECTORS = 128;
+    static const double TWO_PI = 6.283185307179586;
+    static const double SECTOR_ANGLE = TWO_PI / SECTORS;
+    static const double ANGLE_MARGIN = 1e-9;
+    static const double DISTANCE_MARGIN = 1e-9;
+    
+    VERIFY_RTE( points.size() == visible.size() );
+    
+    const double ox = CGAL::to_double( ptOrigin.x() );
+    const double oy = CGAL::to_double( ptOrigin.y() );
+    
+    auto normalise = []( double angle )
+    {
+        return angle < 0.0 ? angle + TWO_PI : angle;
+    };
+    
+    std::vector< double > occlusion( SECTORS, std::numeric_limits< double >::max() );
+    for( const SolidEdge& edge : m_solidEdges )
+    {
+        if( edge.ptStart == ptOrigin || edge.ptEnd == ptOrigin )
+            continue;
+            
+        const double dx1 = edge.x1 - ox, dy1 = edge.y1 - oy;
+        const double dx2 = edge.x2 - ox, dy2 = edge.y2 - oy;
+        const double d1 = std::sqrt( dx1 * dx1 + dy1 * dy1 );
+        const double d2 = std::sqrt( dx2 * dx2 + dy2 * dy2 );
+        
+        //an edge nearly in line with the origin covers no angle
+        const double cross = dx1 * dy2 - dy1 * dx2;
+        if( std::abs( cross ) <= 1e-9 * d1 * d2 )
+            continue;
+        
+        //counter clockwise angular interval of the edge which is always less than pi
+        double start = normalise( std::atan2( dy1, dx1 ) );
+        double end   = normalise( std::atan2( dy2, dx2 ) );
+        if( cross < 0.0 )
+            std::swap( start, end );
+        if( end < start )
+            end += TWO_PI;
+        start += ANGLE_MARGIN;
+        end   -= ANGLE_MARGIN;
+        
+        const double blockDistance = std::max( d1, d2 ) * ( 1.0 + DISTANCE_MARGIN ) + DISTANCE_MARGIN;
+        
+        //sectors entirely within the interval
+        for( int iSector = static_cast< int >( std::ceil( start / SECTOR_ANGLE ) ); 
+            ( iSector + 1 ) * SECTOR_ANGLE <= end; ++iSector )
+        {
+            double& sectorDistance = occlusion[ iSector % SECTORS ];
+            sectorDistance = std::min( sectorDistance, blockDistance );
+        }
+    }
+    
+    for( std::size_t i = 0U; i != points.size(); ++i )
+    {
+        if( visible[ i ] )
+        {
+            const double dx = CGAL::to_double( points[ i ].x() ) - ox;
+            const double dy = CGAL::to_double( points[ i ].y() ) - oy;
+            const int iSector = std::min( SECTORS - 1, 
+                static_cast< int >( normalise( std::atan2( dy, dx ) ) / SECTOR_ANGLE ) );
+            if( std::sqrt( dx * dx + dy * dy ) > occlusion[ iSector ] )
+            {
+                visible[ i ] = false;
+            }
+        }
+    }
+}
+
+}
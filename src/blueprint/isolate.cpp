@@ -0,0 +1,68 @@
+#include "blueprint/isolate.h"
+
+#include <CGAL/Fraction_traits.h>
+
+namespace Blueprint
+{
+
+Kernel::FT isolate( const Kernel::FT& value )
+{
+    //a degenerate interval is the value itself so most coordinates never need the exact one
+    const std::pair< double, double > interval = CGAL::to_interval( value );
+    if( interval.first == interval.second )
+        return Kernel::FT( interval.first );
+    
+#ifdef BLUEPRINT_RATIONAL_KERNEL
+    using ET = Kernel::FT;
+    const ET& exact = value;
+#else
+    using ET = Kernel::FT::ET;
+    const ET& exact = CGAL::exact( value );
+#endif
+    
+    //rebuild the rational from copies of its numerator and denominator
+    using Traits = CGAL::Fraction_traits< ET >;
+    Traits::Numerator_type numerator;
+    Traits::Denominator_type denominator;
+    Traits::Decompose()( exact, numerator, denominator );
+    return Kernel::FT( Traits::Compose()( numerator, denominator ) );
+}
+
+Point isolate( const Point& pt )
+{
+    const std::pair< double, double > x = CGAL::to_interval( pt.x() );
+    const std::pair< double, double > y = CGAL::to_interval( pt.y() );
+    if( x.first == x.second && y.first == y.second )
+        return Point( x.first, y.first );
+    
+    return Point( isolate( pt.x() ), isolate( pt.y() ) );
+}
+
+Segment isolate( const Segment& segment )
+{
+    return Segment( isolate( segment.source() ), isolate( segment.target() ) );
+}
+
+Curve isolate( const Curve& curve )
+{
+    return Curve( isolate( curve.source() ), isolate( curve.target() ) );
+}
+
+Polygon isolate( const Polygon& polygon )
+{
+    Polygon result;
+    for( Polygon::Vertex_const_iterator i = polygon.vertices_begin(); i != polygon.vertices_end(); ++i )
+    {
+        result.push_back( isolate( *i ) );
+    }
+    return result;
+}
+
+Transform isolate( const Transform& transform )
+{
+    return Transform( 
+        isolate( transform.m( 0, 0 ) ), isolate( transform.m( 0, 1 ) ), isolate( transform.m( 0, 2 ) ),
+        isolate( transform.m( 1, 0 ) ), isolate( transform.m( 1, 1 ) ), isolate( transform.m( 1, 2 ) ) );
+}
+
+}
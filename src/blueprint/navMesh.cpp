@@ -0,0 +1,138 @@
+#include "blueprint/navMesh.h"
+#include "blueprint/visibility.h"
+#include "blueprint/binaryIO.h"
+
+#include "common/assert_verify.hpp"
+
+#include <CGAL/Constrained_Delaunay_triangulation_2.h>
+#include <CGAL/Triangulation_vertex_base_with_info_2.h>
+#include <CGAL/Triangulation_face_base_with_info_2.h>
+
+namespace
+{
+    using VertexBase    = CGAL::Triangulation_vertex_base_with_info_2< std::uint32_t, Blueprint::Kernel >;
+    using FaceBase      = CGAL::Triangulation_face_base_with_info_2< std::uint32_t, Blueprint::Kernel,
+                            CGAL::Constrained_triangulation_face_base_2< Blueprint::Kernel > >;
+    using Tds           = CGAL::Triangulation_data_structure_2< VertexBase, FaceBase >;
+    using CDT           = CGAL::Constrained_Delaunay_triangulation_2< Blueprint::Kernel, Tds, CGAL::Exact_predicates_tag >;
+}
+
+namespace Blueprint
+{
+
+NavMesh::NavMesh()
+{
+}
+
+NavMesh::NavMesh( const FloorAnalysis& floor )
+{
+    const Arrangement::Face_const_handle hFloorFace = floor.getFloorFace();
+    
+    CDT cdt;
+    auto insertCcb = [ &cdt ]( Arrangement::Ccb_halfedge_const_circulator iter )
+    {
+        Arrangement::Ccb_halfedge_const_circulator start = iter;
+        do
+        {
+            cdt.insert_constraint( iter->source()->point(), iter->target()->point() );
+            ++iter;
+        }
+        while( iter != start );
+    };
+    insertCcb( hFloorFace->outer_ccb() );
+    for( Arrangement::Hole_const_iterator
+        holeIter = hFloorFace->holes_begin(),
+        holeIterEnd = hFloorFace->holes_end();
+            holeIter != holeIterEnd; ++holeIter )
+    {
+        insertCcb( *holeIter );
+    }
+    
+    //every floor edge is constrained so each triangle is entirely within the floor or 
+    //entirely outside of it and its centroid decides.  Antennas have floor on both sides
+    const FloorQuery& query = floor.getQuery();
+    std::uint32_t uTriangles = 0U;
+    for( CDT::All_faces_iterator i = cdt.all_faces_begin(); i != cdt.all_faces_end(); ++i )
+    {
+        i->info() = NO_TRIANGLE;
+    }
+    for( CDT::Finite_faces_iterator i = cdt.finite_faces_begin(); i != cdt.finite_faces_end(); ++i )
+    {
+        const Point ptCentroid = CGAL::centroid( 
+            i->vertex( 0 )->point(), i->vertex( 1 )->point(), i->vertex( 2 )->point() );
+        if( query.isWithinFloor( ptCentroid ) )
+        {
+            i->info() = uTriangles++;
+        }
+    }
+    
+    for( CDT::Finite_vertices_iterator i = cdt.finite_vertices_begin(); i != cdt.finite_vertices_end(); ++i )
+    {
+        i->info() = NO_TRIANGLE;
+    }
+    
+    m_indices.reserve( uTriangles * 3U );
+    m_adjacency.reserve( uTriangles * 3U );
+    for( CDT::Finite_faces_iterator i = cdt.finite_faces_begin(); i != cdt.finite_faces_end(); ++i )
+    {
+        if( i->info() == NO_TRIANGLE )
+            continue;
+            
+        for( int k = 0; k != 3; ++k )
+        {
+            CDT::Vertex_handle v = i->vertex( k );
+            if( v->info() == NO_TRIANGLE )
+            {
+                v->info() = static_cast< std::uint32_t >( getVertexCount() );
+                m_vertices.push_back( static_cast< float >( CGAL::to_double( v->point().x() ) ) );
+                m_vertices.push_back( static_cast< float >( CGAL::to_double( v->point().y() ) ) );
+            }
+            m_indices.push_back( v->info() );
+            
+            //the edge from vertex k to k + 1 is opposite vertex k + 2
+            m_adjacency.push_back( i->neighbor( ( k + 2 ) % 3 )->info() );
+        }
+    }
+}
+
+void NavMesh::save( std::ostream& os ) const
+{
+    writeUInt32( os, static_cast< std::uint32_t >( getVertexCount() ) );
+    writeUInt32( os, static_cast< std::uint32_t >( getTriangleCount() ) );
+    for( float f : m_vertices )
+        writeFloat( os, f );
+    for( std::uint32_t index : m_indices )
+        writeUInt32( os, index );
+    for( std::uint32_t neighbour : m_adjacency )
+        writeUInt32( os, neighbour );
+}
+
+void NavMesh::load( std::istream& is )
+{
+    const std::uint32_t uVertices   = readUInt32( is );
+    const std::uint32_t uTriangles  = readUInt32( is );
+    //two floats per vertex then three indices and three neighbours per triangle
+    verifyAvailable( is, static_cast< std::uint64_t >( uVertices ) * 2U + 
+        static_cast< std::uint64_t >( uTriangles ) * 6U, 4U );
+    
+    m_vertices.resize( static_cast< std::size_t >( uVertices ) * 2U );
+    for( float& f : m_vertices )
+        f = readFloat( is );
+    
+    m_indices.resize( static_cast< std::size_t >( uTriangles ) * 3U );
+    for( std::uint32_t& index : m_indices )
+    {
+        index = readUInt32( is );
+        VERIFY_RTE_MSG( index < uVertices, "Invalid nav mesh index: " << index );
+    }
+    
+    m_adjacency.resize( static_cast< std::size_t >( uTriangles ) * 3U );
+    for( std::uint32_t& neighbour : m_adjacency )
+    {
+        neighbour = readUInt32( is );
+        VERIFY_RTE_MSG( neighbour < uTriangles || neighbour == NO_TRIANGLE, 
+            "Invalid nav mesh adjacency: " << neighbour );
+    }
+}
+
+}
@@ -53,6 +53,9 @@ std::string Node::generateNewNodeName( Node::Ptr pCopiedNode ) const
 void Node::setModified()
 {
     m_lastModifiedTick.update();
+    m_subtreeModifiedTick = m_lastModifiedTick;
+    for( Ptr pParent = getParent(); pParent; pParent = pParent->getParent() )
+        pParent->m_subtreeModifiedTick = m_lastModifiedTick;
 }
 void Node::init()
 {
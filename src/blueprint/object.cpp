@@ -67,16 +67,13 @@ void Object::init( Float x, Float y )
     Site::init();
     
     setTranslation( m_transform, Map_FloorAverage()( x ), Map_FloorAverage()( y ) );
+    updateDiscreteTransform();
 }
     
 void Object::evaluate( const EvaluationMode& mode, EvaluationResults& results )
 {
     //bottom up recursion
-    for( PtrVector::iterator i = m_sites.begin(),
-        iEnd = m_sites.end(); i!=iEnd; ++i )
-    {
-        (*i)->evaluate( mode, results );
-    }
+    evaluateChildren( mode, results );
         
     const Polygon& polygon = m_pContour->getPolygon();
     if( m_contourPolygon != polygon )
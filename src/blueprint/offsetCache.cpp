@@ -0,0 +1,193 @@
+#include "blueprint/offsetCache.h"
+#include "blueprint/isolate.h"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    std::mutex g_instanceMutex;
+    Blueprint::OffsetCache::Ptr g_pInstance;
+    
+    //the unit bucket of the value offset so that grid coordinates are never on its edges.
+    //The bucket is a function of the exact value so every representation of a number hashes
+    //the same, and the interval decides it without the exact value unless it straddles an edge
+    inline double getBucket( const Blueprint::Kernel::FT& value )
+    {
+        static const double OFFSET = 0.31830988618379067;
+        const std::pair< double, double > interval = CGAL::to_interval( value );
+        const double fBucket = std::floor( interval.first + OFFSET );
+        if( fBucket == std::floor( interval.second + OFFSET ) )
+            return fBucket;
+#ifdef BLUEPRINT_RATIONAL_KERNEL
+        return std::floor( CGAL::to_double( value ) + OFFSET );
+#else
+        return std::floor( CGAL::to_double( CGAL::exact( value ) ) + OFFSET );
+#endif
+    }
+    
+    inline void combine( std::size_t& seed, double value )
+    {
+        seed ^= std::hash< double >()( value ) + 0x9e3779b97f4a7c15ULL + ( seed << 6 ) + ( seed >> 2 );
+    }
+}
+
+namespace Blueprint
+{
+
+OffsetCache::Ptr OffsetCache::getInstance()
+{
+    std::lock_guard< std::mutex > lock( g_instanceMutex );
+    return g_pInstance;
+}
+
+void OffsetCache::setInstance( Ptr pCache )
+{
+    std::lock_guard< std::mutex > lock( g_instanceMutex );
+    g_pInstance = pCache;
+}
+
+void OffsetCache::resetInstance( Ptr pCache )
+{
+    std::lock_guard< std::mutex > lock( g_instanceMutex );
+    if( g_pInstance == pCache )
+        g_pInstance.reset();
+}
+
+OffsetCache::Offsets OffsetCache::calculate( const Polygon& contour, const Kernel::FT& wallWidth )
+{
+    typedef boost::shared_ptr< Polygon > PolygonPtr ;
+    typedef std::vector< PolygonPtr > PolygonPtrVector ;
+    
+    Offsets offsets;
+    
+    //calculate interior
+    {
+        PolygonPtrVector inner_offset_polygons = 
+            CGAL::create_interior_skeleton_and_offset_polygons_2
+                < Kernel::FT, Polygon, Kernel, Kernel >
+                ( wallWidth, contour, ( Kernel() ), ( Kernel() ) );
+        if( !inner_offset_polygons.empty() )
+        {
+            offsets.interior = *inner_offset_polygons.front();
+        }
+    }
+    
+    //calculate exterior
+    {
+        PolygonPtrVector outer_offset_polygons = 
+            CGAL::create_exterior_skeleton_and_offset_polygons_2
+                < Kernel::FT, Polygon, Kernel, Kernel >
+                ( wallWidth, contour, ( Kernel() ), ( Kernel() ) );
+        if( !outer_offset_polygons.empty() )
+        {
+            offsets.exterior = *outer_offset_polygons.back();
+        }
+    }
+    
+    return offsets;
+}
+
+bool OffsetCache::Key::operator==( const Key& cmp ) const
+{
+    return wallWidth == cmp.wallWidth && points == cmp.points;
+}
+
+std::size_t OffsetCache::KeyHash::operator()( const Key& key ) const
+{
+    std::size_t seed = key.points.size();
+    combine( seed, getBucket( key.wallWidth ) );
+    for( const Point& pt : key.points )
+    {
+        combine( seed, getBucket( pt.x() ) );
+        combine( seed, getBucket( pt.y() ) );
+    }
+    return seed;
+}
+
+OffsetCache::Offsets OffsetCache::isolate( const Offsets& offsets )
+{
+    Offsets result;
+    result.interior = Blueprint::isolate( offsets.interior );
+    result.exterior = Blueprint::isolate( offsets.exterior );
+    return result;
+}
+
+OffsetCache::Offsets OffsetCache::get( const Polygon& contour, const Kernel::FT& wallWidth )
+{
+    VERIFY_RTE( !contour.is_empty() );
+    
+    //start from the lowest vertex and translate it to the origin keeping the orientation.
+    //The key is isolated so the stored entry shares nothing with the caller
+    Polygon::Vertex_const_iterator iLowest = std::min_element( contour.vertices_begin(), contour.vertices_end(), 
+        []( const Point& left, const Point& right ){ return CGAL::compare_xy( left, right ) == CGAL::SMALLER; } );
+    const Vector toOrigin = CGAL::ORIGIN - *iLowest;
+    
+    Key key;
+    key.wallWidth = Blueprint::isolate( wallWidth );
+    key.points.reserve( contour.size() );
+    for( Polygon::Vertex_const_iterator i = iLowest; i != contour.vertices_end(); ++i )
+        key.points.push_back( Blueprint::isolate( *i + toOrigin ) );
+    for( Polygon::Vertex_const_iterator i = contour.vertices_begin(); i != iLowest; ++i )
+        key.points.push_back( Blueprint::isolate( *i + toOrigin ) );
+    
+    //the stored entries are only touched under the lock and every caller gets its own
+    //isolated copy so threads never share a lazy number through the cache
+    Offsets offsets;
+    bool bFound = false;
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        OffsetMap::const_iterator iFind = m_offsets.find( key );
+        if( iFind != m_offsets.end() )
+        {
+            offsets = isolate( iFind->second );
+            bFound = true;
+            ++m_szHits;
+        }
+    }
+    
+    //the skeleton is calculated outside of the lock from copies of the key.  A racing 
+    //thread may calculate the same contour but only the first result is kept
+    if( !bFound )
+    {
+        const Offsets calculated = isolate( 
+            calculate( Polygon( key.points.begin(), key.points.end() ), key.wallWidth ) );
+        std::lock_guard< std::mutex > lock( m_mutex );
+        offsets = isolate( m_offsets.insert( std::make_pair( std::move( key ), calculated ) ).first->second );
+        ++m_szMisses;
+    }
+    
+    const Transform translate( CGAL::TRANSLATION, -toOrigin );
+    offsets.interior = CGAL::transform( translate, offsets.interior );
+    offsets.exterior = CGAL::transform( translate, offsets.exterior );
+    return offsets;
+}
+
+std::size_t OffsetCache::size() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_offsets.size();
+}
+
+std::size_t OffsetCache::getHits() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_szHits;
+}
+
+std::size_t OffsetCache::getMisses() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_szMisses;
+}
+
+void OffsetCache::clear()
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_offsets.clear();
+    m_szHits = m_szMisses = 0U;
+}
+
+}
@@ -0,0 +1,299 @@
+#include "blueprint/pathfinder.h"
+#include "blueprint/threadPool.h"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    using Waypoint = Blueprint::Pathfinder::Waypoint;
+    
+    //positive when c is to the left of a to b
+    inline double cross( const Waypoint& a, const Waypoint& b, const Waypoint& c )
+    {
+        return ( static_cast< double >( b.x ) - a.x ) * ( static_cast< double >( c.y ) - a.y ) -
+               ( static_cast< double >( b.y ) - a.y ) * ( static_cast< double >( c.x ) - a.x );
+    }
+    
+    inline float distance( const Waypoint& a, const Waypoint& b )
+    {
+        return std::hypot( b.x - a.x, b.y - a.y );
+    }
+    
+    inline bool equal( const Waypoint& a, const Waypoint& b )
+    {
+        return a.x == b.x && a.y == b.y;
+    }
+    
+    inline void append( Blueprint::Pathfinder::Path& path, const Waypoint& pt )
+    {
+        if( path.empty() || !equal( path.back(), pt ) )
+            path.push_back( pt );
+    }
+}
+
+namespace Blueprint
+{
+
+Pathfinder::Scratch::Scratch( const Pathfinder& pathfinder )
+{
+    const std::size_t szTriangles = pathfinder.m_navMesh.getTriangleCount();
+    m_reached.resize( szTriangles, 0U );
+    m_closed.resize( szTriangles, 0U );
+    m_parent.resize( szTriangles, NavMesh::NO_TRIANGLE );
+    m_cost.resize( szTriangles, 0.0f );
+    m_position.resize( szTriangles, Waypoint{ 0.0f, 0.0f } );
+    
+    //each triangle is pushed at most once per neighbour
+    m_heap.reserve( szTriangles * 3U + 1U );
+    m_corridor.reserve( szTriangles );
+    m_left.reserve( szTriangles + 1U );
+    m_right.reserve( szTriangles + 1U );
+}
+
+Pathfinder::Pathfinder( const NavMesh& navMesh )
+    :   m_navMesh( navMesh )
+{
+    const std::size_t szTriangles = m_navMesh.getTriangleCount();
+    
+    //bounds of each triangle for the grid
+    std::vector< float > bounds( szTriangles * 4U );
+    for( std::uint32_t uTriangle = 0U; uTriangle != szTriangles; ++uTriangle )
+    {
+        float* pBounds = bounds.data() + uTriangle * 4U;
+        pBounds[ 0 ] = pBounds[ 1 ] = std::numeric_limits< float >::max();
+        pBounds[ 2 ] = pBounds[ 3 ] = -std::numeric_limits< float >::max();
+        for( std::uint32_t k = 0U; k != 3U; ++k )
+        {
+            const Waypoint pt = getVertex( m_navMesh.getIndices()[ uTriangle * 3U + k ] );
+            pBounds[ 0 ] = std::min( pBounds[ 0 ], pt.x );
+            pBounds[ 1 ] = std::min( pBounds[ 1 ], pt.y );
+            pBounds[ 2 ] = std::max( pBounds[ 2 ], pt.x );
+            pBounds[ 3 ] = std::max( pBounds[ 3 ], pt.y );
+        }
+    }
+    m_grid = BoundsGrid( bounds );
+}
+
+Pathfinder::Waypoint Pathfinder::getVertex( std::uint32_t uIndex ) const
+{
+    const std::vector< float >& vertices = m_navMesh.getVertices();
+    return Waypoint{ vertices[ uIndex * 2U ], vertices[ uIndex * 2U + 1U ] };
+}
+
+std::uint32_t Pathfinder::findTriangle( const Waypoint& pt ) const
+{
+    const std::uint32_t* pBegin = nullptr;
+    const std::uint32_t* pEnd   = nullptr;
+    m_grid.find( pt.x, pt.y, pBegin, pEnd );
+    const std::vector< std::uint32_t >& indices = m_navMesh.getIndices();
+    for( const std::uint32_t* p = pBegin; p != pEnd; ++p )
+    {
+        const std::uint32_t uTriangle = *p;
+        const Waypoint a = getVertex( indices[ uTriangle * 3U ] );
+        const Waypoint b = getVertex( indices[ uTriangle * 3U + 1U ] );
+        const Waypoint c = getVertex( indices[ uTriangle * 3U + 2U ] );
+        
+        //points on shared edges belong to the first triangle found
+        if( cross( a, b, pt ) >= 0.0 && cross( b, c, pt ) >= 0.0 && cross( c, a, pt ) >= 0.0 )
+            return uTriangle;
+    }
+    return NavMesh::NO_TRIANGLE;
+}
+
+bool Pathfinder::search( std::uint32_t uStart, std::uint32_t uGoal, const Waypoint& start, const Waypoint& goal, 
+        Scratch& scratch ) const
+{
+    //generations avoid clearing the per triangle state between queries
+    if( ++scratch.m_uGeneration == 0U )
+    {
+        std::fill( scratch.m_reached.begin(), scratch.m_reached.end(), 0U );
+        std::fill( scratch.m_closed.begin(), scratch.m_closed.end(), 0U );
+        scratch.m_uGeneration = 1U;
+    }
+    const std::uint32_t uGeneration = scratch.m_uGeneration;
+    
+    auto compare = []( const Scratch::HeapEntry& left, const Scratch::HeapEntry& right )
+    {
+        return left.fEstimate > right.fEstimate;
+    };
+    
+    const std::vector< std::uint32_t >& indices     = m_navMesh.getIndices();
+    const std::vector< std::uint32_t >& adjacency   = m_navMesh.getAdjacency();
+    
+    scratch.m_heap.clear();
+    scratch.m_reached[ uStart ]     = uGeneration;
+    scratch.m_cost[ uStart ]        = 0.0f;
+    scratch.m_position[ uStart ]    = start;
+    scratch.m_parent[ uStart ]      = NavMesh::NO_TRIANGLE;
+    scratch.m_heap.push_back( Scratch::HeapEntry{ distance( start, goal ), uStart } );
+    
+    while( !scratch.m_heap.empty() )
+    {
+        std::pop_heap( scratch.m_heap.begin(), scratch.m_heap.end(), compare );
+        const std::uint32_t uTriangle = scratch.m_heap.back().uTriangle;
+        scratch.m_heap.pop_back();
+        
+        if( scratch.m_closed[ uTriangle ] == uGeneration )
+            continue;
+        scratch.m_closed[ uTriangle ] = uGeneration;
+        
+        if( uTriangle == uGoal )
+            return true;
+        
+        for( std::uint32_t k = 0U; k != 3U; ++k )
+        {
+            const std::uint32_t uNext = adjacency[ uTriangle * 3U + k ];
+            if( uNext == NavMesh::NO_TRIANGLE || scratch.m_closed[ uNext ] == uGeneration )
+                continue;
+                
+            //triangles are entered at the midpoint of the edge crossed
+            const Waypoint a = getVertex( indices[ uTriangle * 3U + k ] );
+            const Waypoint b = getVertex( indices[ uTriangle * 3U + ( k + 1U ) % 3U ] );
+            const Waypoint mid{ ( a.x + b.x ) * 0.5f, ( a.y + b.y ) * 0.5f };
+            const float fCost = scratch.m_cost[ uTriangle ] + distance( scratch.m_position[ uTriangle ], mid );
+            
+            if( scratch.m_reached[ uNext ] != uGeneration || fCost < scratch.m_cost[ uNext ] )
+            {
+                scratch.m_reached[ uNext ]  = uGeneration;
+                scratch.m_cost[ uNext ]     = fCost;
+                scratch.m_position[ uNext ] = mid;
+                scratch.m_parent[ uNext ]   = uTriangle;
+                scratch.m_heap.push_back( Scratch::HeapEntry{ fCost + distance( mid, goal ), uNext } );
+                std::push_heap( scratch.m_heap.begin(), scratch.m_heap.end(), compare );
+            }
+        }
+    }
+    return false;
+}
+
+void Pathfinder::pullString( const Waypoint& start, const Waypoint& goal, Scratch& scratch, Path& path ) const
+{
+    const std::vector< std::uint32_t >& indices     = m_navMesh.getIndices();
+    const std::vector< std::uint32_t >& adjacency   = m_navMesh.getAdjacency();
+    
+    //portals as seen travelling along the corridor.  Leaving a counter clockwise triangle
+    //across edge k the vertex k is on the right and vertex k + 1 on the left
+    scratch.m_left.clear();
+    scratch.m_right.clear();
+    scratch.m_left.push_back( start );
+    scratch.m_right.push_back( start );
+    for( std::size_t sz = 0U; sz + 1U < scratch.m_corridor.size(); ++sz )
+    {
+        const std::uint32_t uTriangle = scratch.m_corridor[ sz ];
+        const std::uint32_t uNext     = scratch.m_corridor[ sz + 1U ];
+        std::uint32_t k = 0U;
+        while( adjacency[ uTriangle * 3U + k ] != uNext )
+        {
+            ++k;
+            VERIFY_RTE( k != 3U );
+        }
+        scratch.m_right.push_back( getVertex( indices[ uTriangle * 3U + k ] ) );
+        scratch.m_left.push_back( getVertex( indices[ uTriangle * 3U + ( k + 1U ) % 3U ] ) );
+    }
+    scratch.m_left.push_back( goal );
+    scratch.m_right.push_back( goal );
+    
+    //simple stupid funnel algorithm
+    path.clear();
+    append( path, start );
+    
+    Waypoint apex = start, left = start, right = start;
+    std::size_t szApex = 0U, szLeft = 0U, szRight = 0U;
+    const std::size_t szPortals = scratch.m_left.size();
+    for( std::size_t sz = 1U; sz < szPortals; ++sz )
+    {
+        const Waypoint& portalLeft  = scratch.m_left[ sz ];
+        const Waypoint& portalRight = scratch.m_right[ sz ];
+        
+        //tighten the right side unless it crosses the left
+        if( cross( apex, right, portalRight ) >= 0.0 )
+        {
+            if( equal( apex, right ) || cross( apex, left, portalRight ) < 0.0 )
+            {
+                right = portalRight;
+                szRight = sz;
+            }
+            else
+            {
+                append( path, left );
+                apex = right = left;
+                szApex = szRight = szLeft;
+                sz = szApex;
+                continue;
+            }
+        }
+        
+        //tighten the left side unless it crosses the right
+        if( cross( apex, left, portalLeft ) <= 0.0 )
+        {
+            if( equal( apex, left ) || cross( apex, right, portalLeft ) > 0.0 )
+            {
+                left = portalLeft;
+                szLeft = sz;
+            }
+            else
+            {
+                append( path, right );
+                apex = left = right;
+                szApex = szLeft = szRight;
+                sz = szApex;
+                continue;
+            }
+        }
+    }
+    append( path, goal );
+}
+
+bool Pathfinder::findPath( const Waypoint& start, const Waypoint& goal, Scratch& scratch, Path& path ) const
+{
+    path.clear();
+    
+    const std::uint32_t uStart  = findTriangle( start );
+    const std::uint32_t uGoal   = findTriangle( goal );
+    if( uStart == NavMesh::NO_TRIANGLE || uGoal == NavMesh::NO_TRIANGLE )
+        return false;
+        
+    if( !search( uStart, uGoal, start, goal, scratch ) )
+        return false;
+    
+    scratch.m_corridor.clear();
+    for( std::uint32_t uTriangle = uGoal; uTriangle != NavMesh::NO_TRIANGLE; 
+        uTriangle = scratch.m_parent[ uTriangle ] )
+    {
+        scratch.m_corridor.push_back( uTriangle );
+    }
+    std::reverse( scratch.m_corridor.begin(), scratch.m_corridor.end() );
+    
+    pullString( start, goal, scratch, path );
+    return true;
+}
+
+void Pathfinder::findPaths( ThreadPool& pool, const std::vector< Query >& queries, std::vector< Path >& paths ) const
+{
+    paths.resize( queries.size() );
+    
+    //contiguous ranges with one scratch each
+    const std::size_t szTasks = std::max< std::size_t >( 1U, std::min( queries.size(), pool.getThreadCount() * 4U ) );
+    const std::size_t szPerTask = ( queries.size() + szTasks - 1U ) / szTasks;
+    
+    ThreadPool::TaskGroup group( pool );
+    for( std::size_t szBegin = 0U; szBegin < queries.size(); szBegin += szPerTask )
+    {
+        const std::size_t szEnd = std::min( queries.size(), szBegin + szPerTask );
+        group.run( [ this, &queries, &paths, szBegin, szEnd ]()
+        {
+            Scratch scratch( *this );
+            for( std::size_t sz = szBegin; sz != szEnd; ++sz )
+            {
+                findPath( queries[ sz ].start, queries[ sz ].goal, scratch, paths[ sz ] );
+            }
+        } );
+    }
+    group.wait();
+}
+
+}
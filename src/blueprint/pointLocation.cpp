@@ -0,0 +1,48 @@
+#include "blueprint/pointLocation.h"
+
+#include "common/assert_verify.hpp"
+
+#include <CGAL/Arr_landmarks_point_location.h>
+#include <CGAL/Arr_trapezoid_ric_point_location.h>
+
+namespace Blueprint
+{
+
+struct PointLocator::Impl
+{
+    using Landmarks = CGAL::Arr_landmarks_point_location< Arrangement >;
+    using Trapezoid = CGAL::Arr_trapezoid_ric_point_location< Arrangement >;
+    
+    std::unique_ptr< Landmarks > pLandmarks;
+    std::unique_ptr< Trapezoid > pTrapezoid;
+};
+
+PointLocator::PointLocator( const Arrangement& arr, PointLocationStrategy strategy )
+    :   m_pImpl( new Impl )
+{
+    switch( strategy )
+    {
+        case ePointLocation_Landmarks:
+            m_pImpl->pLandmarks.reset( new Impl::Landmarks( arr ) );
+            break;
+        case ePointLocation_Trapezoid:
+            m_pImpl->pTrapezoid.reset( new Impl::Trapezoid( arr ) );
+            break;
+        default:
+            THROW_RTE( "Unknown point location strategy: " << strategy );
+    }
+}
+
+PointLocator::~PointLocator()
+{
+}
+
+PointLocator::Result PointLocator::locate( const Point& pt ) const
+{
+    if( m_pImpl->pLandmarks )
+        return m_pImpl->pLandmarks->locate( pt );
+    else
+        return m_pImpl->pTrapezoid->locate( pt );
+}
+
+}
@@ -0,0 +1,227 @@
+#include "blueprint/portalGraph.h"
+#include "blueprint/compilation.h"
+#include "blueprint/binaryIO.h"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <tuple>
+
+namespace Blueprint
+{
+
+PortalGraph::PortalGraph()
+{
+}
+
+PortalGraph::PortalGraph( const Compilation& compilation )
+{
+    const Arrangement& arr = compilation.getArrangement();
+    
+    //number the bounded faces either side of each doorstep in edge order
+    std::map< Arrangement::Face_const_handle, std::uint32_t > nodes;
+    auto getNode = [ this, &nodes ]( Arrangement::Face_const_handle hFace )
+    {
+        auto iFind = nodes.find( hFace );
+        if( iFind != nodes.end() )
+            return iFind->second;
+            
+        Node node{ std::numeric_limits< float >::max(), std::numeric_limits< float >::max(),
+                  -std::numeric_limits< float >::max(), -std::numeric_limits< float >::max() };
+        Arrangement::Ccb_halfedge_const_circulator iter = hFace->outer_ccb();
+        Arrangement::Ccb_halfedge_const_circulator start = iter;
+        do
+        {
+            const float fX = static_cast< float >( CGAL::to_double( iter->target()->point().x() ) );
+            const float fY = static_cast< float >( CGAL::to_double( iter->target()->point().y() ) );
+            node.fMinX = std::min( node.fMinX, fX );
+            node.fMinY = std::min( node.fMinY, fY );
+            node.fMaxX = std::max( node.fMaxX, fX );
+            node.fMaxY = std::max( node.fMaxY, fY );
+            ++iter;
+        }
+        while( iter != start );
+        
+        const std::uint32_t uNode = static_cast< std::uint32_t >( m_nodes.size() );
+        m_nodes.push_back( node );
+        nodes.insert( std::make_pair( hFace, uNode ) );
+        return uNode;
+    };
+    
+    struct DoorstepEdge
+    {
+        std::uint32_t uFirst, uSecond;
+        Arrangement::Vertex_const_handle vSource, vTarget;
+    };
+    std::vector< DoorstepEdge > edges;
+    for( auto i = arr.edges_begin(); i != arr.edges_end(); ++i )
+    {
+        Arrangement::Halfedge_const_handle h = i;
+        if( !h->data().get() )
+            continue;
+        if( h->face() == h->twin()->face() || h->face()->is_unbounded() || h->twin()->face()->is_unbounded() )
+            continue;
+            
+        std::uint32_t uFirst  = getNode( h->face() );
+        std::uint32_t uSecond = getNode( h->twin()->face() );
+        if( uFirst > uSecond )
+        {
+            std::swap( uFirst, uSecond );
+            h = h->twin();
+        }
+        edges.push_back( DoorstepEdge{ uFirst, uSecond, h->source(), h->target() } );
+    }
+    
+    //a doorstep split by other curves becomes several edges between the same faces 
+    //so edges sharing a vertex and faces are joined into one portal
+    std::vector< std::size_t > parent( edges.size() );
+    std::iota( parent.begin(), parent.end(), 0U );
+    auto find = [ &parent ]( std::size_t sz )
+    {
+        while( parent[ sz ] != sz )
+            sz = parent[ sz ] = parent[ parent[ sz ] ];
+        return sz;
+    };
+    {
+        using Key = std::tuple< std::uint32_t, std::uint32_t, Arrangement::Vertex_const_handle >;
+        std::map< Key, std::size_t > seen;
+        for( std::size_t sz = 0U; sz != edges.size(); ++sz )
+        {
+            const DoorstepEdge& edge = edges[ sz ];
+            for( Arrangement::Vertex_const_handle v : { edge.vSource, edge.vTarget } )
+            {
+                auto ib = seen.insert( std::make_pair( Key( edge.uFirst, edge.uSecond, v ), sz ) );
+                if( !ib.second )
+                    parent[ find( sz ) ] = find( ib.first->second );
+            }
+        }
+    }
+    
+    //the portal spans the two furthest apart end points of its edges
+    std::map< std::size_t, std::vector< std::size_t > > groups;
+    for( std::size_t sz = 0U; sz != edges.size(); ++sz )
+        groups[ find( sz ) ].push_back( sz );
+    for( const auto& group : groups )
+    {
+        std::vector< std::pair< double, double > > points;
+        for( std::size_t szEdge : group.second )
+        {
+            for( Arrangement::Vertex_const_handle v : { edges[ szEdge ].vSource, edges[ szEdge ].vTarget } )
+            {
+                points.push_back( std::make_pair( CGAL::to_double( v->point().x() ), CGAL::to_double( v->point().y() ) ) );
+            }
+        }
+        
+        std::size_t szStart = 0U, szEnd = 1U;
+        double dMax = -1.0;
+        for( std::size_t i = 0U; i != points.size(); ++i )
+        {
+            for( std::size_t j = i + 1U; j < points.size(); ++j )
+            {
+                const double dDistance = std::hypot( points[ j ].first - points[ i ].first, points[ j ].second - points[ i ].second );
+                if( dDistance > dMax )
+                {
+                    dMax = dDistance;
+                    szStart = i;
+                    szEnd = j;
+                }
+            }
+        }
+        
+        const DoorstepEdge& edge = edges[ group.first ];
+        const std::pair< double, double >& ptStart  = points[ szStart ];
+        const std::pair< double, double >& ptEnd    = points[ szEnd ];
+        m_portals.push_back( Portal{ edge.uFirst, edge.uSecond,
+            static_cast< float >( ptStart.first ), static_cast< float >( ptStart.second ),
+            static_cast< float >( ptEnd.first ), static_cast< float >( ptEnd.second ),
+            static_cast< float >( ( ptStart.first + ptEnd.first ) / 2.0 ),
+            static_cast< float >( ( ptStart.second + ptEnd.second ) / 2.0 ),
+            static_cast< float >( dMax ) } );
+    }
+    
+    buildNodePortals();
+}
+
+void PortalGraph::buildNodePortals()
+{
+    m_nodePortalStart.assign( m_nodes.size() + 1U, 0U );
+    for( const Portal& portal : m_portals )
+    {
+        ++m_nodePortalStart[ portal.uFirst + 1U ];
+        ++m_nodePortalStart[ portal.uSecond + 1U ];
+    }
+    std::partial_sum( m_nodePortalStart.begin(), m_nodePortalStart.end(), m_nodePortalStart.begin() );
+    
+    m_nodePortals.resize( m_nodePortalStart.back() );
+    std::vector< std::uint32_t > fill( m_nodePortalStart.begin(), m_nodePortalStart.end() - 1 );
+    for( std::uint32_t u = 0U; u != m_portals.size(); ++u )
+    {
+        m_nodePortals[ fill[ m_portals[ u ].uFirst ]++ ]  = u;
+        m_nodePortals[ fill[ m_portals[ u ].uSecond ]++ ] = u;
+    }
+}
+
+void PortalGraph::save( std::ostream& os ) const
+{
+    writeUInt32( os, static_cast< std::uint32_t >( m_nodes.size() ) );
+    for( const Node& node : m_nodes )
+    {
+        writeFloat( os, node.fMinX );
+        writeFloat( os, node.fMinY );
+        writeFloat( os, node.fMaxX );
+        writeFloat( os, node.fMaxY );
+    }
+    writeUInt32( os, static_cast< std::uint32_t >( m_portals.size() ) );
+    for( const Portal& portal : m_portals )
+    {
+        writeUInt32( os, portal.uFirst );
+        writeUInt32( os, portal.uSecond );
+        writeFloat( os, portal.fStartX );
+        writeFloat( os, portal.fStartY );
+        writeFloat( os, portal.fEndX );
+        writeFloat( os, portal.fEndY );
+        writeFloat( os, portal.fMidX );
+        writeFloat( os, portal.fMidY );
+        writeFloat( os, portal.fWidth );
+    }
+}
+
+void PortalGraph::load( std::istream& is )
+{
+    const std::uint32_t uNodes = readUInt32( is );
+    //four floats per node
+    verifyAvailable( is, static_cast< std::uint64_t >( uNodes ) * 4U, 4U );
+    m_nodes.resize( uNodes );
+    for( Node& node : m_nodes )
+    {
+        node.fMinX = readFloat( is );
+        node.fMinY = readFloat( is );
+        node.fMaxX = readFloat( is );
+        node.fMaxY = readFloat( is );
+    }
+    const std::uint32_t uPortals = readUInt32( is );
+    //two indices and seven floats per portal
+    verifyAvailable( is, static_cast< std::uint64_t >( uPortals ) * 9U, 4U );
+    m_portals.resize( uPortals );
+    for( Portal& portal : m_portals )
+    {
+        portal.uFirst   = readUInt32( is );
+        portal.uSecond  = readUInt32( is );
+        VERIFY_RTE_MSG( portal.uFirst < m_nodes.size() && portal.uSecond < m_nodes.size(), 
+            "Invalid portal nodes: " << portal.uFirst << " " << portal.uSecond );
+        portal.fStartX  = readFloat( is );
+        portal.fStartY  = readFloat( is );
+        portal.fEndX    = readFloat( is );
+        portal.fEndY    = readFloat( is );
+        portal.fMidX    = readFloat( is );
+        portal.fMidY    = readFloat( is );
+        portal.fWidth   = readFloat( is );
+    }
+    buildNodePortals();
+}
+
+}
@@ -0,0 +1,360 @@
+#include "blueprint/segmentBVH.h"
+#include "blueprint/isolate.h"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace Blueprint
+{
+
+SegmentBVH::SegmentBVH()
+{
+}
+
+SegmentBVH::SegmentBVH( const std::vector< Segment >& segments )
+{
+    VERIFY_RTE( segments.size() < std::numeric_limits< std::uint32_t >::max() );
+    if( segments.empty() )
+        return;
+
+    std::vector< Bbox > bounds;
+    bounds.reserve( segments.size() );
+    for( const Segment& segment : segments )
+        bounds.push_back( segment.bbox() );
+
+    std::vector< std::uint32_t > order( segments.size() );
+    std::iota( order.begin(), order.end(), 0U );
+    build( order, bounds, 0U, static_cast< std::uint32_t >( order.size() ) );
+
+    //store the segments in leaf order
+    for( std::uint32_t u : order )
+    {
+        const Segment& segment = segments[ u ];
+        m_segments.push_back( segment );
+        m_bounds.push_back( bounds[ u ] );
+        m_sources.push_back( toInterval( segment.source() ) );
+        m_targets.push_back( toInterval( segment.target() ) );
+    }
+}
+
+std::uint32_t SegmentBVH::build( std::vector< std::uint32_t >& order, const std::vector< Bbox >& bounds,
+        std::uint32_t uFirst, std::uint32_t uCount )
+{
+    const std::uint32_t uNode = static_cast< std::uint32_t >( m_nodes.size() );
+
+    Bbox box = bounds[ order[ uFirst ] ];
+    for( std::uint32_t u = uFirst + 1U; u != uFirst + uCount; ++u )
+        box += bounds[ order[ u ] ];
+    m_nodes.push_back( Node{ box, uFirst, uCount } );
+
+    if( uCount > LEAF_SIZE )
+    {
+        //split at the median along the longest axis of the node
+        const int iAxis = ( box.xmax() - box.xmin() ) >= ( box.ymax() - box.ymin() ) ? 0 : 1;
+        auto centre = [ &bounds, iAxis ]( std::uint32_t u )
+        {
+            return bounds[ u ].min( iAxis ) + bounds[ u ].max( iAxis );
+        };
+
+        const std::uint32_t uHalf = uCount / 2U;
+        std::nth_element( order.begin() + uFirst, order.begin() + uFirst + uHalf,
+            order.begin() + uFirst + uCount,
+            [ &centre ]( std::uint32_t left, std::uint32_t right )
+            {
+                return centre( left ) < centre( right );
+            } );
+
+        build( order, bounds, uFirst, uHalf );
+        const std::uint32_t uRight = build( order, bounds, uFirst + uHalf, uCount - uHalf );
+        m_nodes[ uNode ].uIndex = uRight;
+        m_nodes[ uNode ].uCount = 0U;
+    }
+
+    return uNode;
+}
+
+SegmentBVH SegmentBVH::isolate() const
+{
+    //the hierarchy and filters are plain doubles so only the segments are copied deeply
+    SegmentBVH result;
+    result.m_bounds     = m_bounds;
+    result.m_sources    = m_sources;
+    result.m_targets    = m_targets;
+    result.m_nodes      = m_nodes;
+    result.m_segments.reserve( m_segments.size() );
+    for( const Segment& segment : m_segments )
+    {
+        result.m_segments.push_back( Blueprint::isolate( segment ) );
+    }
+    return result;
+}
+
+SegmentBVH::IPoint SegmentBVH::toInterval( const Point& pt )
+{
+    return IPoint{ Interval( CGAL::to_interval( pt.x() ) ), Interval( CGAL::to_interval( pt.y() ) ) };
+}
+
+CGAL::Uncertain< CGAL::Sign > SegmentBVH::orientation( const IPoint& a, const IPoint& b, const IPoint& c )
+{
+    return CGAL::sign( ( b.x - a.x ) * ( c.y - a.y ) - ( b.y - a.y ) * ( c.x - a.x ) );
+}
+
+//certain when the segments are strictly apart or properly cross.  Touching and
+//collinear configurations are left to the exact kernel
+CGAL::Uncertain< bool > SegmentBVH::intersects( const IPoint& a1, const IPoint& a2,
+        const IPoint& b1, const IPoint& b2 )
+{
+    const CGAL::Uncertain< CGAL::Sign > signs[ 4 ] =
+    {
+        orientation( a1, a2, b1 ), orientation( a1, a2, b2 ),
+        orientation( b1, b2, a1 ), orientation( b1, b2, a2 )
+    };
+    for( const CGAL::Uncertain< CGAL::Sign >& sign : signs )
+    {
+        if( !CGAL::is_certain( sign ) || ( CGAL::get_certain( sign ) == CGAL::ZERO ) )
+        {
+            //one strictly separating side is still enough
+            auto apart = []( const CGAL::Uncertain< CGAL::Sign >& s1, const CGAL::Uncertain< CGAL::Sign >& s2 )
+            {
+                return CGAL::is_certain( s1 ) && CGAL::is_certain( s2 ) &&
+                    ( CGAL::get_certain( s1 ) != CGAL::ZERO ) &&
+                    ( CGAL::get_certain( s1 ) == CGAL::get_certain( s2 ) );
+            };
+            if( apart( signs[ 0 ], signs[ 1 ] ) || apart( signs[ 2 ], signs[ 3 ] ) )
+                return false;
+            return CGAL::Uncertain< bool >::indeterminate();
+        }
+    }
+    return ( CGAL::get_certain( signs[ 0 ] ) != CGAL::get_certain( signs[ 1 ] ) ) &&
+           ( CGAL::get_certain( signs[ 2 ] ) != CGAL::get_certain( signs[ 3 ] ) );
+}
+
+bool SegmentBVH::isOnAny( const Point& pt ) const
+{
+    const IPoint ipt = toInterval( pt );
+    bool bFound = false;
+    visitOverlapping( pt.bbox(), [ & ]( std::uint32_t u )
+    {
+        const CGAL::Uncertain< CGAL::Sign > sign = orientation( m_sources[ u ], m_targets[ u ], ipt );
+        if( !CGAL::is_certain( sign ) || ( CGAL::get_certain( sign ) == CGAL::ZERO ) )
+        {
+            bFound = m_segments[ u ].has_on( pt );
+        }
+        return !bFound;
+    } );
+    return bFound;
+}
+
+bool SegmentBVH::doIntersect( const Segment& segment ) const
+{
+    const IPoint source = toInterval( segment.source() );
+    const IPoint target = toInterval( segment.target() );
+    bool bFound = false;
+    visitOverlapping( segment.bbox(), [ & ]( std::uint32_t u )
+    {
+        const CGAL::Uncertain< bool > result = intersects( source, target, m_sources[ u ], m_targets[ u ] );
+        bFound = CGAL::is_certain( result ) ?
+            CGAL::get_certain( result ) : CGAL::do_intersect( segment, m_segments[ u ] );
+        return !bFound;
+    } );
+    return bFound;
+}
+
+void SegmentBVH::getIntersections( const Segment& segment, std::vector< Point >& points ) const
+{
+    const IPoint source = toInterval( segment.source() );
+    const IPoint target = toInterval( segment.target() );
+    visitOverlapping( segment.bbox(), [ & ]( std::uint32_t u )
+    {
+        const CGAL::Uncertain< bool > result = intersects( source, target, m_sources[ u ], m_targets[ u ] );
+        if( !CGAL::is_certain( result ) || CGAL::get_certain( result ) )
+        {
+            if( auto intersection = CGAL::intersection( segment, m_segments[ u ] ) )
+            {
+                if( const Point* pPoint = boost::get< Point >( &*intersection ) )
+                {
+                    points.push_back( *pPoint );
+                }
+                else if( const Segment* pSegment = boost::get< Segment >( &*intersection ) )
+                {
+                    points.push_back( pSegment->source() );
+                    points.push_back( pSegment->target() );
+                }
+            }
+        }
+        return true;
+    } );
+}
+
+std::size_t SegmentBVH::countCrossings( const Point& pt ) const
+{
+    const IPoint ipt = toInterval( pt );
+    const Bbox ptBounds = pt.bbox();
+    const Bbox rayBounds( ptBounds.xmin(), ptBounds.ymin(),
+        std::numeric_limits< double >::max(), ptBounds.ymax() );
+
+    auto isAbove = [ &pt, &ipt ]( const IPoint& ia, const Point& a )
+    {
+        const CGAL::Uncertain< bool > result = ia.y > ipt.y;
+        return CGAL::is_certain( result ) ? CGAL::get_certain( result ) : ( a.y() > pt.y() );
+    };
+
+    std::size_t szCount = 0U;
+    visitOverlapping( rayBounds, [ & ]( std::uint32_t u )
+    {
+        const Segment& segment = m_segments[ u ];
+        const bool bAAbove = isAbove( m_sources[ u ], segment.source() );
+        const bool bBAbove = isAbove( m_targets[ u ], segment.target() );
+        if( bAAbove != bBAbove )
+        {
+            const CGAL::Uncertain< CGAL::Sign > sign = orientation( m_sources[ u ], m_targets[ u ], ipt );
+            const CGAL::Orientation turn = CGAL::is_certain( sign ) ?
+                CGAL::get_certain( sign ) : CGAL::orientation( segment.source(), segment.target(), pt );
+            if( bBAbove ? ( turn == CGAL::LEFT_TURN ) : ( turn == CGAL::RIGHT_TURN ) )
+            {
+                ++szCount;
+            }
+        }
+        return true;
+    } );
+    return szCount;
+}
+
+boost::optional< Point > SegmentBVH::shootRay( const Point& ptOrigin, const Vector& direction ) const
+{
+    boost::optional< Point > result;
+    if( m_nodes.empty() )
+        return result;
+
+    const Ray ray( ptOrigin, direction );
+    const IPoint origin = toInterval( ptOrigin );
+    const Interval idx( CGAL::to_interval( direction.x() ) );
+    const Interval idy( CGAL::to_interval( direction.y() ) );
+
+    const double ox = CGAL::to_double( ptOrigin.x() );
+    const double oy = CGAL::to_double( ptOrigin.y() );
+    const double dx = CGAL::to_double( direction.x() );
+    const double dy = CGAL::to_double( direction.y() );
+    const double dLengthSquared = dx * dx + dy * dy;
+
+    //parameter along the ray where it enters the box or a negative value if it misses.
+    //The box is grown by a margin far larger than the rounding errors so no hit is lost
+    static const double MISS = -1.0;
+    auto enter = [ = ]( const Bbox& box )
+    {
+        const double margin = 1e-9 * ( 1.0 +
+            std::max( std::max( std::abs( box.xmin() ), std::abs( box.xmax() ) ),
+                      std::max( std::abs( box.ymin() ), std::abs( box.ymax() ) ) ) );
+        double tEnter = 0.0, tExit = std::numeric_limits< double >::max();
+        const double origins[ 2 ]    = { ox, oy };
+        const double directions[ 2 ] = { dx, dy };
+        for( int iAxis = 0; iAxis != 2; ++iAxis )
+        {
+            const double lo = box.min( iAxis ) - margin;
+            const double hi = box.max( iAxis ) + margin;
+            if( directions[ iAxis ] == 0.0 )
+            {
+                if( origins[ iAxis ] < lo || origins[ iAxis ] > hi )
+                    return MISS;
+            }
+            else
+            {
+                double t1 = ( lo - origins[ iAxis ] ) / directions[ iAxis ];
+                double t2 = ( hi - origins[ iAxis ] ) / directions[ iAxis ];
+                if( t1 > t2 )
+                    std::swap( t1, t2 );
+                tEnter = std::max( tEnter, t1 );
+                tExit  = std::min( tExit, t2 );
+            }
+        }
+        return tEnter <= tExit ? tEnter : MISS;
+    };
+
+    double tBest = std::numeric_limits< double >::max();
+    auto isBeyondBest = [ &tBest ]( double t )
+    {
+        return t > tBest + 1e-9 * ( 1.0 + tBest );
+    };
+
+    auto consider = [ & ]( const Point& pt )
+    {
+        if( pt != ptOrigin &&
+            ( !result || CGAL::has_smaller_distance_to_point( ptOrigin, pt, result.get() ) ) )
+        {
+            result = pt;
+            tBest = ( ( CGAL::to_double( pt.x() ) - ox ) * dx +
+                      ( CGAL::to_double( pt.y() ) - oy ) * dy ) / dLengthSquared;
+        }
+    };
+
+    auto side = [ & ]( const IPoint& pt )
+    {
+        return CGAL::sign( idx * ( pt.y - origin.y ) - idy * ( pt.x - origin.x ) );
+    };
+
+    std::vector< std::pair< std::uint32_t, double > > stack( 1U, std::make_pair( 0U, 0.0 ) );
+    while( !stack.empty() )
+    {
+        const std::uint32_t uNode = stack.back().first;
+        const double tNode = stack.back().second;
+        stack.pop_back();
+        if( isBeyondBest( tNode ) )
+            continue;
+
+        const Node& node = m_nodes[ uNode ];
+        if( node.uCount )
+        {
+            for( std::uint32_t u = node.uIndex; u != node.uIndex + node.uCount; ++u )
+            {
+                const double t = enter( m_bounds[ u ] );
+                if( t == MISS || isBeyondBest( t ) )
+                    continue;
+
+                //skip segments certainly to one side of the line of the ray
+                const CGAL::Uncertain< CGAL::Sign > sSource = side( m_sources[ u ] );
+                const CGAL::Uncertain< CGAL::Sign > sTarget = side( m_targets[ u ] );
+                if( CGAL::is_certain( sSource ) && CGAL::is_certain( sTarget ) &&
+                    ( CGAL::get_certain( sSource ) != CGAL::ZERO ) &&
+                    ( CGAL::get_certain( sSource ) == CGAL::get_certain( sTarget ) ) )
+                {
+                    continue;
+                }
+
+                if( auto intersection = CGAL::intersection( ray, m_segments[ u ] ) )
+                {
+                    if( const Point* pPoint = boost::get< Point >( &*intersection ) )
+                    {
+                        consider( *pPoint );
+                    }
+                    else if( const Segment* pSegment = boost::get< Segment >( &*intersection ) )
+                    {
+                        consider( pSegment->source() );
+                        consider( pSegment->target() );
+                    }
+                }
+            }
+        }
+        else
+        {
+            //visit the nearer child first
+            const double tLeft  = enter( m_nodes[ uNode + 1U ].box );
+            const double tRight = enter( m_nodes[ node.uIndex ].box );
+            std::pair< std::uint32_t, double > left( uNode + 1U, tLeft ), right( node.uIndex, tRight );
+            if( tLeft > tRight )
+                std::swap( left, right );
+            if( right.second != MISS )
+                stack.push_back( right );
+            if( left.second != MISS )
+                stack.push_back( left );
+        }
+    }
+
+    return result;
+}
+
+}
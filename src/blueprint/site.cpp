@@ -1,11 +1,14 @@
 #include "blueprint/site.h"
 
 #include "blueprint/markup.h"
+#include "blueprint/isolate.h"
+#include "blueprint/threadPool.h"
 
 #include "common/compose.hpp"
 #include "common/assert_verify.hpp"
 
 #include <algorithm>
+#include <iterator>
 
 namespace Blueprint
 {
@@ -13,6 +16,7 @@ namespace Blueprint
 //////////////////////////////////////////////////////////////////////////////
 Site::Site( Site::Ptr pParent, const std::string& strName )
     :   GlyphSpecProducer( pParent, strName ),
+        m_discreteTransform( DiscreteTransform() ),
         m_pSiteParent( pParent )
 {
 
@@ -20,6 +24,7 @@ Site::Site( Site::Ptr pParent, const std::string& strName )
 
 Site::Site( PtrCst pOriginal, Site::Ptr pParent, const std::string& strName )
     :   GlyphSpecProducer( pOriginal, pParent, strName ),
+        m_discreteTransform( pOriginal->m_discreteTransform ),
         m_pSiteParent( pParent )
 {
     m_transform = pOriginal->m_transform;
@@ -47,6 +52,7 @@ void Site::load( Factory& factory, const Ed::Node& node )
     {
         Ed::IShorthandStream is( shOpt.get() );
         is >> m_transform;
+        updateDiscreteTransform();
     }
 }
 
@@ -102,10 +108,98 @@ void Site::init()
 void Site::evaluate( const EvaluationMode& mode, EvaluationResults& results )
 {
     //bottom up recursion
-    for( PtrVector::iterator i = m_sites.begin(),
-        iEnd = m_sites.end(); i!=iEnd; ++i )
+    evaluateChildren( mode, results );
+}
+
+bool Site::isEvaluated( const EvaluationMode& mode ) const
+{
+    return m_evaluatedMode && m_evaluatedMode.get() == mode && 
+        !( m_evaluatedTick < getSubtreeModifiedTick() );
+}
+
+void Site::evaluateChildren( const EvaluationMode& mode, EvaluationResults& results )
+{
+    //evaluation only depends on the site and the sites below it
+    std::vector< Site::Ptr > pending;
+    for( Site::Ptr pSite : m_sites )
+    {
+        if( pSite->isEvaluated( mode ) )
+            results.szSitesSkipped += pSite->m_szEvaluatedSites;
+        else
+            pending.push_back( pSite );
+    }
+    
+    EvaluationMode evaluatedMode = mode;
+    evaluatedMode.pPool = nullptr;
+    auto evaluateSite = [ &mode, &evaluatedMode ]( Site::Ptr pSite, EvaluationResults& siteResults )
+    {
+        pSite->evaluate( mode, siteResults );
+        pSite->m_evaluatedTick = pSite->getSubtreeModifiedTick();
+        pSite->m_evaluatedMode = evaluatedMode;
+        ++siteResults.szSitesEvaluated;
+    };
+    
+    if( mode.pPool && pending.size() > 1U )
+    {
+        //siblings can share lazy exact numbers through pasted geometry so unless the kernel
+        //can evaluate those concurrently each subtree gets its own copies before the fork
+        if( !KERNEL_IS_THREAD_SAFE )
+        {
+            for( Site::Ptr pSite : pending )
+                pSite->isolateGeometry();
+        }
+        
+        //sibling subtrees are independent so fork them and join before the parent
+        //uses their results.  Each task collects into its own results so the errors
+        //merge in the same order as a serial evaluation
+        std::vector< EvaluationResults > taskResults( pending.size() );
+        {
+            ThreadPool::TaskGroup group( *mode.pPool );
+            for( std::size_t sz = 0U; sz != pending.size(); ++sz )
+            {
+                group.run( [ &evaluateSite, &pending, &taskResults, sz ]()
+                {
+                    evaluateSite( pending[ sz ], taskResults[ sz ] );
+                } );
+            }
+            group.wait();
+        }
+        for( EvaluationResults& taskResult : taskResults )
+        {
+            std::move( taskResult.errors.begin(), taskResult.errors.end(), 
+                std::back_inserter( results.errors ) );
+            results.szSitesEvaluated    += taskResult.szSitesEvaluated;
+            results.szSitesSkipped      += taskResult.szSitesSkipped;
+        }
+    }
+    else
+    {
+        for( Site::Ptr pSite : pending )
+        {
+            evaluateSite( pSite, results );
+        }
+    }
+    
+    std::size_t szSites = 1U;
+    for( Site::Ptr pSite : m_sites )
+    {
+        szSites += pSite->m_szEvaluatedSites;
+    }
+    m_szEvaluatedSites = szSites;
+}
+
+void Site::isolateGeometry()
+{
+    m_transform         = isolate( m_transform );
+    m_contourPolygon    = isolate( m_contourPolygon );
+    for( Node::Ptr pNode : getChildren() )
     {
-        (*i)->evaluate( mode, results );
+        if( Feature::Ptr pFeature = boost::dynamic_pointer_cast< Feature >( pNode ) )
+            pFeature->isolateGeometry();
+    }
+    for( Site::Ptr pSite : m_sites )
+    {
+        pSite->isolateGeometry();
     }
 }
     
@@ -132,45 +226,100 @@ void Site::remove( Node::Ptr pNode )
     }
 }
 
-Transform Site::getAbsoluteTransform() const
+Site::AbsoluteTransform Site::getAbsolute() const
 {
-    Transform transform( CGAL::IDENTITY );
-    Site::PtrCst pIter = boost::dynamic_pointer_cast< const Site >( getPtr() );
-    while( pIter )
+    //each level only checks the ticks of its parent so nothing is composed unless changed
+    Site::PtrCst pParent = boost::dynamic_pointer_cast< const Site >( Node::getParent() );
+    boost::optional< AbsoluteTransform > parentAbsolute;
+    if( pParent )
+        parentAbsolute = pParent->getAbsolute();
+    
+    std::lock_guard< std::mutex > lock( m_absoluteMutex );
+    if( m_absoluteTransform && 
+        m_absoluteTransform->pParent == pParent.get() &&
+        !( m_absoluteTransform->siteTick < getLastModifiedTick() ) &&
+        ( !parentAbsolute || !( m_absoluteTransform->parentTick < parentAbsolute->tick ) ) )
+    {
+        return m_absoluteTransform.get();
+    }
+    
+    AbsoluteTransform absolute;
+    absolute.pParent    = pParent.get();
+    absolute.siteTick   = getLastModifiedTick();
+    absolute.tick       = absolute.siteTick;
+    if( parentAbsolute )
     {
-        transform = pIter->getTransform() * transform;
-        pIter = boost::dynamic_pointer_cast< const Site >( pIter->Node::getParent() );
+        absolute.transform  = parentAbsolute->transform * getTransform();
+        absolute.parentTick = parentAbsolute->tick;
+        if( absolute.tick < parentAbsolute->tick )
+            absolute.tick = parentAbsolute->tick;
     }
-    return transform;
+    else
+    {
+        absolute.transform = getTransform();
+    }
+    absolute.transformDouble = TransformDouble( absolute.transform );
+    if( !parentAbsolute )
+        absolute.discrete = m_discreteTransform;
+    else if( parentAbsolute->discrete && m_discreteTransform )
+        absolute.discrete = parentAbsolute->discrete.get() * m_discreteTransform.get();
+    
+    m_absoluteTransform = absolute;
+    return absolute;
+}
+
+Transform Site::getAbsoluteTransform() const
+{
+    return getAbsolute().transform;
+}
+
+TransformDouble Site::getAbsoluteTransformDouble() const
+{
+    return getAbsolute().transformDouble;
+}
+
+boost::optional< DiscreteTransform > Site::getAbsoluteDiscreteTransform() const
+{
+    return getAbsolute().discrete;
+}
+
+void Site::updateDiscreteTransform()
+{
+    m_discreteTransform = DiscreteTransform::fromTransform( getTransform() );
 }
 
 void Site::setTransform( const Transform& transform )
 { 
     m_transform = transform; 
+    updateDiscreteTransform();
     setModified();
 }
 
 void Site::cmd_rotateLeft( const Rect& transformBounds )
 {
     m_transform = rotateLeft( m_transform, transformBounds );
+    updateDiscreteTransform();
     setModified();
 }
 
 void Site::cmd_rotateRight( const Rect& transformBounds )
 {
     m_transform = rotateRight( m_transform, transformBounds );
+    updateDiscreteTransform();
     setModified();
 }
 
 void Site::cmd_flipHorizontally( const Rect& transformBounds )
 {
     m_transform = flipHorizontally( m_transform, transformBounds );
+    updateDiscreteTransform();
     setModified();
 }
 
 void Site::cmd_flipVertically( const Rect& transformBounds )
 {
     m_transform = flipVertically( m_transform, transformBounds );
+    updateDiscreteTransform();
     setModified();
 }
 
@@ -1,6 +1,9 @@
 
 #include "blueprint/space.h"
 #include "blueprint/cgalUtils.h"
+#include "blueprint/clipperUtils.h"
+#include "blueprint/offsetCache.h"
+#include "blueprint/isolate.h"
 
 namespace Blueprint
 {
@@ -69,6 +72,7 @@ void Space::init( float x, float y )
     Site::init();
     
     setTranslation( m_transform, Map_FloorAverage()( x ), Map_FloorAverage()( y ) );
+    updateDiscreteTransform();
 }
 
 void Space::evaluate( const EvaluationMode& mode, EvaluationResults& results )
@@ -88,32 +92,21 @@ void Space::evaluate( const EvaluationMode& mode, EvaluationResults& results )
         {
             if( !m_contourPolygon.is_empty() && m_contourPolygon.is_simple() )
             {
-                typedef boost::shared_ptr< Polygon > PolygonPtr ;
-                typedef std::vector< PolygonPtr > PolygonPtrVector ;
-                
-                //calculate interior
+                //identical contours share one skeleton calculation through the cache
+                OffsetCache::Offsets offsets;
+                if( !mode.bClipper || !Clipper::calculateOffsets( m_contourPolygon, wallWidth, offsets ) )
                 {
-                    PolygonPtrVector inner_offset_polygons = 
-                        CGAL::create_interior_skeleton_and_offset_polygons_2
-                            < Kernel::FT, Polygon, Kernel, Kernel >
-                            ( wallWidth, m_contourPolygon, ( Kernel() ), ( Kernel() ) );
-                    if( !inner_offset_polygons.empty() )
-                    {
-                        m_interiorPolygon = *inner_offset_polygons.front();
-                    }
+                    if( OffsetCache::Ptr pCache = OffsetCache::getInstance() )
+                        offsets = pCache->get( m_contourPolygon, wallWidth );
+                    else
+                        offsets = OffsetCache::calculate( m_contourPolygon, wallWidth );
                 }
-                
-                //calculate exterior
+                    
+                if( !offsets.interior.is_empty() )
                 {
-                    PolygonPtrVector outer_offset_polygons = 
-                        CGAL::create_exterior_skeleton_and_offset_polygons_2
-                            < Kernel::FT, Polygon, Kernel, Kernel >
-                            ( wallWidth, m_contourPolygon, ( Kernel() ), ( Kernel() ) );
-                    if( !outer_offset_polygons.empty() )
-                    {
-                        m_exteriorPolygon = *outer_offset_polygons.back();
-                    }
+                    m_interiorPolygon = offsets.interior;
                 }
+                m_exteriorPolygon = offsets.exterior;
             }
         }
         else
@@ -126,23 +119,35 @@ void Space::evaluate( const EvaluationMode& mode, EvaluationResults& results )
         m_exteriorPolygon.clear();
         m_interiorPolygon = m_contourPolygon;
     }
+    
+    if( mode.bArrangement && !m_contourPolygon.is_empty() && !m_contourPolygon.is_simple() )
+    {
+        results.errors.push_back( "Space contour is not simple: " + Node::getName() );
+    }
 
     //bottom up recursion
+    evaluateChildren( mode, results );
+    
     m_innerExteriors.clear();
-    for( PtrVector::iterator i = m_sites.begin(),
-        iEnd = m_sites.end(); i!=iEnd; ++i )
+    if( mode.bArrangement )
     {
-        (*i)->evaluate( mode, results );
-        
-        if( mode.bArrangement )
+        for( Site::Ptr pSite : m_sites )
         {
-            if( Space::Ptr pSpace = boost::dynamic_pointer_cast< Space >( *i ) )
+            if( Space::Ptr pSpace = boost::dynamic_pointer_cast< Space >( pSite ) )
             {
                 Polygon poly = pSpace->getExteriorPolygon();
                 if( !poly.is_empty() && poly.is_simple() )
                 {
-                    for( auto& p : poly )
-                        p = pSpace->getTransform()( p );
+                    if( const boost::optional< DiscreteTransform >& discrete = pSpace->getDiscreteTransform() )
+                    {
+                        for( auto& p : poly )
+                            p = discrete.get()( p );
+                    }
+                    else
+                    {
+                        for( auto& p : poly )
+                            p = pSpace->getTransform()( p );
+                    }
                     
                     if( !poly.is_counterclockwise_oriented() )
                         poly.reverse_orientation();
@@ -157,39 +162,48 @@ void Space::evaluate( const EvaluationMode& mode, EvaluationResults& results )
     {
         m_exteriorPolyMap.clear();
         
-        //compute the union of ALL inner exterior contours
-        std::vector< Polygon_with_holes > exteriorUnion;
-        CGAL::join( m_innerExteriors.begin(), m_innerExteriors.end(), 
-            std::back_inserter( exteriorUnion ) );
-            
-        int szCounter = 0;
-        for( const Polygon_with_holes& polyWithHole : exteriorUnion )
+        std::vector< Polygon > clippedExteriors;
+        if( !mode.bClipper || !Clipper::clipUnion( m_innerExteriors, m_interiorPolygon, clippedExteriors ) )
         {
-            if( !polyWithHole.is_unbounded() )
+            //compute the union of ALL inner exterior contours
+            std::vector< Polygon_with_holes > exteriorUnion;
+            CGAL::join( m_innerExteriors.begin(), m_innerExteriors.end(), 
+                std::back_inserter( exteriorUnion ) );
+                
+            for( const Polygon_with_holes& polyWithHole : exteriorUnion )
             {
-                const Polygon& outer = polyWithHole.outer_boundary();
-                if( !outer.is_empty() && outer.is_simple() )
+                if( !polyWithHole.is_unbounded() )
                 {
-                    //clip the exterior to the interior
-                    std::vector< Polygon_with_holes > clippedExterior;
-                    CGAL::intersection( outer, m_interiorPolygon,
-                        std::back_inserter( clippedExterior ) );
-                        
-                    //gather the outer boundaries of the results
-                    for( const Polygon_with_holes& clip : clippedExterior )
+                    const Polygon& outer = polyWithHole.outer_boundary();
+                    if( !outer.is_empty() && outer.is_simple() )
                     {
-                        if( !clip.is_unbounded() )
+                        //clip the exterior to the interior
+                        std::vector< Polygon_with_holes > clippedExterior;
+                        CGAL::intersection( outer, m_interiorPolygon,
+                            std::back_inserter( clippedExterior ) );
+                            
+                        //gather the outer boundaries of the results
+                        for( const Polygon_with_holes& clip : clippedExterior )
                         {
-                            const Polygon& clipOuter = clip.outer_boundary();
-                            if( !clipOuter.is_empty() && clipOuter.is_simple() )
+                            if( !clip.is_unbounded() )
                             {
-                                m_exteriorPolyMap.insert( std::make_pair( szCounter++, clipOuter ) );
+                                const Polygon& clipOuter = clip.outer_boundary();
+                                if( !clipOuter.is_empty() && clipOuter.is_simple() )
+                                {
+                                    clippedExteriors.push_back( clipOuter );
+                                }
                             }
                         }
                     }
                 }
             }
         }
+        
+        int szCounter = 0;
+        for( const Polygon& clipOuter : clippedExteriors )
+        {
+            m_exteriorPolyMap.insert( std::make_pair( szCounter++, clipOuter ) );
+        }
     }
     else
     {
@@ -197,4 +211,16 @@ void Space::evaluate( const EvaluationMode& mode, EvaluationResults& results )
     }
 }
 
-}
\ No newline at end of file
+void Space::isolateGeometry()
+{
+    Site::isolateGeometry();
+    
+    m_exteriorPolygon = isolate( m_exteriorPolygon );
+    m_interiorPolygon = isolate( m_interiorPolygon );
+    for( Polygon& polygon : m_innerExteriors )
+        polygon = isolate( polygon );
+    for( auto& exterior : m_exteriorPolyMap )
+        exterior.second = isolate( exterior.second );
+}
+
+}
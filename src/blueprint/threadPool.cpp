@@ -0,0 +1,127 @@
+
+#include "blueprint/threadPool.h"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+
+namespace Blueprint
+{
+
+ThreadPool::ThreadPool( std::size_t szThreads )
+    :   m_szThreads( szThreads ? szThreads : std::max( 1U, std::thread::hardware_concurrency() ) )
+{
+    //the waiting thread always participates so only spawn the additional workers
+    for( std::size_t sz = 1U; sz < m_szThreads; ++sz )
+    {
+        m_threads.emplace_back( [ this ](){ worker(); } );
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_bStop = true;
+    }
+    m_condition.notify_all();
+    for( std::thread& thread : m_threads )
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::worker()
+{
+    while( true )
+    {
+        Task task;
+        {
+            std::unique_lock< std::mutex > lock( m_mutex );
+            m_condition.wait( lock, [ this ](){ return m_bStop || !m_tasks.empty(); } );
+            if( m_tasks.empty() )
+                return;
+            task = std::move( m_tasks.front() );
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+ThreadPool::TaskGroup::TaskGroup( ThreadPool& pool )
+    :   m_pool( pool )
+{
+}
+
+ThreadPool::TaskGroup::~TaskGroup()
+{
+    //tasks reference the group so never leave any running
+    try
+    {
+        wait();
+    }
+    catch( ... )
+    {
+    }
+}
+
+void ThreadPool::TaskGroup::run( Task task )
+{
+    {
+        std::lock_guard< std::mutex > lock( m_pool.m_mutex );
+        ++m_szPending;
+        //the group may be destroyed as soon as the count reaches zero so the
+        //notification only goes through the pool which outlives it
+        m_pool.m_tasks.push_back( [ this, &pool = m_pool, task = std::move( task ) ]()
+        {
+            std::exception_ptr pException;
+            try
+            {
+                task();
+            }
+            catch( ... )
+            {
+                pException = std::current_exception();
+            }
+            
+            {
+                std::lock_guard< std::mutex > lock( pool.m_mutex );
+                if( pException && !m_pException )
+                    m_pException = pException;
+                --m_szPending;
+            }
+            pool.m_condition.notify_all();
+        } );
+    }
+    m_pool.m_condition.notify_one();
+}
+
+void ThreadPool::TaskGroup::wait()
+{
+    std::unique_lock< std::mutex > lock( m_pool.m_mutex );
+    while( m_szPending )
+    {
+        if( !m_pool.m_tasks.empty() )
+        {
+            //help out rather than block - this is what allows nested groups
+            Task task = std::move( m_pool.m_tasks.back() );
+            m_pool.m_tasks.pop_back();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+        else
+        {
+            m_pool.m_condition.wait( lock );
+        }
+    }
+    
+    if( m_pException )
+    {
+        std::exception_ptr pException = m_pException;
+        m_pException = nullptr;
+        std::rethrow_exception( pException );
+    }
+}
+
+}
@@ -105,7 +105,10 @@ void Toolbox::Palette::select( Site::Ptr pSite )
 ///////////////////////////////////////////////////////////////////////
 
 Toolbox::Toolbox( const std::string& strDirectoryPath )
+    :   m_pOffsetCache( new OffsetCache )
 {
+    OffsetCache::setInstance( m_pOffsetCache );
+    
     //recursively load all blueprints under the root directory
     using namespace boost::filesystem;
     VERIFY_RTE_MSG( exists( strDirectoryPath ), "Could not locate toolbox data path at: " << strDirectoryPath );
@@ -130,6 +133,11 @@ Toolbox::Toolbox( const std::string& strDirectoryPath )
     reload();
 }
     
+Toolbox::~Toolbox()
+{
+    OffsetCache::resetInstance( m_pOffsetCache );
+}
+
 Site::Ptr Toolbox::getCurrentItem() const
 {
     Site::Ptr pItem;
@@ -0,0 +1,107 @@
+
+#include "blueprint/vertexIndex.h"
+
+#include "common/assert_verify.hpp"
+
+#include <functional>
+
+namespace
+{
+    //the rounded exact value is the same for every representation of a number.  A
+    //degenerate interval already is that value so quantised coordinates and most
+    //intersections never force the exact evaluation of a lazy number
+    double getCanonical( const Blueprint::Kernel::FT& number )
+    {
+#ifdef BLUEPRINT_RATIONAL_KERNEL
+        return CGAL::to_double( number );
+#else
+        const std::pair< double, double > interval = CGAL::to_interval( number );
+        if( interval.first == interval.second )
+            return interval.first;
+        return CGAL::to_double( CGAL::exact( number ) );
+#endif
+    }
+}
+
+namespace Blueprint
+{
+
+std::size_t VertexIndex::PointHash::operator()( const Point& pt ) const
+{
+    const double x = getCanonical( pt.x() );
+    const double y = getCanonical( pt.y() );
+    const std::size_t hx = std::hash< double >()( x );
+    const std::size_t hy = std::hash< double >()( y );
+    return hx ^ ( hy + 0x9e3779b97f4a7c15ULL + ( hx << 6 ) + ( hx >> 2 ) );
+}
+
+VertexIndex::VertexIndex( Arrangement& arr )
+    :   CGAL::Arr_observer< Arrangement >( arr )
+{
+    rebuild();
+}
+
+boost::optional< Arrangement::Vertex_const_handle > VertexIndex::find( const Point& pt ) const
+{
+    VertexMap::const_iterator iFind = m_vertices.find( pt );
+    if( iFind != m_vertices.end() )
+    {
+        return Arrangement::Vertex_const_handle( iFind->second );
+    }
+    return boost::optional< Arrangement::Vertex_const_handle >();
+}
+
+void VertexIndex::rebuild()
+{
+    m_vertices.clear();
+    if( Arrangement* pArr = arrangement() )
+    {
+        m_vertices.reserve( pArr->number_of_vertices() );
+        for( auto i = pArr->vertices_begin(); i != pArr->vertices_end(); ++i )
+        {
+            m_vertices.insert( std::make_pair( i->point(), i ) );
+        }
+    }
+}
+
+void VertexIndex::after_attach()
+{
+    rebuild();
+}
+
+void VertexIndex::after_assign()
+{
+    rebuild();
+}
+
+void VertexIndex::after_clear()
+{
+    m_vertices.clear();
+}
+
+void VertexIndex::after_global_change()
+{
+    rebuild();
+}
+
+void VertexIndex::after_create_vertex( Arrangement::Vertex_handle v )
+{
+    m_vertices.insert( std::make_pair( v->point(), v ) );
+}
+
+void VertexIndex::before_modify_vertex( Arrangement::Vertex_handle v, const Point& )
+{
+    m_vertices.erase( v->point() );
+}
+
+void VertexIndex::after_modify_vertex( Arrangement::Vertex_handle v )
+{
+    m_vertices.insert( std::make_pair( v->point(), v ) );
+}
+
+void VertexIndex::before_remove_vertex( Arrangement::Vertex_handle v )
+{
+    m_vertices.erase( v->point() );
+}
+
+}
@@ -1,14 +1,26 @@
 
 #include "blueprint/visibility.h"
+#include "blueprint/isolate.h"
 #include "blueprint/svgUtils.h"
 #include "blueprint/object.h"
 #include "blueprint/blueprint.h"
 
 #include "CGAL/Arr_landmarks_point_location.h"
+#include "CGAL/create_offset_polygons_from_polygon_with_holes_2.h"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <cstring>
+#include <cstdint>
 
 namespace
 {
-    void renderFloorFace( Blueprint::Arrangement& arr, Blueprint::Arrangement::Face_const_handle hFace )
+    void renderFloorFace( Blueprint::Compilation::CurveVector& curves, Blueprint::Arrangement::Face_const_handle hFace )
     {
         if( !hFace->is_unbounded() )
         {
@@ -19,7 +31,7 @@ namespace
                 //test if the edge is a doorstep
                 if( !iter->data().get() )
                 {
-                    CGAL::insert( arr, 
+                    curves.push_back( 
                         Blueprint::Curve( iter->source()->point(),
                                               iter->target()->point() ) );
                 }
@@ -41,7 +53,7 @@ namespace
                 //test if the edge is a doorstep
                 if( !iter->data().get() )
                 {
-                    CGAL::insert( arr, 
+                    curves.push_back( 
                         Blueprint::Curve( iter->source()->point(),
                                               iter->target()->point() ) );
                 }
@@ -50,22 +62,49 @@ namespace
             while( iter != start );
         }
     }
-    
-    class ArrObserver : public CGAL::Arr_observer< Blueprint::Arrangement >
+
+    //the ccb as simple loops.  Antennas have the face on both sides and enclose nothing.
+    //A ccb which pinches at a vertex is cut there into one loop per pinch so a floor which
+    //touches itself becomes separate lobes and a hole touching the boundary becomes a clockwise loop
+    void ccbToLoops( Blueprint::Arrangement::Ccb_halfedge_const_circulator iter,
+        std::vector< Blueprint::Polygon >& loops )
     {
-    public:
-        ArrObserver( Blueprint::Arrangement& arr )
-        :     CGAL::Arr_observer< Blueprint::Arrangement >( arr )
+        using VertexHandle = Blueprint::Arrangement::Vertex_const_handle;
+        std::vector< VertexHandle > vertices;
+        std::map< const void*, std::size_t > positions;
+        
+        auto addLoop = [ &vertices, &positions, &loops ]( std::size_t szStart )
         {
-        }
+            Blueprint::Polygon polygon;
+            for( std::size_t sz = szStart; sz != vertices.size(); ++sz )
+            {
+                polygon.push_back( vertices[ sz ]->point() );
+                positions.erase( &*vertices[ sz ] );
+            }
+            vertices.resize( szStart );
+            if( polygon.size() > 2U )
+                loops.push_back( polygon );
+        };
         
-        virtual void after_split_face( 
-            Blueprint::Arrangement::Face_handle f, 
-            Blueprint::Arrangement::Face_handle new_f, bool is_hole )
+        Blueprint::Arrangement::Ccb_halfedge_const_circulator start = iter;
+        do
         {
-            new_f->set_data( f->data() );
+            if( iter->face() != iter->twin()->face() )
+            {
+                VertexHandle v = iter->source();
+                auto iFind = positions.find( &*v );
+                if( iFind != positions.end() )
+                {
+                    addLoop( iFind->second );
+                }
+                positions.insert( std::make_pair( &*v, vertices.size() ) );
+                vertices.push_back( v );
+            }
+            ++iter;
         }
-    };
+        while( iter != start );
+        addLoop( 0U );
+    }
 }
 
 namespace Blueprint
@@ -104,35 +143,69 @@ public:
 };
     */
 FloorAnalysis::FloorAnalysis()
-    :   m_hFloorFace( nullptr )
+    :   m_vertexIndex( m_arr ),
+        m_hFloorFace( nullptr )
 {
 }
     
 FloorAnalysis::FloorAnalysis( Compilation& compilation, boost::shared_ptr< Blueprint > pBlueprint )
-    :   m_hFloorFace( nullptr )
+    :   m_vertexIndex( m_arr ),
+        m_hFloorFace( nullptr )
 {
     Compilation::FaceHandleSet floorFaces;
     Compilation::FaceHandleSet fillerFaces;
     compilation.getFaces( floorFaces, fillerFaces );
     
-    for( Compilation::FaceHandle hFace : floorFaces )
+    //floor faces and object contours are inserted with a single sweep
     {
-        renderFloorFace( m_arr, hFace );
+        Compilation::CurveVector curves;
+        for( Compilation::FaceHandle hFace : floorFaces )
+        {
+            renderFloorFace( curves, hFace );
+        }
+        
+        for( Site::Ptr pNestedSite : pBlueprint->getSites() )
+        {
+            recurseObjects( pNestedSite, curves );
+        }
+        CGAL::insert( m_arr, curves.begin(), curves.end() );
     }
     
-    for( Site::Ptr pNestedSite : pBlueprint->getSites() )
+    findFloorFace();
+    
+    m_hFloorFace->set_data( (DefaultedBool( true )) );
+    
+    m_query = FloorQuery( m_hFloorFace );
+    
+    VERIFY_RTE( m_arr.is_valid() );
+}
+
+FloorAnalysis::FloorAnalysis( const Polygon_with_holes& region )
+    :   m_vertexIndex( m_arr ),
+        m_hFloorFace( nullptr )
+{
     {
-        recurseObjects( pNestedSite );
+        Compilation::CurveVector curves;
+        for( auto i = region.outer_boundary().edges_begin(),
+            iEnd = region.outer_boundary().edges_end(); i != iEnd; ++i )
+        {
+            curves.push_back( Curve( i->source(), i->target() ) );
+        }
+        for( auto h = region.holes_begin(), hEnd = region.holes_end(); h != hEnd; ++h )
+        {
+            for( auto i = h->edges_begin(), iEnd = h->edges_end(); i != iEnd; ++i )
+            {
+                curves.push_back( Curve( i->source(), i->target() ) );
+            }
+        }
+        CGAL::insert( m_arr, curves.begin(), curves.end() );
     }
     
     findFloorFace();
     
     m_hFloorFace->set_data( (DefaultedBool( true )) );
     
-    VERIFY_RTE( m_arr.is_valid() );
-    
-    //calculate the bounding box
-    calculateBounds();
+    m_query = FloorQuery( m_hFloorFace );
 }
     
 void FloorAnalysis::findFloorFace()
@@ -165,27 +238,12 @@ void FloorAnalysis::findFloorFace()
     }
 }
 
-void FloorAnalysis::calculateBounds()
-{
-    std::vector< Segment > outerSegments;
-    Arrangement::Ccb_halfedge_const_circulator iter = m_hFloorFace->outer_ccb();
-    Arrangement::Ccb_halfedge_const_circulator start = iter;
-    do
-    {
-        outerSegments.push_back( iter->curve() );
-        ++iter;
-    }
-    while( iter != start );
-    
-    m_boundingBox = CGAL::bbox_2( outerSegments.begin(), outerSegments.end() );
-}
-
-void FloorAnalysis::recurseObjects( Site::Ptr pSite )
+void FloorAnalysis::recurseObjects( Site::Ptr pSite, Compilation::CurveVector& curves )
 {
     if( Object::Ptr pObject = boost::dynamic_pointer_cast< Object >( pSite ) )
     {
-        Compilation::renderContour( m_arr, pObject->getAbsoluteTransform(), 
-            pObject->getContourPolygon() );
+        Compilation::renderContour( curves, pObject->getAbsoluteTransform(), 
+            pObject->getAbsoluteDiscreteTransform(), pObject->getContourPolygon() );
     }
     //else if( Wall::Ptr pWall = boost::dynamic_pointer_cast< Wall >( pSite ) )
     //{
@@ -194,279 +252,35 @@ void FloorAnalysis::recurseObjects( Site::Ptr pSite )
     
     for( Site::Ptr pNestedSite : pSite->getSites() )
     {
-        recurseObjects( pNestedSite );
+        recurseObjects( pNestedSite, curves );
     }
 }
 
-inline bool isInFloor( Arrangement::Halfedge_const_handle h )
-{
-    const bool bIsFloorEdge = 
-        h->face()->data().get() || 
-        h->twin()->face()->data().get(); 
-    return bIsFloorEdge;
-}
-
 bool FloorAnalysis::isWithinFloor( VertexHandle v1, VertexHandle v2 ) const
 {
-    ArrObserver observer( m_arr );
-    
-    Curve_handle hCurve =
-        CGAL::insert( m_arr, Curve( v1->point(), v2->point() ) );
-        
-    bool bIsOnlyFloorFaces = true;
-    for( auto i = m_arr.induced_edges_begin( hCurve ),
-              iEnd = m_arr.induced_edges_end( hCurve );
-              i != iEnd; ++i )
-    {
-        Arrangement::Halfedge_handle h = *i;
-        if( !isInFloor( h ) )
-        {
-            bIsOnlyFloorFaces = false;
-            break;
-        }
-    }
-    
-    CGAL::remove_curve( m_arr, hCurve );
-    
-    return bIsOnlyFloorFaces;
-}
-
-Segment makeBisector( const Segment& edge, const Rect& rect )
-{
-    const Line line( edge.source(), edge.target() );
-    
-    VERIFY_RTE_MSG( CGAL::do_intersect( rect, line ), 
-        "bisector does not intersect bounds" );
-    
-    boost::optional< boost::variant< Point, Segment > > 
-        result = CGAL::intersection< Kernel >( rect, line );
-    VERIFY_RTE_MSG( result, "Bisector intersection failed" );
-    
-    return boost::get< Segment >( result.get() );
+    return m_query.isWithinFloor( Segment( v1->point(), v2->point() ) );
 }
 
 boost::optional< Curve > FloorAnalysis::getFloorBisector( VertexHandle v1, VertexHandle v2, bool bKeepSingleEnded ) const
 {
-    const Segment segment( v1->point(), v2->point() );
     boost::optional< Curve > result;
-    
-    if( segment.squared_length() > 0.0 )
+    if( boost::optional< Segment > bisector = 
+        m_query.getFloorBisector( Segment( v1->point(), v2->point() ), bKeepSingleEnded ) )
     {
-        const Segment bisector = makeBisector( segment, m_boundingBox );
-    
-        ArrObserver observer( m_arr );
-        
-        Curve_handle hCurveSegment =
-            CGAL::insert( m_arr, Curve( segment.source(), segment.target() ) );
-            
-        Curve_handle hCurve =
-            CGAL::insert( m_arr, Curve( bisector.source(), bisector.target() ) );
-            
-        using HalfEdgeHandle = Arrangement::Halfedge_const_handle;
-        using HalfEdgeHandleSet = std::set< HalfEdgeHandle >;
-        
-        HalfEdgeHandleSet edgesSet;
-        {
-            for( auto i = m_arr.induced_edges_begin( hCurveSegment ),
-                      iEnd = m_arr.induced_edges_end( hCurveSegment );
-                      i != iEnd; ++i )
-            {
-                edgesSet.insert( *i );
-            }
-            for( auto i = m_arr.induced_edges_begin( hCurve ),
-                      iEnd = m_arr.induced_edges_end( hCurve );
-                      i != iEnd; ++i )
-            {
-                edgesSet.insert( *i );
-            }
-        }
-        
-        using HalfEdgeHandleVector = std::vector< HalfEdgeHandle >;
-        HalfEdgeHandleVector orderedEdges( edgesSet.begin(), edgesSet.end() );
-        {
-            std::transform( orderedEdges.begin(), orderedEdges.end(), orderedEdges.begin(),
-                [ bisector]( HalfEdgeHandle edge ) -> HalfEdgeHandle
-                {
-                    if( CGAL::has_smaller_distance_to_point( 
-                        bisector.source(), 
-                        edge->source()->point(), 
-                        edge->target()->point() ) )
-                    {
-                        return edge;
-                    }
-                    else
-                    {
-                        return edge->twin();
-                    }
-                });
-            
-            std::sort( orderedEdges.begin(), orderedEdges.end(), 
-                [ bisector ]( HalfEdgeHandle left, HalfEdgeHandle right )
-                {
-                    return CGAL::has_smaller_distance_to_point( 
-                        bisector.source(), 
-                        left->source()->point(), 
-                        right->source()->point() );
-                } );
-        }
-            
-        //find region within original segment
-        HalfEdgeHandleVector left, inside, right;
-        {
-            int iState = 0;
-            for( HalfEdgeHandleVector::iterator 
-                    i = orderedEdges.begin(),
-                    iEnd = orderedEdges.end(); i!=iEnd; ++i )
-            {
-                HalfEdgeHandle h = *i;
-                VERIFY_RTE( h->source()->point() != h->target()->point() );
-                switch( iState )
-                {
-                    case 0:
-                        if( h->source()->point() == segment.source() )
-                        {
-                            iState = 1;
-                            inside.push_back( h );
-                        }
-                        else
-                        {
-                            left.push_back( h );
-                        }
-                        break;
-                    case 1:
-                        if( h->source()->point() == segment.target() )
-                        {
-                            iState = 2;
-                            right.push_back( h );
-                        }
-                        else
-                        {
-                            inside.push_back( h );
-                        }
-                        break;
-                    case 2:
-                        {
-                            right.push_back( h );
-                        }
-                        break;
-                }
-            }
-        }
-        std::ostringstream os;
-        /*{
-            for( HalfEdgeHandleVector::iterator 
-                    i = orderedEdges.begin(),
-                    iEnd = orderedEdges.end(); i!=iEnd; ++i )
-            {
-                HalfEdgeHandle h = *i;
-                os << "halfedge: " << h->source()->point() << " : " << h->target()->point() << "\n";
-            }
-        }*/
-        VERIFY_RTE_MSG( !left.empty() || ( segment.source() == bisector.source() ), 
-            "Empty left segment: " << segment.source() << " bisector: " << bisector.source() << "\n" << os.str() );
-        VERIFY_RTE_MSG( !inside.empty(), 
-            "Empty inside segment: " << segment << " bisector: " << bisector << "\n" << os.str() );
-        VERIFY_RTE_MSG( !right.empty() || ( segment.target() == bisector.target() ), 
-            "Empty right segment: " << segment.target() << " bisector: " << bisector.target() << "\n" << os.str() );
-        
-        //test the inside is full within the floor
-        bool bInvalid = true;
-        for( HalfEdgeHandleVector::iterator 
-                i = inside.begin(),
-                iEnd = inside.end(); i!=iEnd; ++i )
-        {
-            HalfEdgeHandle h = *i;
-            if( !isInFloor( h ) )
-            {
-                bInvalid = true;
-                break;
-            }
-        }
-        
-        if( bInvalid )
-        {
-            //find the last edges within floor on both sides
-            HalfEdgeHandle hFirst = inside.front(), hLast = inside.back();
-            for( HalfEdgeHandleVector::reverse_iterator 
-                    i = left.rbegin(),
-                    iEnd = left.rend(); i!=iEnd; ++i )
-            {
-                HalfEdgeHandle h = *i;
-                if( isInFloor( h ) )
-                {
-                    hFirst = h;
-                }
-                else
-                {
-                    break;
-                }
-            }
-            
-            for( HalfEdgeHandleVector::iterator 
-                    i = right.begin(),
-                    iEnd = right.end(); i!=iEnd; ++i )
-            {
-                HalfEdgeHandle h = *i;
-                if( isInFloor( h ) )
-                {
-                    hLast = h;
-                }
-                else
-                {
-                    break;
-                }
-            }
-            
-            //insiste on the bisector extending beyond the originating segment
-            if( bKeepSingleEnded )
-            {
-                if( ( hFirst != inside.front() ) || ( hLast != inside.back() ) )
-                {
-                    result = Curve( hFirst->source()->point(), hLast->target()->point() );
-                }
-            }
-            else
-            {
-                if( ( hFirst != inside.front() ) && ( hLast != inside.back() ) )
-                {
-                    result = Curve( hFirst->source()->point(), hLast->target()->point() );
-                }
-            }
-        }
-        
-        CGAL::remove_curve( m_arr, hCurve );
-        CGAL::remove_curve( m_arr, hCurveSegment );
+        result = Curve( bisector->source(), bisector->target() );
     }
-    
-    
     return result;
 }
 
 boost::optional< Curve > FloorAnalysis::getFloorBisector( const Segment& segment, bool bKeepSingleEnded ) const
 {
-    VertexHandle v1, v2;
-    bool bFoundSource = false, bFoundTarget = false;
-    for( auto i = m_arr.vertices_begin(),
-        iEnd = m_arr.vertices_end(); i!=iEnd; ++i )
-    {
-        if( i->point() == segment.source() )
-        {
-            VERIFY_RTE( !bFoundSource );
-            v1 = i;
-            bFoundSource = true;
-        }
-        if( i->point() == segment.target() )
-        {
-            VERIFY_RTE( !bFoundTarget );
-            v2 = i;
-            bFoundTarget = true;
-        }
-    }
-    VERIFY_RTE( bFoundSource );
-    VERIFY_RTE( bFoundTarget );
-    VERIFY_RTE( v1 != v2 );
+    boost::optional< VertexHandle > v1 = m_vertexIndex.find( segment.source() );
+    boost::optional< VertexHandle > v2 = m_vertexIndex.find( segment.target() );
+    VERIFY_RTE( v1 );
+    VERIFY_RTE( v2 );
+    VERIFY_RTE( v1.get() != v2.get() );
     
-    return getFloorBisector( v1, v2, bKeepSingleEnded );
+    return getFloorBisector( v1.get(), v2.get(), bKeepSingleEnded );
 }
     
 void FloorAnalysis::render( const boost::filesystem::path& filepath )
@@ -510,22 +324,20 @@ void FloorAnalysis::render( const boost::filesystem::path& filepath )
     generateHTML( filepath, m_arr, edgeGroups, style );
 }
 
-void FloorAnalysis::save( std::ostream& os ) const
+void FloorAnalysis::save( std::ostream& os, ArrangementFormat format ) const
 {
-    Formatter formatter;
-    CGAL::write( m_arr, os, formatter );
+    writeArrangement( os, m_arr, format );
 }
 
-void FloorAnalysis::load( std::istream& is )
+void FloorAnalysis::load( std::istream& is, ArrangementFormat format )
 {
-    Formatter formatter;
-    CGAL::read( m_arr, is, formatter );
+    readArrangement( is, m_arr, format );
     
     findFloorFace();
     
-    //VERIFY_RTE( m_arr.is_valid() );
+    m_query = FloorQuery( m_hFloorFace );
     
-    calculateBounds();
+    //VERIFY_RTE( m_arr.is_valid() );
 }
 
 
@@ -537,6 +349,17 @@ Visibility::Visibility()
 }
 
 Visibility::Visibility( FloorAnalysis& floor )
+{
+    ThreadPool pool( 1U );
+    construct( floor, pool );
+}
+
+Visibility::Visibility( FloorAnalysis& floor, ThreadPool& pool )
+{
+    construct( floor, pool );
+}
+
+void Visibility::construct( FloorAnalysis& floor, ThreadPool& pool )
 {
     Arrangement::Face_const_handle hFloor = floor.getFloorFace();
     
@@ -607,41 +430,137 @@ Visibility::Visibility( FloorAnalysis& floor )
         CGAL::insert( m_arr, segment );
     }
     
-    for( const Curve& segment : segments )
+    //the floor queries are read only so the segments and pairs are evaluated on the pool
+    //with one task per thread.  Unless the kernel is thread safe each task works on its own
+    //deep copy of the query and the points, made here before any task starts.  The results
+    //are kept per segment and per row and merged in order so the insertion order, and
+    //therefore the arrangement, is identical for any number of threads
+    struct TaskInput
+    {
+        FloorQuery query;
+        std::vector< Segment > segments;
+        std::vector< Point > points;
+    };
+    const bool bIsolate = !KERNEL_IS_THREAD_SAFE && ( pool.getThreadCount() > 1U );
+    std::vector< TaskInput > inputs( pool.getThreadCount() );
+    for( TaskInput& input : inputs )
     {
-        if( boost::optional< Curve > bisectorOpt = 
-            floor.getFloorBisector( segment, true ) )
+        input.query = bIsolate ? floor.getQuery().isolate() : floor.getQuery();
+        for( const Curve& segment : segments )
         {
-            CGAL::insert( m_arr, bisectorOpt.get() );
+            const Segment s( segment.source(), segment.target() );
+            input.segments.push_back( bIsolate ? isolate( s ) : s );
+        }
+        for( Arrangement::Vertex_const_handle v : interiorPoints )
+        {
+            input.points.push_back( bIsolate ? isolate( v->point() ) : v->point() );
         }
     }
+    const std::size_t szTasks = inputs.size();
     
-    //determine the set of interior vertices VertexVector
-    auto    i       = interiorPoints.begin(),
-            iEnd    = interiorPoints.end() - 1U,
-            j       = interiorPoints.begin(),
-            jEnd    = interiorPoints.end();
-        
-    for( ; i != iEnd; ++i )
     {
-        for( j = i + 1U; j != jEnd; ++j )
+        std::vector< boost::optional< Segment > > segmentBisectors( segments.size() );
         {
-            Arrangement::Vertex_const_handle v1 = *i;
-            Arrangement::Vertex_const_handle v2 = *j;
-            if( v1 != v2 )
+            ThreadPool::TaskGroup group( pool );
+            for( std::size_t szTask = 0U; szTask != szTasks; ++szTask )
             {
-                if( floor.isWithinFloor( v1, v2 ) )
+                group.run( [ &inputs, &segmentBisectors, szTasks, szTask ]()
                 {
-                    if( boost::optional< Curve > bisectorOpt = 
-                        floor.getFloorBisector( v1, v2, false ) )
+                    const TaskInput& input = inputs[ szTask ];
+                    for( std::size_t sz = szTask; sz < input.segments.size(); sz += szTasks )
                     {
-                        CGAL::insert( m_arr, bisectorOpt.get() );
+                        segmentBisectors[ sz ] = input.query.getFloorBisector( input.segments[ sz ], true );
                     }
-                } 
+                } );
             }
-            
+            group.wait();
+        }
+        
+        std::vector< Curve > bisectors;
+        for( const boost::optional< Segment >& bisectorOpt : segmentBisectors )
+        {
+            if( bisectorOpt )
+                bisectors.push_back( Curve( bisectorOpt->source(), bisectorOpt->target() ) );
+        }
+        CGAL::insert( m_arr, bisectors.begin(), bisectors.end() );
+    }
+    
+    //cull the pairs of interior vertices which certainly cannot see each other using
+    //the visibility of each vertex.  The remaining pairs are tested exactly
+    const std::size_t szInterior = interiorPoints.size();
+    std::vector< std::vector< bool > > visibility( szInterior );
+    {
+        ThreadPool::TaskGroup group( pool );
+        for( std::size_t szTask = 0U; szTask != szTasks; ++szTask )
+        {
+            group.run( [ &inputs, &visibility, szInterior, szTasks, szTask ]()
+            {
+                const TaskInput& input = inputs[ szTask ];
+                for( std::size_t i = szTask; i < szInterior; i += szTasks )
+                {
+                    visibility[ i ].resize( szInterior, true );
+                    input.query.cullOccluded( input.points[ i ], input.points, visibility[ i ] );
+                }
+            } );
         }
+        group.wait();
     }
+    
+    //the rows of the pair triangle are dealt out to the tasks in turn to balance them
+    std::vector< std::vector< Segment > > rowBisectors( szInterior );
+    std::vector< Statistics > rowStatistics( szInterior );
+    {
+        ThreadPool::TaskGroup group( pool );
+        for( std::size_t szTask = 0U; szTask != szTasks; ++szTask )
+        {
+            group.run( [ &inputs, &visibility, &rowBisectors, &rowStatistics, szInterior, szTasks, szTask ]()
+            {
+                const TaskInput& input = inputs[ szTask ];
+                for( std::size_t i = szTask; i < szInterior; i += szTasks )
+                {
+                    Statistics& statistics = rowStatistics[ i ];
+                    for( std::size_t j = i + 1U; j < szInterior; ++j )
+                    {
+                        //a vertex pinching the floor boundary is visited twice
+                        const Segment segment( input.points[ i ], input.points[ j ] );
+                        if( segment.is_degenerate() )
+                            continue;
+                        ++statistics.szReflexPairs;
+                        if( !visibility[ i ][ j ] || !visibility[ j ][ i ] )
+                        {
+                            ++statistics.szCulled;
+                        }
+                        else if( input.query.isWithinFloor( segment ) )
+                        {
+                            ++statistics.szVisible;
+                            if( boost::optional< Segment > bisectorOpt = 
+                                input.query.getFloorBisector( segment, false ) )
+                            {
+                                rowBisectors[ i ].push_back( bisectorOpt.get() );
+                            }
+                        }
+                    }
+                }
+            } );
+        }
+        group.wait();
+    }
+    
+    m_statistics = Statistics();
+    for( const Statistics& row : rowStatistics )
+    {
+        m_statistics.szReflexPairs  += row.szReflexPairs;
+        m_statistics.szCulled       += row.szCulled;
+        m_statistics.szVisible      += row.szVisible;
+    }
+    
+    std::vector< Curve > bisectors;
+    for( const std::vector< Segment >& row : rowBisectors )
+    {
+        for( const Segment& bisector : row )
+            bisectors.push_back( Curve( bisector.source(), bisector.target() ) );
+    }
+    CGAL::insert( m_arr, bisectors.begin(), bisectors.end() );
 }
 
 void Visibility::render( const boost::filesystem::path& filepath )
@@ -660,16 +579,105 @@ void Visibility::render( const boost::filesystem::path& filepath )
     generateHTML( filepath, m_arr, edgeGroups, style );
 }
 
-void Visibility::save( std::ostream& os ) const
+void Visibility::save( std::ostream& os, ArrangementFormat format ) const
 {
-    Formatter formatter;
-    CGAL::write( m_arr, os, formatter );
+    writeArrangement( os, m_arr, format );
 }
 
-void Visibility::load( std::istream& is )
+void Visibility::load( std::istream& is, ArrangementFormat format )
 {
-    Formatter formatter;
-    CGAL::read( m_arr, is, formatter );
+    readArrangement( is, m_arr, format );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+AgentFloor::AgentFloor( const FloorAnalysis& floor, float fRadius )
+    :   m_fRadius( fRadius )
+{
+    ThreadPool pool( 1U );
+    construct( floor, pool );
+}
+
+AgentFloor::AgentFloor( const FloorAnalysis& floor, float fRadius, ThreadPool& pool )
+    :   m_fRadius( fRadius )
+{
+    construct( floor, pool );
+}
+
+void AgentFloor::construct( const FloorAnalysis& floor, ThreadPool& pool )
+{
+    VERIFY_RTE_MSG( m_fRadius > 0.0f, "Invalid agent radius: " << m_fRadius );
+    
+    Arrangement::Face_const_handle hFloor = floor.getFloorFace();
+    
+    //counter clockwise loops of the outer ccb are lobes of the floor and clockwise ones holes
+    std::vector< Polygon > loops, holes;
+    ccbToLoops( hFloor->outer_ccb(), loops );
+    std::vector< Polygon_with_holes > floorPolygons;
+    for( const Polygon& loop : loops )
+    {
+        VERIFY_RTE_MSG( loop.is_simple(), "Floor boundary is not simple" );
+        if( loop.orientation() == CGAL::COUNTERCLOCKWISE )
+            floorPolygons.push_back( Polygon_with_holes( loop ) );
+        else
+            holes.push_back( loop );
+    }
+    for( Arrangement::Hole_const_iterator
+        holeIter = hFloor->holes_begin(),
+        holeIterEnd = hFloor->holes_end();
+            holeIter != holeIterEnd; ++holeIter )
+    {
+        loops.clear();
+        ccbToLoops( *holeIter, loops );
+        for( const Polygon& loop : loops )
+        {
+            VERIFY_RTE_MSG( loop.is_simple(), "Floor hole is not simple" );
+            VERIFY_RTE_MSG( loop.orientation() == CGAL::CLOCKWISE, "Floor hole encloses floor" );
+            holes.push_back( loop );
+        }
+    }
+    
+    //each hole lies within exactly one lobe and no hole edge lies on a lobe boundary
+    for( const Polygon& hole : holes )
+    {
+        const Point ptMid = CGAL::midpoint( hole[ 0 ], hole[ 1 ] );
+        auto iFind = std::find_if( floorPolygons.begin(), floorPolygons.end(),
+            [ &ptMid ]( const Polygon_with_holes& lobe )
+            {
+                return lobe.outer_boundary().bounded_side( ptMid ) == CGAL::ON_BOUNDED_SIDE;
+            } );
+        VERIFY_RTE_MSG( iFind != floorPolygons.end(), "Floor hole outside floor boundary" );
+        iFind->add_hole( hole );
+    }
+    
+    //the interior skeleton shrinks the boundary and grows the holes together
+    std::vector< Polygon_with_holes > offsetRegions;
+    for( const Polygon_with_holes& floorPolygon : floorPolygons )
+    {
+        const auto lobeRegions = 
+            CGAL::create_interior_skeleton_and_offset_polygons_with_holes_2
+                ( Kernel::FT( m_fRadius ), floorPolygon, Kernel() );
+        for( const auto& pRegion : lobeRegions )
+            offsetRegions.push_back( *pRegion );
+    }
+    
+    for( const Polygon_with_holes& offsetRegion : offsetRegions )
+    {
+        Region region;
+        region.pFloor.reset( new FloorAnalysis( offsetRegion ) );
+        region.pVisibility.reset( new Visibility( *region.pFloor, pool ) );
+        m_regions.emplace_back( std::move( region ) );
+    }
+}
+
+boost::optional< std::size_t > AgentFloor::findRegion( const Point& pt ) const
+{
+    for( std::size_t sz = 0U; sz != m_regions.size(); ++sz )
+    {
+        if( m_regions[ sz ].pFloor->getQuery().isWithinFloor( pt ) )
+            return sz;
+    }
+    return boost::optional< std::size_t >();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -686,33 +694,432 @@ Analysis::Analysis( boost::shared_ptr< Blueprint > pBlueprint )
     
 }
 
+Analysis::Analysis( IncrementalCompiler& compiler, boost::shared_ptr< Blueprint > pBlueprint )
+    :   m_compilation( compiler, pBlueprint ),
+        m_floor( m_compilation, pBlueprint ),
+        m_visibility( m_floor )
+{
+    
+}
+
+Analysis::Analysis( ThreadPool& pool, boost::shared_ptr< Blueprint > pBlueprint )
+    :   m_compilation( pBlueprint ),
+        m_floor( m_compilation, pBlueprint ),
+        m_visibility( m_floor, pool )
+{
+    
+}
+
 Analysis::Ptr Analysis::constructFromBlueprint( boost::shared_ptr< Blueprint > pBlueprint )
 {
     Analysis::Ptr pAnalysis( new Analysis( pBlueprint ) );
     return pAnalysis;
 }
 
+Analysis::Ptr Analysis::constructFromBlueprint( IncrementalCompiler& compiler, boost::shared_ptr< Blueprint > pBlueprint )
+{
+    Analysis::Ptr pAnalysis( new Analysis( compiler, pBlueprint ) );
+    return pAnalysis;
+}
+
+Analysis::Ptr Analysis::constructFromBlueprint( ThreadPool& pool, boost::shared_ptr< Blueprint > pBlueprint )
+{
+    Analysis::Ptr pAnalysis( new Analysis( pool, pBlueprint ) );
+    return pAnalysis;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//The analysis file is a header followed by a table of sections so each part can
+//be loaded independently.  Version one files hold the three parts sequentially.
+//  char[4]     magic
+//  uint8       version
+//  uint8       ArrangementFormat
+//  uint32      section count
+//  { uint32 type, uint64 offset, uint64 size } per section, offsets from file start
+//Unknown section types are skipped.  The nav mesh and portal sections are optional
+//and are derived from the other parts when missing
+namespace
+{
+    const char ANALYSIS_MAGIC[] = { 'B', 'L', 'U', 'C' };
+    const char ANALYSIS_VERSION_SEQUENTIAL = 1;
+    const char ANALYSIS_VERSION = 2;
+    
+    const std::size_t ANALYSIS_HEADER_SIZE          = sizeof( ANALYSIS_MAGIC ) + 1U + 1U + 4U;
+    const std::size_t ANALYSIS_SECTION_ENTRY_SIZE   = 4U + 8U + 8U;
+    
+    template< typename T >
+    void writeUInt( std::ostream& os, T value )
+    {
+        char buffer[ sizeof( T ) ];
+        for( std::size_t sz = 0U; sz != sizeof( T ); ++sz )
+            buffer[ sz ] = static_cast< char >( ( value >> ( 8U * sz ) ) & 0xFF );
+        os.write( buffer, sizeof( T ) );
+    }
+    
+    template< typename T >
+    T readUInt( const char* pData )
+    {
+        T value = 0U;
+        for( std::size_t sz = 0U; sz != sizeof( T ); ++sz )
+            value |= static_cast< T >( static_cast< unsigned char >( pData[ sz ] ) ) << ( 8U * sz );
+        return value;
+    }
+    
+    struct AnalysisHeader
+    {
+        int iVersion = 0;
+        Blueprint::ArrangementFormat format = Blueprint::eArrFormat_Text;
+        struct Entry
+        {
+            std::uint32_t type;
+            std::uint64_t offset, size;
+        };
+        std::vector< Entry > sections;
+    };
+    
+    //returns false if there is no header i.e. the original headerless text format
+    bool readAnalysisHeader( std::istream& is, AnalysisHeader& header )
+    {
+        char buffer[ ANALYSIS_HEADER_SIZE ];
+        if( !is.read( buffer, sizeof( ANALYSIS_MAGIC ) ) || 
+            !std::equal( buffer, buffer + sizeof( ANALYSIS_MAGIC ), ANALYSIS_MAGIC ) )
+        {
+            return false;
+        }
+        
+        header.iVersion = is.get();
+        VERIFY_RTE_MSG( header.iVersion == ANALYSIS_VERSION_SEQUENTIAL || header.iVersion == ANALYSIS_VERSION, 
+            "Unsupported analysis version: " << header.iVersion );
+            
+        const int iFormat = is.get();
+        VERIFY_RTE_MSG( iFormat == Blueprint::eArrFormat_Text || iFormat == Blueprint::eArrFormat_Binary, 
+            "Unsupported analysis format: " << iFormat );
+        header.format = static_cast< Blueprint::ArrangementFormat >( iFormat );
+        
+        if( header.iVersion == ANALYSIS_VERSION )
+        {
+            VERIFY_RTE_MSG( is.read( buffer, 4U ), "Truncated analysis header" );
+            const std::uint32_t uiSections = readUInt< std::uint32_t >( buffer );
+            for( std::uint32_t ui = 0U; ui != uiSections; ++ui )
+            {
+                char entry[ ANALYSIS_SECTION_ENTRY_SIZE ];
+                VERIFY_RTE_MSG( is.read( entry, ANALYSIS_SECTION_ENTRY_SIZE ), "Truncated analysis header" );
+                header.sections.push_back( AnalysisHeader::Entry{ 
+                    readUInt< std::uint32_t >( entry ), 
+                    readUInt< std::uint64_t >( entry + 4U ), 
+                    readUInt< std::uint64_t >( entry + 12U ) } );
+            }
+        }
+        return true;
+    }
+}
+
 Analysis::Ptr Analysis::constructFromStream( std::istream& is )
 {
     Analysis::Ptr pAnalysis( new Analysis );
     
-    pAnalysis->m_compilation.load( is );
-    pAnalysis->m_floor.load( is );
-    pAnalysis->m_visibility.load( is );
+    const std::istream::pos_type start = is.tellg();
+    AnalysisHeader header;
+    if( !readAnalysisHeader( is, header ) )
+    {
+        is.clear();
+        is.seekg( start );
+    }
+    pAnalysis->m_format = header.format;
+    
+    if( header.iVersion == ANALYSIS_VERSION )
+    {
+        bool bFound[ TOTAL_SECTIONS ] = { false, false, false, false, false, false, false };
+        for( const AnalysisHeader::Entry& entry : header.sections )
+        {
+            if( entry.type < TOTAL_SECTIONS )
+            {
+                is.seekg( start + static_cast< std::streamoff >( entry.offset ) );
+                switch( entry.type )
+                {
+                    case eSection_Compilation:  pAnalysis->m_compilation.load( is, header.format );   break;
+                    case eSection_Floor:        pAnalysis->m_floor.load( is, header.format );         break;
+                    case eSection_Visibility:   pAnalysis->m_visibility.load( is, header.format );    break;
+                    case eSection_NavMesh:
+                        std::call_once( pAnalysis->m_sections[ eSection_NavMesh ].loaded, 
+                            [ &pAnalysis, &is ](){ pAnalysis->m_navMesh.load( is ); } );
+                        break;
+                    case eSection_Portals:
+                        std::call_once( pAnalysis->m_sections[ eSection_Portals ].loaded, 
+                            [ &pAnalysis, &is ](){ pAnalysis->m_portalGraph.load( is ); } );
+                        break;
+                    case eSection_Clearance:
+                        std::call_once( pAnalysis->m_sections[ eSection_Clearance ].loaded, 
+                            [ &pAnalysis, &is ](){ pAnalysis->m_clearance.load( is ); } );
+                        pAnalysis->m_fClearanceResolution = pAnalysis->m_clearance.getResolution();
+                        break;
+                    case eSection_Cells:
+                        std::call_once( pAnalysis->m_sections[ eSection_Cells ].loaded, 
+                            [ &pAnalysis, &is ](){ pAnalysis->m_cellComplex.load( is ); } );
+                        pAnalysis->m_bCellComplex = true;
+                        break;
+                }
+                bFound[ entry.type ] = true;
+            }
+        }
+        VERIFY_RTE_MSG( bFound[ eSection_Compilation ] && bFound[ eSection_Floor ] && bFound[ eSection_Visibility ],
+            "Analysis is missing sections" );
+    }
+    else
+    {
+        pAnalysis->m_compilation.load( is, header.format );
+        pAnalysis->m_floor.load( is, header.format );
+        pAnalysis->m_visibility.load( is, header.format );
+    }
+    
+    return pAnalysis;
+}
+
+Analysis::Ptr Analysis::constructFromFile( const boost::filesystem::path& filePath )
+{
+    std::shared_ptr< boost::iostreams::mapped_file_source > pMappedFile = 
+        std::make_shared< boost::iostreams::mapped_file_source >( filePath.string() );
+    VERIFY_RTE_MSG( pMappedFile->is_open(), "Failed to map analysis file: " << filePath.string() );
+    
+    const char* pData = pMappedFile->data();
+    const std::size_t szFileSize = pMappedFile->size();
+    
+    AnalysisHeader header;
+    {
+        boost::iostreams::stream< boost::iostreams::array_source > is( pData, szFileSize );
+        if( !readAnalysisHeader( is, header ) || header.iVersion != ANALYSIS_VERSION )
+        {
+            //older files are read in full
+            boost::iostreams::stream< boost::iostreams::array_source > isAll( pData, szFileSize );
+            return constructFromStream( isAll );
+        }
+    }
+    
+    Analysis::Ptr pAnalysis( new Analysis );
+    pAnalysis->m_pMappedFile = pMappedFile;
+    pAnalysis->m_format = header.format;
+    for( const AnalysisHeader::Entry& entry : header.sections )
+    {
+        if( entry.type < TOTAL_SECTIONS )
+        {
+            VERIFY_RTE_MSG( entry.offset <= szFileSize && entry.size <= szFileSize - entry.offset, 
+                "Invalid analysis section in: " << filePath.string() );
+            Section& section = pAnalysis->m_sections[ entry.type ];
+            section.bPresent    = true;
+            section.pData       = pData + entry.offset;
+            section.szSize      = static_cast< std::size_t >( entry.size );
+        }
+    }
+    //the nav mesh, portal, clearance and cell sections are optional
+    for( SectionType sectionType : { eSection_Compilation, eSection_Floor, eSection_Visibility } )
+    {
+        VERIFY_RTE_MSG( pAnalysis->m_sections[ sectionType ].bPresent, 
+            "Analysis is missing sections: " << filePath.string() );
+    }
     
     return pAnalysis;
 }
 
-void Analysis::save( std::ostream& os ) const
+template< typename Loader >
+void Analysis::loadSection( Section& section, Loader&& loader ) const
+{
+    //hold the mapping for the read as another section may release it meanwhile
+    std::shared_ptr< boost::iostreams::mapped_file_source > pMapping;
+    const char* pData = nullptr;
+    {
+        std::lock_guard< std::mutex > lock( m_mappingMutex );
+        pMapping    = m_pMappedFile;
+        pData       = section.pData;
+    }
+    {
+        boost::iostreams::stream< boost::iostreams::array_source > is( pData, section.szSize );
+        loader( is );
+    }
+    pMapping.reset();
+    
+    std::lock_guard< std::mutex > lock( m_mappingMutex );
+    section.pData = nullptr;
+    std::string().swap( section.buffer );
+    
+    //the file stays mapped until the required parts are loaded.  The optional sections
+    //left are copied out so the file can be overwritten while the analysis is in use
+    if( m_pMappedFile && 
+        !m_sections[ eSection_Compilation ].pData && 
+        !m_sections[ eSection_Floor ].pData && 
+        !m_sections[ eSection_Visibility ].pData )
+    {
+        for( Section& remaining : m_sections )
+        {
+            if( remaining.pData )
+            {
+                remaining.buffer.assign( remaining.pData, remaining.szSize );
+                remaining.pData = remaining.buffer.data();
+            }
+        }
+        m_pMappedFile.reset();
+    }
+}
+
+template< typename T >
+void Analysis::materialise( SectionType sectionType, T& part ) const
 {
-    m_compilation.save( os );
-    m_floor.save( os );
-    m_visibility.save( os );
+    Section& section = m_sections[ sectionType ];
+    if( section.bPresent )
+    {
+        std::call_once( section.loaded, [ this, &section, &part ]()
+        {
+            loadSection( section, [ this, &part ]( std::istream& is ){ part.load( is, m_format ); } );
+        } );
+    }
+}
+
+const Compilation& Analysis::getCompilation() const
+{
+    materialise( eSection_Compilation, m_compilation );
+    return m_compilation;
+}
+
+const FloorAnalysis& Analysis::getFloorAnalysis() const
+{
+    materialise( eSection_Floor, m_floor );
+    return m_floor;
+}
+
+const Visibility& Analysis::getVisibility() const
+{
+    materialise( eSection_Visibility, m_visibility );
+    return m_visibility;
+}
+
+template< typename T, typename Builder >
+void Analysis::materialiseOrBuild( SectionType sectionType, T& part, Builder&& builder ) const
+{
+    Section& section = m_sections[ sectionType ];
+    std::call_once( section.loaded, [ this, &section, &part, &builder ]()
+    {
+        if( section.bPresent )
+        {
+            loadSection( section, [ &part ]( std::istream& is ){ part.load( is ); } );
+        }
+        else
+        {
+            part = builder();
+        }
+    } );
+}
+
+const NavMesh& Analysis::getNavMesh() const
+{
+    materialiseOrBuild( eSection_NavMesh, m_navMesh, [ this ](){ return NavMesh( getFloorAnalysis() ); } );
+    return m_navMesh;
+}
+
+const PortalGraph& Analysis::getPortalGraph() const
+{
+    materialiseOrBuild( eSection_Portals, m_portalGraph, [ this ](){ return PortalGraph( getCompilation() ); } );
+    return m_portalGraph;
+}
+
+const ClearanceField& Analysis::getClearance() const
+{
+    materialiseOrBuild( eSection_Clearance, m_clearance, [ this ]()
+    {
+        VERIFY_RTE_MSG( m_fClearanceResolution > 0.0f, "Analysis has no clearance resolution" );
+        return ClearanceField( getFloorAnalysis(), m_fClearanceResolution );
+    } );
+    return m_clearance;
+}
+
+const CellComplex& Analysis::getCellComplex() const
+{
+    materialiseOrBuild( eSection_Cells, m_cellComplex, [ this ](){ return CellComplex( getNavMesh() ); } );
+    return m_cellComplex;
+}
+
+void Analysis::setClearanceResolution( float fResolution )
+{
+    VERIFY_RTE_MSG( fResolution >= 0.0f, "Invalid clearance resolution: " << fResolution );
+    m_fClearanceResolution = fResolution;
+}
+
+void Analysis::setAgentRadii( const std::vector< float >& radii )
+{
+    m_agents.clear();
+    for( float fRadius : radii )
+    {
+        VERIFY_RTE_MSG( fRadius > 0.0f, "Invalid agent radius: " << fRadius );
+        std::unique_ptr< Agent > pAgent( new Agent );
+        pAgent->fRadius = fRadius;
+        m_agents.emplace_back( std::move( pAgent ) );
+    }
+}
+
+const AgentFloor& Analysis::getAgentFloor( std::size_t szAgent ) const
+{
+    VERIFY_RTE_MSG( szAgent < m_agents.size(), "Invalid agent: " << szAgent );
+    Agent& agent = *m_agents[ szAgent ];
+    std::call_once( agent.built, [ this, &agent ]()
+    {
+        agent.pFloor.reset( new AgentFloor( getFloorAnalysis(), agent.fRadius ) );
+    } );
+    return *agent.pFloor;
+}
+
+std::string Analysis::getFormatVersion()
+{
+    std::ostringstream os;
+    os << static_cast< int >( ANALYSIS_VERSION ) << '.' << static_cast< int >( TOTAL_SECTIONS );
+    return os.str();
+}
+
+void Analysis::save( std::ostream& os, ArrangementFormat format ) const
+{
+    std::ostringstream sections[ TOTAL_SECTIONS ];
+    getCompilation().save(      sections[ eSection_Compilation ],   format );
+    getFloorAnalysis().save(    sections[ eSection_Floor ],         format );
+    getVisibility().save(       sections[ eSection_Visibility ],    format );
+    getNavMesh().save(          sections[ eSection_NavMesh ] );
+    getPortalGraph().save(      sections[ eSection_Portals ] );
+    
+    //the clearance field and cells are only written when requested or already present
+    std::vector< std::uint32_t > present = 
+        { eSection_Compilation, eSection_Floor, eSection_Visibility, eSection_NavMesh, eSection_Portals };
+    if( m_sections[ eSection_Clearance ].bPresent || m_fClearanceResolution > 0.0f )
+    {
+        getClearance().save( sections[ eSection_Clearance ] );
+        present.push_back( eSection_Clearance );
+    }
+    if( m_sections[ eSection_Cells ].bPresent || m_bCellComplex )
+    {
+        getCellComplex().save( sections[ eSection_Cells ] );
+        present.push_back( eSection_Cells );
+    }
+    
+    os.write( ANALYSIS_MAGIC, sizeof( ANALYSIS_MAGIC ) );
+    os.put( ANALYSIS_VERSION );
+    os.put( static_cast< char >( format ) );
+    writeUInt< std::uint32_t >( os, static_cast< std::uint32_t >( present.size() ) );
+    
+    std::uint64_t offset = ANALYSIS_HEADER_SIZE + present.size() * ANALYSIS_SECTION_ENTRY_SIZE;
+    for( std::uint32_t ui : present )
+    {
+        const std::uint64_t size = sections[ ui ].str().size();
+        writeUInt< std::uint32_t >( os, ui );
+        writeUInt< std::uint64_t >( os, offset );
+        writeUInt< std::uint64_t >( os, size );
+        offset += size;
+    }
+    
+    for( std::uint32_t ui : present )
+    {
+        const std::string str = sections[ ui ].str();
+        os.write( str.data(), str.size() );
+    }
 }
 
 void Analysis::renderFloor( IPainter& painter ) const
 {
-    const Arrangement& floor = m_floor.getFloor();
+    const Arrangement& floor = getFloorAnalysis().getFloor();
     for( auto i = floor.edges_begin(); i != floor.edges_end(); ++i )
     {
         Arrangement::Halfedge_const_handle h = i;
@@ -727,4 +1134,182 @@ void Analysis::renderFloor( IPainter& painter ) const
     }
 }
 
+
+void Analysis::setPointLocationStrategy( PointLocationStrategy strategy )
+{
+    VERIFY_RTE_MSG( !m_pFloorLocator, "Point location is already built" );
+    m_locationStrategy = strategy;
+}
+
+void Analysis::buildPointLocation() const
+{
+    std::call_once( m_locationBuilt, [ this ]()
+    {
+        const FloorAnalysis& floor = getFloorAnalysis();
+        const Arrangement& cells = getVisibility().getArrangement();
+        m_pFloorLocator.reset( new PointLocator( floor.getFloor(), m_locationStrategy ) );
+        m_pCellLocator.reset( new PointLocator( cells, m_locationStrategy ) );
+        
+        //the visibility arrangement contains the floor boundary so each bounded face is 
+        //either a cell or within a hole.  The floor side of a point within any of its edges 
+        //decides.  Floor vertices are all on the visibility arrangement but the floor
+        //arrangement has other vertices within holes, so a point on one of those is skipped
+        const Arrangement::Face_const_handle hFloorFace = floor.getFloorFace();
+        auto classify = [ this, hFloorFace ]( Arrangement::Halfedge_const_handle h, 
+            const Point& pt ) -> boost::optional< bool >
+        {
+            const PointLocator::Result result = m_pFloorLocator->locate( pt );
+            if( const Arrangement::Face_const_handle* pFace = 
+                boost::get< Arrangement::Face_const_handle >( &result ) )
+            {
+                return *pFace == hFloorFace;
+            }
+            else if( const Arrangement::Halfedge_const_handle* pHalfedge = 
+                boost::get< Arrangement::Halfedge_const_handle >( &result ) )
+            {
+                const bool bSameDirection = 
+                    CGAL::compare_xy( h->source()->point(), h->target()->point() ) ==
+                    CGAL::compare_xy( ( *pHalfedge )->source()->point(), ( *pHalfedge )->target()->point() );
+                return ( bSameDirection ? ( *pHalfedge )->face() : ( *pHalfedge )->twin()->face() ) == hFloorFace;
+            }
+            return boost::optional< bool >();
+        };
+        
+        for( auto i = cells.faces_begin(); i != cells.faces_end(); ++i )
+        {
+            if( i->is_unbounded() )
+                continue;
+            
+            //the midpoints of every edge first then the quarter points
+            boost::optional< bool > cellOpt;
+            for( int iFraction = 0; iFraction != 3 && !cellOpt; ++iFraction )
+            {
+                Arrangement::Ccb_halfedge_const_circulator iter = i->outer_ccb(), start = iter;
+                do
+                {
+                    const Point& ptSource = iter->source()->point();
+                    const Point& ptTarget = iter->target()->point();
+                    const Point ptMid = CGAL::midpoint( ptSource, ptTarget );
+                    const Point pt = 
+                        iFraction == 0 ? ptMid : 
+                        iFraction == 1 ? CGAL::midpoint( ptSource, ptMid ) : 
+                                         CGAL::midpoint( ptMid, ptTarget );
+                    cellOpt = classify( iter, pt );
+                    ++iter;
+                }
+                while( !cellOpt && iter != start );
+            }
+            VERIFY_RTE_MSG( cellOpt, "Failed to classify visibility cell against the floor" );
+            
+            if( cellOpt.get() )
+                m_cells.insert( &*i );
+        }
+    } );
+}
+
+bool Analysis::isCell( Arrangement::Face_const_handle hFace ) const
+{
+    return m_cells.count( &*hFace ) != 0U;
+}
+
+Analysis::FaceOpt Analysis::locateFloor( const Point& pt ) const
+{
+    buildPointLocation();
+    
+    const Arrangement::Face_const_handle hFloorFace = getFloorAnalysis().getFloorFace();
+    const PointLocator::Result result = m_pFloorLocator->locate( pt );
+    
+    if( const Arrangement::Face_const_handle* pFace = 
+        boost::get< Arrangement::Face_const_handle >( &result ) )
+    {
+        if( *pFace == hFloorFace )
+            return hFloorFace;
+    }
+    else if( const Arrangement::Halfedge_const_handle* pHalfedge = 
+        boost::get< Arrangement::Halfedge_const_handle >( &result ) )
+    {
+        if( ( *pHalfedge )->face() == hFloorFace || ( *pHalfedge )->twin()->face() == hFloorFace )
+            return hFloorFace;
+    }
+    else if( const Arrangement::Vertex_const_handle* pVertex = 
+        boost::get< Arrangement::Vertex_const_handle >( &result ) )
+    {
+        if( ( *pVertex )->is_isolated() )
+        {
+            if( ( *pVertex )->face() == hFloorFace )
+                return hFloorFace;
+        }
+        else
+        {
+            Arrangement::Halfedge_around_vertex_const_circulator iter = ( *pVertex )->incident_halfedges();
+            Arrangement::Halfedge_around_vertex_const_circulator start = iter;
+            do
+            {
+                if( iter->face() == hFloorFace )
+                    return hFloorFace;
+                ++iter;
+            }
+            while( iter != start );
+        }
+    }
+    return FaceOpt();
+}
+
+Analysis::FaceOpt Analysis::locateCell( const Point& pt ) const
+{
+    if( !locateFloor( pt ) )
+        return FaceOpt();
+        
+    //points on edges or vertices resolve to any incident cell
+    const PointLocator::Result result = m_pCellLocator->locate( pt );
+    if( const Arrangement::Face_const_handle* pFace = 
+        boost::get< Arrangement::Face_const_handle >( &result ) )
+    {
+        if( isCell( *pFace ) )
+            return *pFace;
+    }
+    else if( const Arrangement::Halfedge_const_handle* pHalfedge = 
+        boost::get< Arrangement::Halfedge_const_handle >( &result ) )
+    {
+        if( isCell( ( *pHalfedge )->face() ) )
+            return ( *pHalfedge )->face();
+        if( isCell( ( *pHalfedge )->twin()->face() ) )
+            return ( *pHalfedge )->twin()->face();
+    }
+    else if( const Arrangement::Vertex_const_handle* pVertex = 
+        boost::get< Arrangement::Vertex_const_handle >( &result ) )
+    {
+        if( ( *pVertex )->is_isolated() )
+        {
+            if( isCell( ( *pVertex )->face() ) )
+                return ( *pVertex )->face();
+        }
+        else
+        {
+            Arrangement::Halfedge_around_vertex_const_circulator iter = ( *pVertex )->incident_halfedges();
+            Arrangement::Halfedge_around_vertex_const_circulator start = iter;
+            do
+            {
+                if( isCell( iter->face() ) )
+                    return iter->face();
+                ++iter;
+            }
+            while( iter != start );
+        }
+    }
+    return FaceOpt();
+}
+
+void Analysis::locateCells( const std::vector< Point >& points, std::vector< FaceOpt >& cells ) const
+{
+    buildPointLocation();
+    
+    cells.clear();
+    cells.reserve( points.size() );
+    for( const Point& pt : points )
+    {
+        cells.push_back( locateCell( pt ) );
+    }
+}
+
 }
@@ -64,17 +64,14 @@ void Wall::init( Float x, Float y )
     Site::init();
     
     setTranslation( m_transform, Map_FloorAverage()( x ), Map_FloorAverage()( y ) );
+    updateDiscreteTransform();
 }
     
     
 void Wall::evaluate( const EvaluationMode& mode, EvaluationResults& results )
 {
     //bottom up recursion
-    for( PtrVector::iterator i = m_sites.begin(),
-        iEnd = m_sites.end(); i!=iEnd; ++i )
-    {
-        (*i)->evaluate( mode, results );
-    }
+    evaluateChildren( mode, results );
     
     const Polygon& polygon = m_pContour->getPolygon();
     if( polygon != m_contourPolygon )
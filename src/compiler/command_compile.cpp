@@ -20,8 +20,11 @@
 #include "blueprint/blueprint.h"
 #include "blueprint/factory.h"
 #include "blueprint/compilation.h"
+#include "blueprint/offsetCache.h"
 #include "blueprint/visibility.h"
 
+#include "ed/node.hpp"
+
 #include "common/assert_verify.hpp"
 #include "common/file.hpp"
 
@@ -29,6 +32,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/tokenizer.hpp>
 #include <boost/timer/timer.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
 
 #pragma warning( push )
 #pragma warning( disable : 4996) //iterator thing
@@ -37,8 +42,12 @@
 #pragma warning( pop )
 
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
 #include <memory>
 #include <map>
+#include <cstdint>
 
 boost::filesystem::path constructPath( const std::string& strHTMLFile, const char* pszExt )
 {
@@ -49,9 +58,171 @@ boost::filesystem::path constructPath( const std::string& strHTMLFile, const cha
     return t.parent_path() / os.str();
 }
 
+namespace
+{
+    //compilation cache keyed on the hash of the fully loaded blueprint including all
+    //expanded clips.  Entries are complete .bluc files so a hit is a file copy.
+    class CompileCache
+    {
+        //increment whenever the analysis changes without a change to its file format
+        static constexpr const char* CACHE_VERSION = "bluc_cache_3";
+        
+    public:
+        using Hash = std::uint64_t;
+        
+        struct Statistics
+        {
+            std::size_t szHits      = 0U;
+            std::size_t szMisses    = 0U;
+        };
+        
+        CompileCache( const boost::filesystem::path& cacheDir )
+            :   m_cacheDir( cacheDir )
+        {
+            boost::filesystem::create_directories( m_cacheDir );
+            loadStatistics();
+        }
+        
+        static Hash calculateHash( Blueprint::Site::Ptr pBlueprint, 
+            const Blueprint::Site::EvaluationMode& mode, float fClearance )
+        {
+            std::ostringstream os;
+            os << CACHE_VERSION << ' ' << Blueprint::Analysis::getFormatVersion() << ' ' << 
+                mode.bArrangement << mode.bCellComplex << mode.bClearance << mode.bClipper;
+            if( mode.bClearance )
+                os << ' ' << std::setprecision( 9 ) << fClearance;
+#ifdef BLUEPRINT_RATIONAL_KERNEL
+            os << " rational";
+#endif
+            os << '\n';
+            {
+                Ed::Node node( Ed::Statement( Ed::Declarator( ( Ed::Identifier( pBlueprint->getName() ) ) ) ) );
+                pBlueprint->save( node );
+                os << node;
+            }
+            
+            //FNV-1a
+            const std::string str = os.str();
+            Hash hash = 14695981039346656037ULL;
+            for( const char c : str )
+            {
+                hash ^= static_cast< unsigned char >( c );
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+        
+        boost::filesystem::path getEntryPath( Hash hash ) const
+        {
+            std::ostringstream os;
+            os << std::hex << std::setw( 16 ) << std::setfill( '0' ) << hash << ".bluc";
+            return m_cacheDir / os.str();
+        }
+        
+        bool retrieve( Hash hash, const boost::filesystem::path& outputFile )
+        {
+            const boost::filesystem::path entryPath = getEntryPath( hash );
+            if( boost::filesystem::exists( entryPath ) )
+            {
+                boost::filesystem::copy_file( entryPath, outputFile, 
+                    boost::filesystem::copy_option::overwrite_if_exists );
+                recordStatistic( true );
+                return true;
+            }
+            recordStatistic( false );
+            return false;
+        }
+        
+        void store( Hash hash, const boost::filesystem::path& compilationFile )
+        {
+            //copy then rename so concurrent compilers never see a partial entry
+            const boost::filesystem::path entryPath = getEntryPath( hash );
+            boost::filesystem::path tempPath = entryPath;
+            tempPath += boost::filesystem::unique_path( ".%%%%%%%%" );
+            boost::filesystem::copy_file( compilationFile, tempPath, 
+                boost::filesystem::copy_option::overwrite_if_exists );
+            boost::filesystem::rename( tempPath, entryPath );
+        }
+        
+        void report( std::ostream& os ) const
+        {
+            std::size_t szEntries = 0U;
+            std::uintmax_t szBytes = 0U;
+            for( boost::filesystem::directory_iterator i( m_cacheDir ), iEnd; i != iEnd; ++i )
+            {
+                if( i->path().extension() == ".bluc" )
+                {
+                    ++szEntries;
+                    szBytes += boost::filesystem::file_size( i->path() );
+                }
+            }
+            
+            const std::size_t szTotal = m_statistics.szHits + m_statistics.szMisses;
+            os << "Compile cache:   " << m_cacheDir.string() << "\n";
+            os << "Entries:         " << szEntries << " ( " << szBytes << " bytes )\n";
+            os << "Hits:            " << m_statistics.szHits << "\n";
+            os << "Misses:          " << m_statistics.szMisses << "\n";
+            if( szTotal )
+            {
+                os << "Hit rate:        " << std::fixed << std::setprecision( 1 ) << 
+                    ( 100.0 * m_statistics.szHits ) / szTotal << "%\n";
+            }
+        }
+        
+    private:
+        boost::filesystem::path getStatisticsPath() const { return m_cacheDir / "cache.stats"; }
+        boost::filesystem::path getLockPath() const { return m_cacheDir / "cache.lock"; }
+        
+        //compilers sharing the cache update the statistics under a file lock so
+        //concurrent hits and misses are not lost
+        void recordStatistic( bool bHit )
+        {
+            {
+                std::ofstream touch( getLockPath().string(), std::ios_base::app );
+            }
+            boost::interprocess::file_lock fileLock( getLockPath().string().c_str() );
+            boost::interprocess::scoped_lock< boost::interprocess::file_lock > lock( fileLock );
+            
+            loadStatistics();
+            if( bHit )
+                ++m_statistics.szHits;
+            else
+                ++m_statistics.szMisses;
+            saveStatistics();
+        }
+        
+        void loadStatistics()
+        {
+            m_statistics = Statistics();
+            std::ifstream is( getStatisticsPath().string() );
+            if( is )
+            {
+                is >> m_statistics.szHits >> m_statistics.szMisses;
+                if( !is )
+                    m_statistics = Statistics();
+            }
+        }
+        
+        void saveStatistics() const
+        {
+            std::ofstream os( getStatisticsPath().string() );
+            os << m_statistics.szHits << ' ' << m_statistics.szMisses << '\n';
+        }
+        
+        const boost::filesystem::path m_cacheDir;
+        Statistics m_statistics;
+    };
+}
+
 void command_compile( bool bHelp, const std::vector< std::string >& args )
 {
     std::string strDirectory, strProject, strBlueprint, strOut;//, strVis, strHTML, strIn;
+    std::size_t szThreads = 1U;
+    float fClearance = 0.0f;
+    std::string strCache;
+    bool bCacheStats = false;
+    bool bCellComplex = false;
+    bool bClipper = false;
 
     namespace po = boost::program_options;
     po::options_description commandOptions(" Build Project Command");
@@ -63,6 +234,12 @@ void command_compile( bool bHelp, const std::vector< std::string >& args )
             //("html",        po::value< std::string >( &strHTML ),       "HTML file to generate" )
             //("in",          po::value< std::string >( &strIn ),         "Input file" )
             ("out",         po::value< std::string >( &strOut ),        "Output file" )
+            ("threads",     po::value< std::size_t >( &szThreads ),     "Evaluation and visibility threads. Zero uses all cores" )
+            ("cache",       po::value< std::string >( &strCache ),      "Compile cache directory" )
+            ("clearance",   po::value< float >( &fClearance ),          "Clearance field resolution in world units per pixel" )
+            ("cells",       po::bool_switch( &bCellComplex ),           "Partition the floor into convex cells" )
+            ("clipper",     po::bool_switch( &bClipper ),               "Integer offsets and booleans for axis aligned spaces" )
+            ("cache_stats", po::bool_switch( &bCacheStats ),            "Report compile cache statistics" )
             //("vis",         po::value< std::string >( &strVis ),        "Visibility file" );
             
         ;
@@ -86,6 +263,12 @@ void command_compile( bool bHelp, const std::vector< std::string >& args )
             std::cout << "Missing blueprint file" << std::endl;
             return;
         }
+        
+        if( bCacheStats && strCache.empty() )
+        {
+            std::cout << "Cache statistics require a cache directory" << std::endl;
+            return;
+        }
 
         const boost::filesystem::path blueprintFilePath =
             boost::filesystem::edsCannonicalise(
@@ -104,17 +287,74 @@ void command_compile( bool bHelp, const std::vector< std::string >& args )
             VERIFY_RTE_MSG( pBlueprint, "Failed to load blueprint: " << blueprintFilePath.generic_string() );
         
             std::cout << "Loaded blueprint: " << blueprintFilePath.string() << std::endl;
+            
+            const Blueprint::Site::EvaluationMode mode = { true, bCellComplex, fClearance > 0.0f, bClipper };
+            
+            std::unique_ptr< CompileCache > pCache;
+            CompileCache::Hash hash = 0U;
+            if( !strCache.empty() )
+            {
+                pCache.reset( new CompileCache( boost::filesystem::absolute( strCache ) ) );
+                hash = CompileCache::calculateHash( pBlueprint, mode, fClearance );
+                
+                if( !strOut.empty() && pCache->retrieve( hash, constructPath( strOut, ".bluc" ) ) )
+                {
+                    std::cout << "Retrieved cached compilation: " << pCache->getEntryPath( hash ).string() << std::endl;
+                    if( bCacheStats )
+                        pCache->report( std::cout );
+                    return;
+                }
+            }
+            
+            std::unique_ptr< Blueprint::ThreadPool > pPool;
+            if( szThreads != 1U )
+            {
+                if( !Blueprint::KERNEL_IS_THREAD_SAFE )
+                    std::cout << "Kernel is not thread safe with this CGAL build so parallel tasks work on isolated copies of the geometry" << std::endl;
+                pPool.reset( new Blueprint::ThreadPool( szThreads ) );
+            }
+            
+            Blueprint::Site::EvaluationResults results;
             {
-                const Blueprint::Site::EvaluationMode mode = { true, false, false };
-                Blueprint::Site::EvaluationResults results;
-                pBlueprint->evaluate( mode, results );
+                //spaces with the same contour share their wall offsets during this evaluation
+                Blueprint::OffsetCache::setInstance( Blueprint::OffsetCache::Ptr( new Blueprint::OffsetCache ) );
+                Blueprint::Site::EvaluationMode evaluationMode = mode;
+                evaluationMode.pPool = pPool.get();
+                pBlueprint->evaluate( evaluationMode, results );
+                Blueprint::OffsetCache::setInstance( Blueprint::OffsetCache::Ptr() );
             }
             std::cout << "Evaluated blueprint: " << blueprintFilePath.string() << std::endl;
+            std::cout << "Evaluated sites: " << results.szSitesEvaluated << 
+                " skipped: " << results.szSitesSkipped << std::endl;
+            for( const std::string& strError : results.errors )
+            {
+                std::cout << "Evaluation error: " << strError << std::endl;
+            }
             
-            Blueprint::Analysis::Ptr pAnalysis = 
-                Blueprint::Analysis::constructFromBlueprint( pBlueprint );
+            Blueprint::Analysis::Ptr pAnalysis;
+            if( !pPool )
+            {
+                pAnalysis = Blueprint::Analysis::constructFromBlueprint( pBlueprint );
+            }
+            else
+            {
+                pAnalysis = Blueprint::Analysis::constructFromBlueprint( *pPool, pBlueprint );
+            }
             
             std::cout << "Analysis completed" << std::endl;
+            {
+                const Blueprint::Visibility::Statistics& statistics = pAnalysis->getVisibility().getStatistics();
+                std::cout << "Reflex pairs: " << statistics.szReflexPairs << 
+                    " culled: " << statistics.szCulled << 
+                    " tested: " << ( statistics.szReflexPairs - statistics.szCulled ) << 
+                    " visible: " << statistics.szVisible << std::endl;
+            }
+            
+            if( mode.bClearance )
+            {
+                pAnalysis->setClearanceResolution( fClearance );
+            }
+            pAnalysis->setCellComplex( mode.bCellComplex );
             
             if( !strOut.empty() )
             {
@@ -125,6 +365,17 @@ void command_compile( bool bHelp, const std::vector< std::string >& args )
                     boost::filesystem::createBinaryOutputFileStream( compilationFilePath );
                     
                 pAnalysis->save( *pOutFile );
+                pOutFile.reset();
+                
+                if( pCache )
+                {
+                    pCache->store( hash, compilationFilePath );
+                }
+            }
+            
+            if( pCache && bCacheStats )
+            {
+                pCache->report( std::cout );
             }
             /*
             Blueprint::Compilation compilation( pTest );
@@ -0,0 +1,412 @@
+#include "blueprint/visibility.h"
+#include "blueprint/navMesh.h"
+#include "blueprint/portalGraph.h"
+#include "blueprint/binaryIO.h"
+
+#include "blueprintTestUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace BlueprintTest;
+
+    bool isInFace( Blueprint::Arrangement::Face_const_handle hFace, const Blueprint::Point& pt )
+    {
+        using namespace Blueprint;
+        Polygon poly;
+        Arrangement::Ccb_halfedge_const_circulator iter = hFace->outer_ccb(), start = iter;
+        do
+        {
+            poly.push_back( iter->source()->point() );
+            ++iter;
+        }
+        while( iter != start );
+        return poly.bounded_side( pt ) != CGAL::ON_UNBOUNDED_SIDE;
+    }
+    
+    void expectSameCounts( const Blueprint::Arrangement& expected, const Blueprint::Arrangement& actual )
+    {
+        ASSERT_EQ( expected.number_of_vertices(),   actual.number_of_vertices() );
+        ASSERT_EQ( expected.number_of_edges(),      actual.number_of_edges() );
+        ASSERT_EQ( expected.number_of_faces(),      actual.number_of_faces() );
+    }
+    
+    std::string readFile( const boost::filesystem::path& filePath )
+    {
+        std::ifstream is( filePath.string(), std::ios_base::in | std::ios_base::binary );
+        return std::string( std::istreambuf_iterator< char >( is ), std::istreambuf_iterator< char >() );
+    }
+    
+    void writeFile( const boost::filesystem::path& filePath, const std::string& str )
+    {
+        std::ofstream os( filePath.string(), std::ios_base::out | std::ios_base::binary );
+        os.write( str.data(), str.size() );
+    }
+    
+    //the byte range of a section from the table following the ten byte header
+    std::pair< std::size_t, std::size_t > findSection( const std::string& str, std::uint32_t uiType )
+    {
+        auto read = [ &str ]( std::size_t szPos, std::size_t szBytes )
+        {
+            std::uint64_t value = 0U;
+            for( std::size_t sz = 0U; sz != szBytes; ++sz )
+                value |= static_cast< std::uint64_t >( static_cast< unsigned char >( str[ szPos + sz ] ) ) << ( 8U * sz );
+            return static_cast< std::size_t >( value );
+        };
+        const std::size_t szSections = read( 6U, 4U );
+        for( std::size_t sz = 0U; sz != szSections; ++sz )
+        {
+            const std::size_t szEntry = 10U + sz * 20U;
+            if( read( szEntry, 4U ) == uiType )
+                return std::make_pair( read( szEntry + 4U, 8U ), read( szEntry + 12U, 8U ) );
+        }
+        return std::make_pair( str.size(), std::size_t( 0U ) );
+    }
+
+    std::vector< Blueprint::Point > getTestPoints()
+    {
+        using namespace Blueprint;
+        return
+        {
+            //room interiors, the doorway and a reflex corner of the doorway
+            Point( 0, -16 ), Point( -10, 20 ), Point( 0, 1 ), Point( 3, -2 ),
+            //within a wall, beyond the blueprint
+            Point( 0, -31 ), Point( 15, 16 ), Point( 100, 100 )
+        };
+    }
+}
+
+TEST( Analysis, LocateFloor )
+{
+    using namespace Blueprint;
+    Analysis::Ptr pAnalysis = Analysis::constructFromBlueprint( makeTwoRooms() );
+    const Arrangement::Face_const_handle hFloorFace = pAnalysis->getFloorAnalysis().getFloorFace();
+
+    const std::vector< Point > points = getTestPoints();
+    for( std::size_t sz = 0U; sz != points.size(); ++sz )
+    {
+        const Analysis::FaceOpt floorOpt = pAnalysis->locateFloor( points[ sz ] );
+        ASSERT_EQ( static_cast< bool >( floorOpt ), sz < 4U );
+        if( floorOpt )
+            ASSERT_TRUE( floorOpt.get() == hFloorFace );
+    }
+}
+
+TEST( Analysis, LocateCells )
+{
+    using namespace Blueprint;
+    const std::vector< Point > points = getTestPoints();
+
+    std::vector< Analysis::FaceOpt > cells[ 2 ];
+    const PointLocationStrategy strategies[ 2 ] = { ePointLocation_Landmarks, ePointLocation_Trapezoid };
+    for( int i = 0; i != 2; ++i )
+    {
+        Analysis::Ptr pAnalysis = Analysis::constructFromBlueprint( makeTwoRooms() );
+        pAnalysis->setPointLocationStrategy( strategies[ i ] );
+        pAnalysis->locateCells( points, cells[ i ] );
+        ASSERT_EQ( cells[ i ].size(), points.size() );
+
+        for( std::size_t sz = 0U; sz != points.size(); ++sz )
+        {
+            const Analysis::FaceOpt cellOpt = pAnalysis->locateCell( points[ sz ] );
+            ASSERT_EQ( static_cast< bool >( cellOpt ), sz < 4U );
+            ASSERT_EQ( static_cast< bool >( cells[ i ][ sz ] ), sz < 4U );
+            if( cellOpt )
+            {
+                ASSERT_TRUE( cellOpt.get() == cells[ i ][ sz ].get() );
+                ASSERT_TRUE( isInFace( cellOpt.get(), points[ sz ] ) );
+            }
+        }
+    }
+}
+
+TEST( Analysis, SectionedFileRoundTrip )
+{
+    using namespace Blueprint;
+    Analysis::Ptr pAnalysis = Analysis::constructFromBlueprint( makeTwoRooms() );
+    
+    const boost::filesystem::path filePath = 
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path( "%%%%-%%%%-%%%%.bluc" );
+    {
+        std::ofstream os( filePath.string(), std::ios_base::out | std::ios_base::binary );
+        pAnalysis->save( os );
+    }
+    
+    {
+        Analysis::Ptr pLoaded = Analysis::constructFromFile( filePath );
+        expectSameCounts( pAnalysis->getCompilation().getArrangement(), pLoaded->getCompilation().getArrangement() );
+        expectSameCounts( pAnalysis->getFloorAnalysis().getFloor(), pLoaded->getFloorAnalysis().getFloor() );
+        expectSameCounts( pAnalysis->getVisibility().getArrangement(), pLoaded->getVisibility().getArrangement() );
+        ASSERT_EQ( pAnalysis->getNavMesh().getIndices(), pLoaded->getNavMesh().getIndices() );
+        ASSERT_TRUE( static_cast< bool >( pLoaded->locateFloor( Point( 0, -16 ) ) ) );
+    }
+    
+    //only the parts accessed are parsed so a damaged visibility section goes unnoticed
+    //by a consumer of the floor alone
+    {
+        std::string str = readFile( filePath );
+        const std::pair< std::size_t, std::size_t > visibility = findSection( str, 2U );
+        ASSERT_GT( visibility.second, 0U );
+        ASSERT_LE( visibility.first + visibility.second, str.size() );
+        std::fill( str.begin() + visibility.first, str.begin() + visibility.first + visibility.second, '\xFF' );
+        writeFile( filePath, str );
+        
+        Analysis::Ptr pLoaded = Analysis::constructFromFile( filePath );
+        expectSameCounts( pAnalysis->getFloorAnalysis().getFloor(), pLoaded->getFloorAnalysis().getFloor() );
+        ASSERT_TRUE( pLoaded->getFloorAnalysis().getQuery().isWithinFloor( Point( 0, -16 ) ) );
+    }
+    
+    boost::filesystem::remove( filePath );
+}
+
+TEST( Visibility, CullKeepsEveryVisiblePair )
+{
+    using namespace Blueprint;
+    
+    //a hall of pillars so many reflex pairs are hidden behind other pillars
+    std::vector< Polygon > pillars;
+    for( int x = 0; x != 4; ++x )
+    {
+        for( int y = 0; y != 3; ++y )
+        {
+            const double fX = 6.0 + x * 8.0 + ( y % 2 ) * 3.0, fY = 6.0 + y * 8.0;
+            pillars.push_back( makeRect( fX, fY, fX + 2.0, fY + 2.0 ) );
+        }
+    }
+    FloorAnalysis floor( Polygon_with_holes( makeRect( 0, 0, 40, 30 ), pillars.begin(), pillars.end() ) );
+    
+    //the reflex vertices of the floor as the visibility construction finds them
+    std::vector< Point > reflex;
+    auto collect = [ &reflex ]( Arrangement::Ccb_halfedge_const_circulator iter )
+    {
+        Arrangement::Ccb_halfedge_const_circulator start = iter;
+        do
+        {
+            Arrangement::Ccb_halfedge_const_circulator prev = iter;
+            ++iter;
+            if( CGAL::orientation( prev->source()->point(), prev->target()->point(), 
+                    iter->target()->point() ) == CGAL::NEGATIVE )
+                reflex.push_back( prev->target()->point() );
+        }
+        while( iter != start );
+    };
+    collect( floor.getFloorFace()->outer_ccb() );
+    for( auto i = floor.getFloorFace()->holes_begin(); i != floor.getFloorFace()->holes_end(); ++i )
+        collect( *i );
+    ASSERT_EQ( reflex.size(), pillars.size() * 4U );
+    
+    std::vector< std::vector< bool > > culled( reflex.size() );
+    for( std::size_t i = 0U; i != reflex.size(); ++i )
+    {
+        culled[ i ].resize( reflex.size(), true );
+        floor.getQuery().cullOccluded( reflex[ i ], reflex, culled[ i ] );
+    }
+    
+    //every pair the exact test finds visible survives the cull
+    std::size_t szPairs = 0U, szVisible = 0U, szCulled = 0U;
+    for( std::size_t i = 0U; i != reflex.size(); ++i )
+    {
+        for( std::size_t j = i + 1U; j != reflex.size(); ++j )
+        {
+            ++szPairs;
+            const bool bVisible = floor.getQuery().isWithinFloor( Segment( reflex[ i ], reflex[ j ] ) );
+            const bool bKept = culled[ i ][ j ] && culled[ j ][ i ];
+            if( bVisible )
+            {
+                ++szVisible;
+                ASSERT_TRUE( bKept ) << reflex[ i ] << " to " << reflex[ j ];
+            }
+            if( !bKept )
+                ++szCulled;
+        }
+    }
+    ASSERT_GT( szCulled, 0U );
+    
+    //and the construction finds the same visible pairs as the exhaustive test
+    const Visibility visibility( floor );
+    ASSERT_EQ( visibility.getStatistics().szReflexPairs, szPairs );
+    ASSERT_EQ( visibility.getStatistics().szCulled, szCulled );
+    ASSERT_EQ( visibility.getStatistics().szVisible, szVisible );
+}
+
+TEST( NavMesh, TriangulatesCompiledFloor )
+{
+    using namespace Blueprint;
+    Analysis::Ptr pAnalysis = Analysis::constructFromBlueprint( makeTwoRooms() );
+    const FloorAnalysis& floor = pAnalysis->getFloorAnalysis();
+    const NavMesh mesh( floor );
+    ASSERT_GT( mesh.getTriangleCount(), 0U );
+    
+    //the triangles tile the floor face exactly
+    double fFloorArea = 0.0;
+    {
+        Polygon poly;
+        Arrangement::Ccb_halfedge_const_circulator iter = floor.getFloorFace()->outer_ccb(), start = iter;
+        do
+        {
+            poly.push_back( iter->source()->point() );
+            ++iter;
+        }
+        while( iter != start );
+        fFloorArea = std::abs( CGAL::to_double( poly.area() ) );
+    }
+    
+    const std::vector< float >& vertices = mesh.getVertices();
+    const std::vector< std::uint32_t >& indices = mesh.getIndices();
+    const std::vector< std::uint32_t >& adjacency = mesh.getAdjacency();
+    double fMeshArea = 0.0;
+    for( std::size_t t = 0U; t != mesh.getTriangleCount(); ++t )
+    {
+        const float* a = &vertices[ indices[ t * 3U ] * 2U ];
+        const float* b = &vertices[ indices[ t * 3U + 1U ] * 2U ];
+        const float* c = &vertices[ indices[ t * 3U + 2U ] * 2U ];
+        const double fArea = 0.5 * ( ( b[ 0 ] - a[ 0 ] ) * ( c[ 1 ] - a[ 1 ] ) - ( b[ 1 ] - a[ 1 ] ) * ( c[ 0 ] - a[ 0 ] ) );
+        ASSERT_GT( fArea, 0.0 );
+        fMeshArea += fArea;
+        
+        //neighbours point back across the same edge
+        for( std::size_t k = 0U; k != 3U; ++k )
+        {
+            const std::uint32_t u = adjacency[ t * 3U + k ];
+            if( u != NavMesh::NO_TRIANGLE )
+            {
+                bool bFound = false;
+                for( std::size_t j = 0U; j != 3U; ++j )
+                    bFound = bFound || adjacency[ u * 3U + j ] == t;
+                ASSERT_TRUE( bFound );
+            }
+        }
+    }
+    ASSERT_NEAR( fMeshArea, fFloorArea, 1e-3 );
+    
+    //round trip
+    std::stringstream ss;
+    mesh.save( ss );
+    NavMesh loaded;
+    loaded.load( ss );
+    ASSERT_EQ( loaded.getVertices(), vertices );
+    ASSERT_EQ( loaded.getIndices(), indices );
+    ASSERT_EQ( loaded.getAdjacency(), adjacency );
+}
+
+TEST( NavMesh, RejectsCountsBeyondData )
+{
+    using namespace Blueprint;
+    std::stringstream ss;
+    writeUInt32( ss, 0x40000000U );
+    writeUInt32( ss, 0x40000000U );
+    writeFloat( ss, 0.0f );
+    NavMesh mesh;
+    ASSERT_THROW( mesh.load( ss ), std::exception );
+}
+
+TEST( PortalGraph, ConnectsRoomsThroughDoorway )
+{
+    using namespace Blueprint;
+    Analysis::Ptr pAnalysis = Analysis::constructFromBlueprint( makeTwoRooms() );
+    const PortalGraph& graph = pAnalysis->getPortalGraph();
+    
+    //one node either side of the single doorway
+    ASSERT_EQ( graph.getNodes().size(), 2U );
+    ASSERT_EQ( graph.getPortals().size(), 1U );
+    const PortalGraph::Portal& portal = graph.getPortals().front();
+    ASSERT_NE( portal.uFirst, portal.uSecond );
+    ASSERT_NEAR( portal.fMidX, 0.0f, 1e-3f );
+    ASSERT_NEAR( portal.fMidY, 0.0f, 1e-3f );
+    ASSERT_NEAR( portal.fWidth, 6.0f, 1e-3f );
+    for( std::uint32_t u = 0U; u != 2U; ++u )
+    {
+        ASSERT_EQ( graph.portalsEnd( u ) - graph.portalsBegin( u ), 1 );
+        ASSERT_EQ( *graph.portalsBegin( u ), 0U );
+    }
+    
+    //the nodes are the rooms below and above the doorway
+    const PortalGraph::Node* pBelow = &graph.getNodes()[ portal.uFirst ];
+    const PortalGraph::Node* pAbove = &graph.getNodes()[ portal.uSecond ];
+    if( pBelow->fMinY > pAbove->fMinY )
+        std::swap( pBelow, pAbove );
+    ASSERT_LT( pBelow->fMinY, -16.0f );
+    ASSERT_LE( pBelow->fMaxY, 1e-3f );
+    ASSERT_GE( pAbove->fMinY, -1e-3f );
+    ASSERT_GT( pAbove->fMaxY, 16.0f );
+    
+    //round trip
+    std::stringstream ss;
+    graph.save( ss );
+    PortalGraph loaded;
+    loaded.load( ss );
+    ASSERT_EQ( loaded.getNodes().size(), graph.getNodes().size() );
+    ASSERT_EQ( loaded.getPortals().size(), graph.getPortals().size() );
+    const PortalGraph::Portal& loadedPortal = loaded.getPortals().front();
+    ASSERT_EQ( loadedPortal.uFirst, portal.uFirst );
+    ASSERT_EQ( loadedPortal.uSecond, portal.uSecond );
+    ASSERT_EQ( loadedPortal.fMidX, portal.fMidX );
+    ASSERT_EQ( loadedPortal.fMidY, portal.fMidY );
+    ASSERT_EQ( loadedPortal.fWidth, portal.fWidth );
+    ASSERT_EQ( loaded.getNodes()[ 0 ].fMinY, graph.getNodes()[ 0 ].fMinY );
+    ASSERT_EQ( loaded.getNodes()[ 1 ].fMaxY, graph.getNodes()[ 1 ].fMaxY );
+}
+
+TEST( PortalGraph, RejectsCountsBeyondData )
+{
+    using namespace Blueprint;
+    std::stringstream ss;
+    writeUInt32( ss, 0x40000000U );
+    writeFloat( ss, 0.0f );
+    PortalGraph graph;
+    ASSERT_THROW( graph.load( ss ), std::exception );
+}
+
+TEST( AgentFloor, SplitsAtNarrowDoorway )
+{
+    using namespace Blueprint;
+    Analysis::Ptr pAnalysis = Analysis::constructFromBlueprint( makeTwoRooms() );
+    const FloorAnalysis& floor = pAnalysis->getFloorAnalysis();
+    
+    //the doorway is six wide so a small agent passes through it
+    {
+        const AgentFloor agentFloor( floor, 1.0f );
+        ASSERT_EQ( agentFloor.getRegionCount(), 1U );
+        ASSERT_TRUE( static_cast< bool >( agentFloor.findRegion( Point( 0, 1 ) ) ) );
+    }
+    
+    //and a large one is left with a region in each room
+    {
+        const AgentFloor agentFloor( floor, 4.0f );
+        ASSERT_EQ( agentFloor.getRegionCount(), 2U );
+        const boost::optional< std::size_t > a = agentFloor.findRegion( Point( 0, -16 ) );
+        const boost::optional< std::size_t > b = agentFloor.findRegion( Point( 0, 16 ) );
+        ASSERT_TRUE( a && b );
+        ASSERT_NE( a.get(), b.get() );
+        ASSERT_FALSE( static_cast< bool >( agentFloor.findRegion( Point( 0, 0 ) ) ) );
+    }
+}
+
+TEST( AgentFloor, SplitsPinchedBoundary )
+{
+    using namespace Blueprint;
+    
+    //a triangular hole touching the left wall pinches the outer ccb of the floor at ( 0, 5 )
+    Polygon hole;
+    hole.push_back( Point( 0, 5 ) );
+    hole.push_back( Point( 4, 7 ) );
+    hole.push_back( Point( 4, 3 ) );
+    const FloorAnalysis floor( Polygon_with_holes( makeRect( 0, 0, 10, 10 ), &hole, &hole + 1 ) );
+    
+    const AgentFloor agentFloor( floor, 0.5f );
+    ASSERT_EQ( agentFloor.getRegionCount(), 1U );
+    ASSERT_TRUE( static_cast< bool >( agentFloor.findRegion( Point( 8, 5 ) ) ) );
+    ASSERT_TRUE( static_cast< bool >( agentFloor.findRegion( Point( 1, 9 ) ) ) );
+    ASSERT_FALSE( static_cast< bool >( agentFloor.findRegion( Point( 3, 5 ) ) ) );
+}
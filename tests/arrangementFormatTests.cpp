@@ -0,0 +1,110 @@
+
+#include "blueprint/cgalSettings.h"
+#include "blueprint/arrangementFormat.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+    //grid of overlapping rooms with diagonals so both the double and rational
+    //coordinate encodings are exercised
+    void buildTestArrangement( Blueprint::Arrangement& arr, int iSize )
+    {
+        using namespace Blueprint;
+        std::vector< Curve > curves;
+        for( int x = 0; x != iSize; ++x )
+        {
+            for( int y = 0; y != iSize; ++y )
+            {
+                const Point p0( x * 10.0, y * 10.0 ),           p1( x * 10.0 + 12.5, y * 10.0 );
+                const Point p2( x * 10.0 + 12.5, y * 10.0 + 12.5 ), p3( x * 10.0, y * 10.0 + 12.5 );
+                curves.push_back( Curve( p0, p1 ) );
+                curves.push_back( Curve( p1, p2 ) );
+                curves.push_back( Curve( p2, p3 ) );
+                curves.push_back( Curve( p3, p0 ) );
+                curves.push_back( Curve( p0, Point( x * 10.0 + 7.0, y * 10.0 + 3.0 ) ) );
+            }
+        }
+        CGAL::insert( arr, curves.begin(), curves.end() );
+        
+        //mark some halfedges as doorsteps
+        int iCount = 0;
+        for( auto i = arr.edges_begin(); i != arr.edges_end(); ++i, ++iCount )
+        {
+            if( iCount % 7 == 0 )
+            {
+                i->set_data( DefaultedBool( true ) );
+                i->twin()->set_data( DefaultedBool( true ) );
+            }
+        }
+    }
+    
+    std::vector< Blueprint::Point > getSortedPoints( const Blueprint::Arrangement& arr )
+    {
+        std::vector< Blueprint::Point > points;
+        for( auto i = arr.vertices_begin(); i != arr.vertices_end(); ++i )
+            points.push_back( i->point() );
+        std::sort( points.begin(), points.end() );
+        return points;
+    }
+    
+    std::size_t countDoorsteps( const Blueprint::Arrangement& arr )
+    {
+        std::size_t szCount = 0U;
+        for( auto i = arr.halfedges_begin(); i != arr.halfedges_end(); ++i )
+            if( i->data().get() )
+                ++szCount;
+        return szCount;
+    }
+    
+    void load( const std::string& str, Blueprint::ArrangementFormat format, Blueprint::Arrangement& arr )
+    {
+        std::istringstream is( str, std::ios_base::in | std::ios_base::binary );
+        Blueprint::readArrangement( is, arr, format );
+    }
+}
+
+TEST( ArrangementFormat, BinaryRoundTripIsExact )
+{
+    using namespace Blueprint;
+    Arrangement arr;
+    buildTestArrangement( arr, 4 );
+    
+    std::ostringstream os( std::ios_base::out | std::ios_base::binary );
+    writeArrangement( os, arr, eArrFormat_Binary );
+    
+    Arrangement loaded;
+    load( os.str(), eArrFormat_Binary, loaded );
+    
+    ASSERT_TRUE( loaded.is_valid() );
+    ASSERT_EQ( arr.number_of_vertices(), loaded.number_of_vertices() );
+    ASSERT_EQ( arr.number_of_edges(),    loaded.number_of_edges() );
+    ASSERT_EQ( arr.number_of_faces(),    loaded.number_of_faces() );
+    ASSERT_EQ( countDoorsteps( arr ),    countDoorsteps( loaded ) );
+    ASSERT_TRUE( getSortedPoints( arr ) == getSortedPoints( loaded ) );
+}
+
+TEST( ArrangementFormat, BinaryMatchesText )
+{
+    using namespace Blueprint;
+    Arrangement arr;
+    buildTestArrangement( arr, 4 );
+    
+    std::ostringstream osText, osBinary( std::ios_base::out | std::ios_base::binary );
+    writeArrangement( osText, arr, eArrFormat_Text );
+    writeArrangement( osBinary, arr, eArrFormat_Binary );
+    
+    Arrangement textArr, binaryArr;
+    load( osText.str(), eArrFormat_Text, textArr );
+    load( osBinary.str(), eArrFormat_Binary, binaryArr );
+    
+    ASSERT_EQ( textArr.number_of_edges(), binaryArr.number_of_edges() );
+    ASSERT_EQ( textArr.number_of_faces(), binaryArr.number_of_faces() );
+    ASSERT_EQ( countDoorsteps( textArr ), countDoorsteps( binaryArr ) );
+    ASSERT_TRUE( getSortedPoints( textArr ) == getSortedPoints( binaryArr ) );
+    ASSERT_LT( osBinary.str().size(), osText.str().size() );
+}
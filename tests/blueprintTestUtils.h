@@ -0,0 +1,84 @@
+#ifndef BLUEPRINT_TEST_UTILS_18_OCT_2026
+#define BLUEPRINT_TEST_UTILS_18_OCT_2026
+
+#include "blueprint/blueprint.h"
+#include "blueprint/connection.h"
+#include "blueprint/object.h"
+#include "blueprint/space.h"
+#include "blueprint/transform.h"
+
+#include <string>
+
+//programmatic blueprints for tests which need a compiled floor
+namespace BlueprintTest
+{
+    inline Blueprint::Polygon makeRect( double x1, double y1, double x2, double y2 )
+    {
+        Blueprint::Polygon poly;
+        poly.push_back( Blueprint::Point( x1, y1 ) );
+        poly.push_back( Blueprint::Point( x2, y1 ) );
+        poly.push_back( Blueprint::Point( x2, y2 ) );
+        poly.push_back( Blueprint::Point( x1, y2 ) );
+        return poly;
+    }
+
+    inline Blueprint::Space::Ptr addSpace( Blueprint::Site::Ptr pParent, const std::string& strName,
+        const Blueprint::Polygon& contour )
+    {
+        using namespace Blueprint;
+        Space::Ptr pSpace( new Space( pParent, strName ) );
+        pSpace->init();
+        pSpace->getContour()->set( contour );
+        pParent->add( pSpace );
+        return pSpace;
+    }
+
+    inline Blueprint::Object::Ptr addObject( Blueprint::Site::Ptr pParent, const std::string& strName,
+        const Blueprint::Polygon& contour )
+    {
+        using namespace Blueprint;
+        Object::Ptr pObject( new Object( pParent, strName ) );
+        pObject->init();
+        pObject->getContour()->set( contour );
+        pParent->add( pObject );
+        return pObject;
+    }
+
+    inline Blueprint::Connection::Ptr addConnection( Blueprint::Site::Ptr pParent, const std::string& strName,
+        const Blueprint::DiscreteTransform& transform )
+    {
+        using namespace Blueprint;
+        Connection::Ptr pConnection( new Connection( pParent, strName ) );
+        pConnection->init();
+        pConnection->setTransform( transform.toTransform() );
+        pParent->add( pConnection );
+        return pConnection;
+    }
+
+    inline void evaluate( Blueprint::Blueprint::Ptr pBlueprint )
+    {
+        using namespace Blueprint;
+        Site::EvaluationMode mode;
+        mode.bArrangement = true;
+        Site::EvaluationResults results;
+        pBlueprint->evaluate( mode, results );
+    }
+
+    //  +----+
+    //  | b  |
+    //  +-1--+
+    //  | a  |
+    //  +----+
+    inline Blueprint::Blueprint::Ptr makeTwoRooms()
+    {
+        using namespace Blueprint;
+        Blueprint::Blueprint::Ptr pBlueprint( new Blueprint::Blueprint( "test" ) );
+        addSpace( pBlueprint, "a", makeRect( -16, -32, 16, 0 ) );
+        addSpace( pBlueprint, "b", makeRect( -16, 0, 16, 32 ) );
+        addConnection( pBlueprint, "door", DiscreteTransform() );
+        evaluate( pBlueprint );
+        return pBlueprint;
+    }
+}
+
+#endif //BLUEPRINT_TEST_UTILS_18_OCT_2026
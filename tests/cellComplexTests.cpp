@@ -0,0 +1,100 @@
+#include "blueprint/navMesh.h"
+#include "blueprint/binaryIO.h"
+#include "blueprint/cellComplex.h"
+
+#include "navMeshTestUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    using namespace BlueprintTest;
+}
+
+TEST( CellComplex, ConvexCellsCoverMesh )
+{
+    using namespace Blueprint;
+    NavMesh mesh;
+    buildTestMesh( mesh );
+    CellComplex cells( mesh );
+    
+    //three rectangles at best and never more than the triangles
+    ASSERT_GE( cells.getCellCount(), 3U );
+    ASSERT_LT( cells.getCellCount(), mesh.getTriangleCount() );
+    
+    const std::vector< float >& vertices = mesh.getVertices();
+    const std::vector< std::uint32_t >& indices = mesh.getIndices();
+    for( std::size_t t = 0U; t != mesh.getTriangleCount(); ++t )
+    {
+        float fX = 0.0f, fY = 0.0f;
+        for( std::size_t k = 0U; k != 3U; ++k )
+        {
+            fX += vertices[ indices[ t * 3U + k ] * 2U ] / 3.0f;
+            fY += vertices[ indices[ t * 3U + k ] * 2U + 1U ] / 3.0f;
+        }
+        ASSERT_TRUE( cells.findCell( fX, fY ) );
+    }
+    
+    //every turn around a cell is to the left or straight on
+    const std::vector< float >& cellVertices = cells.getVertices();
+    for( std::uint32_t uCell = 0U; uCell != cells.getCellCount(); ++uCell )
+    {
+        const std::uint32_t* pBegin = cells.verticesBegin( uCell );
+        const std::size_t szSize = cells.verticesEnd( uCell ) - pBegin;
+        ASSERT_GE( szSize, 3U );
+        for( std::size_t sz = 0U; sz != szSize; ++sz )
+        {
+            const float* a = &cellVertices[ pBegin[ sz ] * 2U ];
+            const float* b = &cellVertices[ pBegin[ ( sz + 1U ) % szSize ] * 2U ];
+            const float* c = &cellVertices[ pBegin[ ( sz + 2U ) % szSize ] * 2U ];
+            ASSERT_GE( ( b[ 0 ] - a[ 0 ] ) * ( c[ 1 ] - a[ 1 ] ) - ( b[ 1 ] - a[ 1 ] ) * ( c[ 0 ] - a[ 0 ] ), 0.0f );
+        }
+    }
+    
+    //adjacency is symmetric
+    for( std::uint32_t uCell = 0U; uCell != cells.getCellCount(); ++uCell )
+    {
+        for( const std::uint32_t* p = cells.neighboursBegin( uCell ); p != cells.neighboursEnd( uCell ); ++p )
+        {
+            if( *p != CellComplex::NO_CELL )
+                ASSERT_NE( std::find( cells.neighboursBegin( *p ), cells.neighboursEnd( *p ), uCell ), 
+                    cells.neighboursEnd( *p ) );
+        }
+    }
+    
+    ASSERT_FALSE( cells.findCell( 1.5f, 1.5f ) );
+    ASSERT_FALSE( cells.isStraightReachable( 0.5f, 2.5f, 2.5f, 2.5f ) );
+    ASSERT_TRUE( cells.isStraightReachable( 0.5f, 2.5f, 0.5f, 2.4f ) );
+    
+    std::stringstream ss;
+    cells.save( ss );
+    CellComplex loaded;
+    loaded.load( ss );
+    ASSERT_EQ( loaded.getCellCount(), cells.getCellCount() );
+    ASSERT_EQ( *loaded.findCell( 2.5f, 2.5f ), *cells.findCell( 2.5f, 2.5f ) );
+}
+
+TEST( CellComplex, RejectsOverlappingCells )
+{
+    using namespace Blueprint;
+    
+    //two triangles over four vertices whose second cell starts before the first ends
+    std::stringstream ss;
+    writeUInt32( ss, 4U );
+    writeUInt32( ss, 2U );
+    writeUInt32( ss, 6U );
+    for( float f : { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f } )
+        writeFloat( ss, f );
+    for( std::uint32_t uStart : { 0U, 2U, 6U } )
+        writeUInt32( ss, uStart );
+    for( std::uint32_t uVertex : { 0U, 1U, 2U, 0U, 2U, 3U } )
+        writeUInt32( ss, uVertex );
+    for( std::uint32_t uNeighbour : { CellComplex::NO_CELL, CellComplex::NO_CELL, 1U, 0U, CellComplex::NO_CELL, CellComplex::NO_CELL } )
+        writeUInt32( ss, uNeighbour );
+    CellComplex cells;
+    ASSERT_THROW( cells.load( ss ), std::exception );
+}
@@ -0,0 +1,74 @@
+#include "blueprint/clearance.h"
+#include "blueprint/binaryIO.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    //floor like bitmap with a zero border, an obstacle and an isolated zero pixel
+    Blueprint::NavBitmap makeTestBitmap()
+    {
+        static const unsigned int WIDTH = 13U, HEIGHT = 9U;
+        Blueprint::NavBitmap bitmap( WIDTH, HEIGHT );
+        unsigned char* pPixels = bitmap.get();
+        for( unsigned int y = 1U; y + 1U < HEIGHT; ++y )
+            for( unsigned int x = 1U; x + 1U < WIDTH; ++x )
+                pPixels[ y * bitmap.getStride() + x ] = 255u;
+        for( unsigned int y = 3U; y != 5U; ++y )
+            for( unsigned int x = 7U; x != 10U; ++x )
+                pPixels[ y * bitmap.getStride() + x ] = 0u;
+        pPixels[ 6U * bitmap.getStride() + 3U ] = 0u;
+        return bitmap;
+    }
+}
+
+TEST( ClearanceField, ExactSquaredDistances )
+{
+    using namespace Blueprint;
+    const NavBitmap bitmap = makeTestBitmap();
+
+    std::vector< float > distances;
+    ClearanceField::calculateSquaredDistances( bitmap, distances );
+    ASSERT_EQ( distances.size(), bitmap.getWidth() * bitmap.getHeight() );
+
+    //brute force over every zero pixel
+    for( unsigned int y = 0U; y != bitmap.getHeight(); ++y )
+    {
+        for( unsigned int x = 0U; x != bitmap.getWidth(); ++x )
+        {
+            unsigned int uiExpected = std::numeric_limits< unsigned int >::max();
+            for( unsigned int v = 0U; v != bitmap.getHeight(); ++v )
+            {
+                for( unsigned int u = 0U; u != bitmap.getWidth(); ++u )
+                {
+                    if( !*bitmap.getAt( u, v ) )
+                    {
+                        const int dx = static_cast< int >( u ) - static_cast< int >( x );
+                        const int dy = static_cast< int >( v ) - static_cast< int >( y );
+                        uiExpected = std::min( uiExpected, static_cast< unsigned int >( dx * dx + dy * dy ) );
+                    }
+                }
+            }
+            ASSERT_EQ( distances[ y * bitmap.getWidth() + x ], static_cast< float >( uiExpected ) );
+        }
+    }
+}
+
+TEST( ClearanceField, RejectsSizeBeyondData )
+{
+    using namespace Blueprint;
+    std::stringstream ss;
+    writeUInt32( ss, 0x10000U );
+    writeUInt32( ss, 0x10000U );
+    writeFloat( ss, 0.0f );
+    writeFloat( ss, 0.0f );
+    writeFloat( ss, 1.0f );
+    writeFloat( ss, 0.0f );
+    ClearanceField clearance;
+    ASSERT_THROW( clearance.load( ss ), std::exception );
+}
@@ -0,0 +1,99 @@
+#include "blueprint/cgalSettings.h"
+#include "blueprint/clipperUtils.h"
+#include "blueprint/offsetCache.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    //axis aligned room shapes on the half unit grid
+    std::vector< Blueprint::Polygon > buildRooms()
+    {
+        using namespace Blueprint;
+        std::vector< Polygon > rooms;
+        for( int i = 0; i != 8; ++i )
+        {
+            const double w = 12.0 + i * 3.0, h = 10.0 + i * 2.0;
+            
+            Polygon rect;
+            rect.push_back( Point( 0.0, 0.0 ) );
+            rect.push_back( Point( w, 0.0 ) );
+            rect.push_back( Point( w, h ) );
+            rect.push_back( Point( 0.0, h ) );
+            rooms.push_back( rect );
+            
+            Polygon ell;
+            ell.push_back( Point( 0.0, 0.0 ) );
+            ell.push_back( Point( w, 0.0 ) );
+            ell.push_back( Point( w, h * 0.5 ) );
+            ell.push_back( Point( w * 0.5, h * 0.5 ) );
+            ell.push_back( Point( w * 0.5, h ) );
+            ell.push_back( Point( 0.0, h ) );
+            rooms.push_back( ell );
+        }
+        return rooms;
+    }
+    
+    //the vertices regardless of which one the polygon starts from
+    std::vector< Blueprint::Point > getVertexSet( const Blueprint::Polygon& polygon )
+    {
+        std::vector< Blueprint::Point > vertices( polygon.vertices_begin(), polygon.vertices_end() );
+        std::sort( vertices.begin(), vertices.end() );
+        return vertices;
+    }
+}
+
+TEST( Clipper, OffsetsMatchStraightSkeleton )
+{
+    using namespace Blueprint;
+    const Kernel::FT wallWidth = 2;
+    for( const Polygon& room : buildRooms() )
+    {
+        const OffsetCache::Offsets exact = OffsetCache::calculate( room, wallWidth );
+        OffsetCache::Offsets offsets;
+        ASSERT_TRUE( Clipper::calculateOffsets( room, wallWidth, offsets ) );
+        ASSERT_TRUE( getVertexSet( offsets.interior ) == getVertexSet( exact.interior ) );
+        ASSERT_TRUE( getVertexSet( offsets.exterior ) == getVertexSet( exact.exterior ) );
+        ASSERT_EQ( offsets.interior.orientation(), exact.interior.orientation() );
+        ASSERT_EQ( offsets.exterior.orientation(), exact.exterior.orientation() );
+        ASSERT_EQ( offsets.interior.area(), exact.interior.area() );
+        ASSERT_EQ( offsets.exterior.area(), exact.exterior.area() );
+    }
+    
+    //anything off the grid or not axis aligned is left to the kernel
+    Polygon triangle;
+    triangle.push_back( Point( 0.0, 0.0 ) );
+    triangle.push_back( Point( 10.0, 0.0 ) );
+    triangle.push_back( Point( 0.0, 10.0 ) );
+    OffsetCache::Offsets offsets;
+    ASSERT_FALSE( Clipper::calculateOffsets( triangle, wallWidth, offsets ) );
+}
+
+TEST( Clipper, ClipUnionMatchesKernel )
+{
+    using namespace Blueprint;
+    std::vector< Polygon > exteriors;
+    for( int i = 0; i != 4; ++i )
+    {
+        Polygon rect;
+        rect.push_back( Point( i * 6.0 - 2.0, -2.0 ) );
+        rect.push_back( Point( i * 6.0 + 8.0, -2.0 ) );
+        rect.push_back( Point( i * 6.0 + 8.0, 8.5 ) );
+        rect.push_back( Point( i * 6.0 - 2.0, 8.5 ) );
+        exteriors.push_back( rect );
+    }
+    Polygon interior;
+    interior.push_back( Point( 0.0, 0.0 ) );
+    interior.push_back( Point( 30.0, 0.0 ) );
+    interior.push_back( Point( 30.0, 30.0 ) );
+    interior.push_back( Point( 0.0, 30.0 ) );
+    
+    std::vector< Polygon > results;
+    ASSERT_TRUE( Clipper::clipUnion( exteriors, interior, results ) );
+    ASSERT_EQ( results.size(), 1U );
+    ASSERT_EQ( results.front().area(), Kernel::FT( 26.0 * 8.5 ) );
+    ASSERT_TRUE( results.front().is_counterclockwise_oriented() );
+}
@@ -0,0 +1,138 @@
+#include "blueprint/compilation.h"
+
+#include "blueprintTestUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    using namespace BlueprintTest;
+    
+    //invariants of the compiled arrangement that do not depend on how edges happen to be split
+    struct Summary
+    {
+        std::vector< double > faceAreas;
+        double fDoorStepLength = 0.0;
+        double fEdgeLength = 0.0;
+    };
+
+    Summary summarise( const Blueprint::Arrangement& arr )
+    {
+        using namespace Blueprint;
+        Summary summary;
+        for( Arrangement::Face_const_iterator
+            i = arr.faces_begin(), iEnd = arr.faces_end(); i != iEnd; ++i )
+        {
+            if( i->is_unbounded() )
+                continue;
+            Polygon poly;
+            Arrangement::Ccb_halfedge_const_circulator iter = i->outer_ccb(), start = iter;
+            do
+            {
+                poly.push_back( iter->source()->point() );
+                ++iter;
+            } while( iter != start );
+            summary.faceAreas.push_back( std::abs( CGAL::to_double( poly.area() ) ) );
+        }
+        std::sort( summary.faceAreas.begin(), summary.faceAreas.end() );
+
+        for( Arrangement::Edge_const_iterator
+            i = arr.edges_begin(), iEnd = arr.edges_end(); i != iEnd; ++i )
+        {
+            const double fLength = std::sqrt( CGAL::to_double(
+                CGAL::squared_distance( i->source()->point(), i->target()->point() ) ) );
+            summary.fEdgeLength += fLength;
+            if( i->data().get() )
+                summary.fDoorStepLength += fLength;
+        }
+        return summary;
+    }
+
+    void expectEqual( const Summary& full, const Summary& incremental )
+    {
+        ASSERT_EQ( full.faceAreas.size(), incremental.faceAreas.size() );
+        for( std::size_t i = 0U; i != full.faceAreas.size(); ++i )
+            ASSERT_NEAR( full.faceAreas[ i ], incremental.faceAreas[ i ], 1e-6 );
+        ASSERT_NEAR( full.fDoorStepLength, incremental.fDoorStepLength, 1e-6 );
+        ASSERT_NEAR( full.fEdgeLength, incremental.fEdgeLength, 1e-6 );
+    }
+
+    void compareWithFullCompile( Blueprint::IncrementalCompiler& compiler, Blueprint::Blueprint::Ptr pBlueprint )
+    {
+        using namespace Blueprint;
+        evaluate( pBlueprint );
+
+        const Summary full = summarise( Compilation( pBlueprint ).getArrangement() );
+        const Summary incremental = summarise( Compilation( compiler, pBlueprint ).getArrangement() );
+        ASSERT_GT( full.fDoorStepLength, 0.0 );
+        expectEqual( full, incremental );
+    }
+}
+
+TEST( IncrementalCompiler, MatchesFullCompile )
+{
+    using namespace Blueprint;
+
+    //  +----+
+    //  | B  |
+    //  +-1--+----+
+    //  | A  2 C  |
+    //  +----+----+
+    Blueprint::Blueprint::Ptr pBlueprint( new Blueprint::Blueprint( "test" ) );
+    addSpace( pBlueprint, "a", makeRect( -16, -32, 16, 0 ) );
+    Space::Ptr pB = addSpace( pBlueprint, "b", makeRect( -16, 0, 16, 32 ) );
+    addSpace( pBlueprint, "c", makeRect( 16, -32, 48, 0 ) );
+    Connection::Ptr pFirst = addConnection( pBlueprint, "first", DiscreteTransform() );
+    Connection::Ptr pSecond = addConnection( pBlueprint, "second",
+        DiscreteTransform::translation( 32, -32 ) * DiscreteTransform::quarterTurns( 1 ) );
+
+    IncrementalCompiler compiler;
+    compareWithFullCompile( compiler, pBlueprint );
+
+    //growing b away from both connections leaves them in place
+    pB->getContour()->set( makeRect( -16, 0, 16, 40 ) );
+    compareWithFullCompile( compiler, pBlueprint );
+    ASSERT_EQ( compiler.getStatistics().szConnectionsCut, 0U );
+    ASSERT_GT( compiler.getStatistics().szSitesUnchanged, 0U );
+
+    //moving a connection along its wall recuts only that connection
+    pFirst->setTransform( DiscreteTransform::translation( 8, 0 ).toTransform() );
+    compareWithFullCompile( compiler, pBlueprint );
+    ASSERT_EQ( compiler.getStatistics().szConnectionsCut, 1U );
+
+    //removing a connection restores the wall it cut
+    pBlueprint->remove( pSecond );
+    compareWithFullCompile( compiler, pBlueprint );
+    
+    //replacing the walls a patch restores must not leave it owned by the new walls
+    pB->getContour()->set( makeRect( -16, 0, 16, 32 ) );
+    compareWithFullCompile( compiler, pBlueprint );
+    pB->getContour()->set( makeRect( -16, 0, 16, 40 ) );
+    compareWithFullCompile( compiler, pBlueprint );
+}
+
+TEST( IncrementalCompiler, CompilationOutlivesUpdate )
+{
+    using namespace Blueprint;
+
+    Blueprint::Blueprint::Ptr pBlueprint = makeTwoRooms();
+    Space::Ptr pB = boost::dynamic_pointer_cast< Space >( pBlueprint->getSites()[ 1 ] );
+    ASSERT_TRUE( pB );
+    
+    IncrementalCompiler compiler;
+    const Compilation before( compiler, pBlueprint );
+    const Summary summary = summarise( before.getArrangement() );
+    
+    pB->getContour()->set( makeRect( -16, 0, 16, 40 ) );
+    evaluate( pBlueprint );
+    const Compilation after( compiler, pBlueprint );
+    
+    //the earlier compilation keeps its own arrangement
+    expectEqual( summary, summarise( before.getArrangement() ) );
+    ASSERT_NE( &before.getArrangement(), &compiler.getArrangement() );
+    ASSERT_GT( summarise( after.getArrangement() ).fEdgeLength, summary.fEdgeLength );
+}
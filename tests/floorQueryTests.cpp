@@ -0,0 +1,206 @@
+#include "blueprint/visibility.h"
+#include "blueprint/floorQuery.h"
+
+#include "blueprintTestUtils.h"
+
+#include <CGAL/Arr_observer.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    using namespace BlueprintTest;
+
+    //the original queries inserted into the floor arrangement and relied on the floor
+    //flag of the face being copied to both faces whenever it was split
+    class FloorFlagObserver : public CGAL::Arr_observer< Blueprint::Arrangement >
+    {
+    public:
+        FloorFlagObserver( Blueprint::Arrangement& arr )
+            :   CGAL::Arr_observer< Blueprint::Arrangement >( arr )
+        {
+        }
+
+        virtual void after_split_face( Blueprint::Arrangement::Face_handle f,
+            Blueprint::Arrangement::Face_handle new_f, bool )
+        {
+            new_f->set_data( f->data() );
+        }
+    };
+
+    //copy of the floor with only the floor face flagged
+    void copyFloor( const Blueprint::FloorAnalysis& floor, Blueprint::Arrangement& arr )
+    {
+        using namespace Blueprint;
+        arr = floor.getFloor();
+        for( Arrangement::Face_iterator i = arr.faces_begin(); i != arr.faces_end(); ++i )
+            i->set_data( DefaultedBool( false ) );
+        Arrangement::Hole_iterator iHole = arr.unbounded_face()->holes_begin();
+        ASSERT_TRUE( iHole != arr.unbounded_face()->holes_end() );
+        Arrangement::Ccb_halfedge_circulator iter = *iHole;
+        iter->twin()->face()->set_data( DefaultedBool( true ) );
+    }
+
+    bool isFloorEdge( Blueprint::Arrangement::Halfedge_const_handle h )
+    {
+        return h->face()->data().get() || h->twin()->face()->data().get();
+    }
+
+    bool isWithinFloorByInsertion( const Blueprint::FloorAnalysis& floor, const Blueprint::Segment& segment )
+    {
+        using namespace Blueprint;
+        Arrangement arr;
+        copyFloor( floor, arr );
+        FloorFlagObserver observer( arr );
+
+        Curve_handle hCurve = CGAL::insert( arr, Curve( segment.source(), segment.target() ) );
+        for( auto i = arr.induced_edges_begin( hCurve ); i != arr.induced_edges_end( hCurve ); ++i )
+        {
+            if( !isFloorEdge( *i ) )
+                return false;
+        }
+        return true;
+    }
+
+    //inserts the line through the segment clipped to beyond the floor bounds and walks
+    //its edges outwards from the segment end points while they remain on the floor
+    void extendByInsertion( const Blueprint::FloorAnalysis& floor, const Blueprint::Segment& segment,
+        Blueprint::Point& ptStart, Blueprint::Point& ptEnd )
+    {
+        using namespace Blueprint;
+        Arrangement arr;
+        copyFloor( floor, arr );
+        FloorFlagObserver observer( arr );
+
+        const Kernel::Iso_rectangle_2 bounds( Point( -100, -100 ), Point( 100, 100 ) );
+        const auto result = CGAL::intersection( bounds, Kernel::Line_2( segment.source(), segment.target() ) );
+        ASSERT_TRUE( static_cast< bool >( result ) );
+        const Segment* pLine = boost::get< Segment >( &result.get() );
+        ASSERT_TRUE( pLine );
+
+        CGAL::insert( arr, Curve( segment.source(), segment.target() ) );
+        Curve_handle hLine = CGAL::insert( arr, Curve( pLine->source(), pLine->target() ) );
+
+        //order the vertices along the segment direction
+        const Vector direction = segment.to_vector();
+        auto position = [ &segment, &direction ]( const Point& pt ){ return ( pt - segment.source() ) * direction; };
+
+        struct Piece
+        {
+            Point ptFirst, ptSecond;
+            bool bFloor;
+        };
+        std::vector< Piece > pieces;
+        for( auto i = arr.induced_edges_begin( hLine ); i != arr.induced_edges_end( hLine ); ++i )
+        {
+            Arrangement::Halfedge_const_handle h = *i;
+            Piece piece{ h->source()->point(), h->target()->point(), isFloorEdge( h ) };
+            if( position( piece.ptSecond ) < position( piece.ptFirst ) )
+                std::swap( piece.ptFirst, piece.ptSecond );
+            pieces.push_back( piece );
+        }
+        std::sort( pieces.begin(), pieces.end(), [ &position ]( const Piece& left, const Piece& right )
+            { return position( left.ptFirst ) < position( right.ptFirst ); } );
+
+        std::size_t szStart = pieces.size(), szEnd = pieces.size();
+        for( std::size_t sz = 0U; sz != pieces.size(); ++sz )
+        {
+            if( pieces[ sz ].ptFirst == segment.source() )
+                szStart = sz;
+            if( pieces[ sz ].ptSecond == segment.target() )
+                szEnd = sz;
+        }
+        ASSERT_LT( szStart, pieces.size() );
+        ASSERT_LT( szEnd, pieces.size() );
+
+        while( szStart != 0U && pieces[ szStart - 1U ].bFloor )
+            --szStart;
+        while( szEnd + 1U != pieces.size() && pieces[ szEnd + 1U ].bFloor )
+            ++szEnd;
+        ptStart = pieces[ szStart ].ptFirst;
+        ptEnd   = pieces[ szEnd ].ptSecond;
+    }
+
+    //  +----+
+    //  |    |
+    //  |    +----+
+    //  | [] |    |
+    //  +----+----+
+    std::unique_ptr< Blueprint::FloorAnalysis > makeFloor()
+    {
+        using namespace Blueprint;
+        Polygon outer;
+        outer.push_back( Point( 0, 0 ) );
+        outer.push_back( Point( 20, 0 ) );
+        outer.push_back( Point( 20, 10 ) );
+        outer.push_back( Point( 10, 10 ) );
+        outer.push_back( Point( 10, 20 ) );
+        outer.push_back( Point( 0, 20 ) );
+        const Polygon pillar = makeRect( 4, 4, 6, 6 );
+        return std::unique_ptr< FloorAnalysis >(
+            new FloorAnalysis( Polygon_with_holes( outer, &pillar, &pillar + 1 ) ) );
+    }
+
+    std::vector< Blueprint::Point > getTestPoints()
+    {
+        using namespace Blueprint;
+        return
+        {
+            //floor and pillar corners
+            Point( 0, 0 ), Point( 20, 0 ), Point( 20, 10 ), Point( 10, 10 ), Point( 10, 20 ), Point( 0, 20 ),
+            Point( 4, 4 ), Point( 6, 4 ), Point( 6, 6 ), Point( 4, 6 ),
+            //within the floor, on a wall and in the notch
+            Point( 2, 2 ), Point( 15, 5 ), Point( 5, 15 ), Point( 8, 8 ), Point( 10, 5 ), Point( 15, 15 )
+        };
+    }
+}
+
+TEST( FloorQuery, ContainmentMatchesInsertion )
+{
+    using namespace Blueprint;
+    const std::unique_ptr< FloorAnalysis > pFloor = makeFloor();
+    const FloorQuery& query = pFloor->getQuery();
+
+    const std::vector< Point > points = getTestPoints();
+    std::size_t szWithin = 0U, szOutside = 0U;
+    for( std::size_t i = 0U; i != points.size(); ++i )
+    {
+        for( std::size_t j = i + 1U; j != points.size(); ++j )
+        {
+            const Segment segment( points[ i ], points[ j ] );
+            const bool bExpected = isWithinFloorByInsertion( *pFloor, segment );
+            ASSERT_EQ( query.isWithinFloor( segment ), bExpected ) << segment;
+            ++( bExpected ? szWithin : szOutside );
+        }
+    }
+    ASSERT_GT( szWithin, 0U );
+    ASSERT_GT( szOutside, 0U );
+}
+
+TEST( FloorQuery, ExtensionMatchesInsertion )
+{
+    using namespace Blueprint;
+    const std::unique_ptr< FloorAnalysis > pFloor = makeFloor();
+    const FloorQuery& query = pFloor->getQuery();
+
+    const std::vector< Point > points = getTestPoints();
+    for( std::size_t i = 0U; i != points.size(); ++i )
+    {
+        for( std::size_t j = 0U; j != points.size(); ++j )
+        {
+            const Segment segment( points[ i ], points[ j ] );
+            if( i == j || !query.isWithinFloor( segment ) )
+                continue;
+
+            Point ptStart, ptEnd, ptExpectedStart, ptExpectedEnd;
+            query.extendWithinFloor( segment, ptStart, ptEnd );
+            extendByInsertion( *pFloor, segment, ptExpectedStart, ptExpectedEnd );
+            ASSERT_EQ( ptStart, ptExpectedStart ) << segment;
+            ASSERT_EQ( ptEnd, ptExpectedEnd ) << segment;
+        }
+    }
+}
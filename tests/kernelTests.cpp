@@ -0,0 +1,204 @@
+
+#include "blueprint/cgalSettings.h"
+
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <CGAL/Filtered_kernel.h>
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/Exact_rational.h>
+#include <CGAL/Arr_segment_traits_2.h>
+#include <CGAL/Arrangement_2.h>
+#include <CGAL/Polygon_2.h>
+#include <CGAL/create_offset_polygons_2.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+#include <tuple>
+#include <algorithm>
+
+namespace
+{
+    //the alternative kernel named explicitly so the comparison holds whichever
+    //kernel the build selects for Blueprint::Kernel
+    using RationalKernel = CGAL::Filtered_kernel< CGAL::Simple_cartesian< CGAL::Exact_rational > >;
+    using EpeckKernel = CGAL::Exact_predicates_exact_constructions_kernel;
+    
+    //quantised input similar to what the blueprint produces - integer contours with
+    //connection midpoints on halves
+    struct TestSegment
+    {
+        double x1, y1, x2, y2;
+    };
+
+    std::vector< TestSegment > getQuantisedInput()
+    {
+        std::vector< TestSegment > segments;
+        auto addRect = [ &segments ]( double x1, double y1, double x2, double y2 )
+        {
+            segments.push_back( { x1, y1, x2, y1 } );
+            segments.push_back( { x2, y1, x2, y2 } );
+            segments.push_back( { x2, y2, x1, y2 } );
+            segments.push_back( { x1, y2, x1, y1 } );
+        };
+        addRect(  0.0,  0.0, 10.0, 10.0 );
+        addRect(  5.0,  5.0, 15.0, 15.0 );
+        addRect(  9.5,  2.5, 20.0,  7.5 );
+        addRect( -3.0, -3.0,  3.0,  3.0 );
+        
+        //diagonals produce non-grid intersections
+        segments.push_back( { 0.0, 0.0, 15.0, 15.0 } );
+        segments.push_back( { 0.0, 10.0, 20.0, 2.5 } );
+        segments.push_back( { -3.0, 3.0, 9.5, 7.5 } );
+        return segments;
+    }
+
+    using VertexKey = std::tuple< double, double, std::size_t >;
+
+    struct ArrangementSummary
+    {
+        std::size_t szVertices, szEdges, szFaces;
+        std::vector< VertexKey > vertices;
+    };
+
+    template< typename TArrangement >
+    ArrangementSummary summarise( const TArrangement& arr )
+    {
+        ArrangementSummary summary;
+        summary.szVertices  = arr.number_of_vertices();
+        summary.szEdges     = arr.number_of_edges();
+        summary.szFaces     = arr.number_of_faces();
+        for( auto i = arr.vertices_begin(); i != arr.vertices_end(); ++i )
+        {
+            summary.vertices.push_back( VertexKey( 
+                CGAL::to_double( i->point().x() ), 
+                CGAL::to_double( i->point().y() ), 
+                i->degree() ) );
+        }
+        std::sort( summary.vertices.begin(), summary.vertices.end() );
+        return summary;
+    }
+    
+    void expectEqual( const ArrangementSummary& expected, const ArrangementSummary& actual )
+    {
+        ASSERT_EQ( expected.szVertices, actual.szVertices );
+        ASSERT_EQ( expected.szEdges,    actual.szEdges );
+        ASSERT_EQ( expected.szFaces,    actual.szFaces );
+        ASSERT_EQ( expected.vertices,   actual.vertices );
+    }
+
+    template< typename TKernel >
+    ArrangementSummary buildArrangement( const std::vector< TestSegment >& input )
+    {
+        using Traits        = CGAL::Arr_segment_traits_2< TKernel >;
+        using Arrangement   = CGAL::Arrangement_2< Traits >;
+        using Point         = typename TKernel::Point_2;
+        using Segment       = typename Traits::Curve_2;
+
+        std::vector< Segment > segments;
+        for( const TestSegment& s : input )
+        {
+            segments.push_back( Segment( Point( s.x1, s.y1 ), Point( s.x2, s.y2 ) ) );
+        }
+
+        Arrangement arr;
+        CGAL::insert( arr, segments.begin(), segments.end() );
+        return summarise( arr );
+    }
+    
+    //space contours as the editor produces them
+    std::vector< std::vector< std::pair< double, double > > > getContours()
+    {
+        return
+        {
+            //rooms sharing walls
+            { { -16, -32 }, { 16, -32 }, { 16, 0 }, { -16, 0 } },
+            { { -16, 0 }, { 16, 0 }, { 16, 32 }, { -16, 32 } },
+            //l shaped corridor with a half unit step
+            { { 16, -32 }, { 48, -32 }, { 48, 16.5 }, { 32, 16.5 }, { 32, 0 }, { 16, 0 } },
+            //u shaped room whose skeleton has reflex events
+            { { 48, -8 }, { 72, -8 }, { 72, 16 }, { 66, 16 }, { 66, 0 }, { 54, 0 }, { 54, 16 }, { 48, 16 } }
+        };
+    }
+    
+    //the contour, interior and exterior wall curves of every space computed the way
+    //the offset cache computes them, followed by connection segments across the walls
+    template< typename TKernel >
+    ArrangementSummary compileContours()
+    {
+        using Traits        = CGAL::Arr_segment_traits_2< TKernel >;
+        using Arrangement   = CGAL::Arrangement_2< Traits >;
+        using Point         = typename TKernel::Point_2;
+        using Segment       = typename Traits::Curve_2;
+        using Polygon       = CGAL::Polygon_2< TKernel >;
+        using PolygonPtrVector = std::vector< boost::shared_ptr< Polygon > >;
+        
+        const typename TKernel::FT wallWidth = 2;
+        
+        std::vector< Segment > segments;
+        auto addPolygon = [ &segments ]( const Polygon& poly )
+        {
+            for( auto i = poly.edges_begin(); i != poly.edges_end(); ++i )
+                segments.push_back( Segment( i->source(), i->target() ) );
+        };
+        for( const auto& contour : getContours() )
+        {
+            Polygon poly;
+            for( const auto& pt : contour )
+                poly.push_back( Point( pt.first, pt.second ) );
+            addPolygon( poly );
+            
+            PolygonPtrVector interior = 
+                CGAL::create_interior_skeleton_and_offset_polygons_2
+                    < typename TKernel::FT, Polygon, TKernel, TKernel >
+                    ( wallWidth, poly, ( TKernel() ), ( TKernel() ) );
+            EXPECT_FALSE( interior.empty() );
+            if( !interior.empty() )
+                addPolygon( *interior.front() );
+            
+            PolygonPtrVector exterior = 
+                CGAL::create_exterior_skeleton_and_offset_polygons_2
+                    < typename TKernel::FT, Polygon, TKernel, TKernel >
+                    ( wallWidth, poly, ( TKernel() ), ( TKernel() ) );
+            EXPECT_FALSE( exterior.empty() );
+            if( !exterior.empty() )
+                addPolygon( *exterior.back() );
+        }
+        
+        segments.push_back( Segment( Point( -3, -8 ), Point( -3, 8 ) ) );
+        segments.push_back( Segment( Point(  3, -8 ), Point(  3, 8 ) ) );
+        segments.push_back( Segment( Point( 8, -19 ), Point( 24, -19 ) ) );
+        segments.push_back( Segment( Point( 8, -13 ), Point( 24, -13 ) ) );
+        
+        Arrangement arr;
+        CGAL::insert( arr, segments.begin(), segments.end() );
+        return summarise( arr );
+    }
+}
+
+TEST( KernelTests, ArrangementMatchesEpeck )
+{
+    const std::vector< TestSegment > input = getQuantisedInput();
+    expectEqual( buildArrangement< EpeckKernel >( input ), buildArrangement< RationalKernel >( input ) );
+}
+
+TEST( KernelTests, CompiledContoursMatchEpeck )
+{
+    expectEqual( compileContours< EpeckKernel >(), compileContours< RationalKernel >() );
+}
+
+TEST( KernelTests, QuantisedConstructionsAreExact )
+{
+    using Kernel = RationalKernel;
+    using Point = Kernel::Point_2;
+    using Segment = Kernel::Segment_2;
+
+    //intersection of two diagonals through halves must land exactly on the expected point
+    const Segment s1( Point( 0.0, 0.0 ), Point( 9.5, 9.5 ) );
+    const Segment s2( Point( 0.0, 9.5 ), Point( 9.5, 0.0 ) );
+
+    const auto result = CGAL::intersection( s1, s2 );
+    ASSERT_TRUE( result );
+    const Point* pPoint = boost::get< Point >( &*result );
+    ASSERT_TRUE( pPoint );
+    ASSERT_TRUE( *pPoint == Point( 4.75, 4.75 ) );
+}
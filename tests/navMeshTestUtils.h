@@ -0,0 +1,61 @@
+#ifndef NAV_MESH_TEST_UTILS_18_OCT_2026
+#define NAV_MESH_TEST_UTILS_18_OCT_2026
+
+#include "blueprint/navMesh.h"
+#include "blueprint/binaryIO.h"
+
+#include <sstream>
+#include <vector>
+
+namespace BlueprintTest
+{
+    //3x3 grid of unit squares with the middle column blocked above the bottom row
+    inline void buildTestMesh( Blueprint::NavMesh& mesh )
+    {
+        using namespace Blueprint;
+        std::vector< float > vertices;
+        for( int y = 0; y != 4; ++y )
+        {
+            for( int x = 0; x != 4; ++x )
+            {
+                vertices.push_back( static_cast< float >( x ) );
+                vertices.push_back( static_cast< float >( y ) );
+            }
+        }
+        
+        std::vector< std::uint32_t > indices;
+        for( int y = 0; y != 3; ++y )
+        {
+            for( int x = 0; x != 3; ++x )
+            {
+                if( x == 1 && y != 0 )
+                    continue;
+                const std::uint32_t a = y * 4 + x, b = a + 1U, c = a + 5U, d = a + 4U;
+                indices.insert( indices.end(), { a, b, c, a, c, d } );
+            }
+        }
+        
+        const std::size_t szTriangles = indices.size() / 3U;
+        std::vector< std::uint32_t > adjacency( indices.size(), NavMesh::NO_TRIANGLE );
+        for( std::size_t t = 0U; t != szTriangles; ++t )
+            for( std::size_t k = 0U; k != 3U; ++k )
+                for( std::size_t u = 0U; u != szTriangles; ++u )
+                    for( std::size_t j = 0U; j != 3U; ++j )
+                        if( indices[ u * 3U + j ] == indices[ t * 3U + ( k + 1U ) % 3U ] &&
+                            indices[ u * 3U + ( j + 1U ) % 3U ] == indices[ t * 3U + k ] )
+                            adjacency[ t * 3U + k ] = static_cast< std::uint32_t >( u );
+        
+        std::stringstream ss;
+        writeUInt32( ss, static_cast< std::uint32_t >( vertices.size() / 2U ) );
+        writeUInt32( ss, static_cast< std::uint32_t >( szTriangles ) );
+        for( float f : vertices )
+            writeFloat( ss, f );
+        for( std::uint32_t index : indices )
+            writeUInt32( ss, index );
+        for( std::uint32_t neighbour : adjacency )
+            writeUInt32( ss, neighbour );
+        mesh.load( ss );
+    }
+}
+
+#endif //NAV_MESH_TEST_UTILS_18_OCT_2026
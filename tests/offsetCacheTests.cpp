@@ -0,0 +1,83 @@
+#include "blueprint/cgalSettings.h"
+#include "blueprint/offsetCache.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    //the vertices regardless of which one the polygon starts from
+    std::vector< Blueprint::Point > getVertexSet( const Blueprint::Polygon& polygon )
+    {
+        std::vector< Blueprint::Point > vertices( polygon.vertices_begin(), polygon.vertices_end() );
+        std::sort( vertices.begin(), vertices.end() );
+        return vertices;
+    }
+    
+    void expectSameOffsets( const Blueprint::OffsetCache::Offsets& expected, const Blueprint::OffsetCache::Offsets& actual )
+    {
+        ASSERT_FALSE( expected.interior.is_empty() );
+        ASSERT_FALSE( expected.exterior.is_empty() );
+        ASSERT_TRUE( getVertexSet( expected.interior ) == getVertexSet( actual.interior ) );
+        ASSERT_TRUE( getVertexSet( expected.exterior ) == getVertexSet( actual.exterior ) );
+        ASSERT_EQ( expected.interior.orientation(), actual.interior.orientation() );
+        ASSERT_EQ( expected.exterior.orientation(), actual.exterior.orientation() );
+    }
+}
+
+TEST( OffsetCache, TranslatedCopiesHit )
+{
+    using namespace Blueprint;
+    const Kernel::FT wallWidth = 1;
+    
+    //an ell with a chamfered corner
+    Polygon room;
+    room.push_back( Point( 0.0, 0.0 ) );
+    room.push_back( Point( 16.0, 0.0 ) );
+    room.push_back( Point( 16.0, 6.0 ) );
+    room.push_back( Point( 8.0, 6.0 ) );
+    room.push_back( Point( 8.0, 10.0 ) );
+    room.push_back( Point( 3.0, 12.0 ) );
+    room.push_back( Point( 0.0, 12.0 ) );
+    
+    OffsetCache cache;
+    expectSameOffsets( OffsetCache::calculate( room, wallWidth ), cache.get( room, wallWidth ) );
+    ASSERT_EQ( cache.getMisses(), 1U );
+    ASSERT_EQ( cache.getHits(), 0U );
+    
+    //translated copies, including one off the grid, hit the same entry
+    for( const Vector& offset : { Vector( 100.5, -37.25 ), Vector( Kernel::FT( 1 ) / 3, Kernel::FT( -2 ) / 7 ) } )
+    {
+        const Polygon moved = CGAL::transform( Transform( CGAL::TRANSLATION, offset ), room );
+        expectSameOffsets( OffsetCache::calculate( moved, wallWidth ), cache.get( moved, wallWidth ) );
+    }
+    ASSERT_EQ( cache.getMisses(), 1U );
+    ASSERT_EQ( cache.getHits(), 2U );
+    
+    //as does the same contour starting from another vertex
+    {
+        Polygon rotated;
+        for( std::size_t sz = 0U; sz != room.size(); ++sz )
+            rotated.push_back( room[ ( sz + 3U ) % room.size() ] );
+        expectSameOffsets( OffsetCache::calculate( rotated, wallWidth ), cache.get( rotated, wallWidth ) );
+    }
+    ASSERT_EQ( cache.getMisses(), 1U );
+    ASSERT_EQ( cache.getHits(), 3U );
+    ASSERT_EQ( cache.size(), 1U );
+    
+    //while another wall width or a scaled copy miss
+    expectSameOffsets( OffsetCache::calculate( room, wallWidth * 2 ), cache.get( room, wallWidth * 2 ) );
+    {
+        const Polygon scaled = CGAL::transform( Transform( CGAL::SCALING, 2 ), room );
+        expectSameOffsets( OffsetCache::calculate( scaled, wallWidth ), cache.get( scaled, wallWidth ) );
+    }
+    ASSERT_EQ( cache.getMisses(), 3U );
+    ASSERT_EQ( cache.getHits(), 3U );
+    ASSERT_EQ( cache.size(), 3U );
+    
+    cache.clear();
+    ASSERT_EQ( cache.size(), 0U );
+    ASSERT_EQ( cache.getHits(), 0U );
+}
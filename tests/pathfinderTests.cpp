@@ -0,0 +1,73 @@
+#include "blueprint/navMesh.h"
+#include "blueprint/pathfinder.h"
+#include "blueprint/threadPool.h"
+
+#include "navMeshTestUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+    using namespace BlueprintTest;
+}
+
+TEST( Pathfinder, PullsStringAroundObstacle )
+{
+    using namespace Blueprint;
+    NavMesh mesh;
+    buildTestMesh( mesh );
+    
+    Pathfinder pathfinder( mesh );
+    Pathfinder::Scratch scratch( pathfinder );
+    Pathfinder::Path path;
+    
+    ASSERT_TRUE( pathfinder.findPath( { 0.5f, 2.5f }, { 2.5f, 2.5f }, scratch, path ) );
+    ASSERT_EQ( path.size(), 4U );
+    ASSERT_EQ( path[ 1 ].x, 1.0f );
+    ASSERT_EQ( path[ 1 ].y, 1.0f );
+    ASSERT_EQ( path[ 2 ].x, 2.0f );
+    ASSERT_EQ( path[ 2 ].y, 1.0f );
+    
+    //straight line when unobstructed
+    ASSERT_TRUE( pathfinder.findPath( { 0.2f, 0.2f }, { 2.8f, 0.7f }, scratch, path ) );
+    ASSERT_EQ( path.size(), 2U );
+    
+    //off the mesh
+    ASSERT_FALSE( pathfinder.findPath( { 1.5f, 1.5f }, { 2.5f, 0.5f }, scratch, path ) );
+    ASSERT_TRUE( path.empty() );
+}
+
+TEST( Pathfinder, BatchMatchesSingleQueries )
+{
+    using namespace Blueprint;
+    NavMesh mesh;
+    buildTestMesh( mesh );
+    Pathfinder pathfinder( mesh );
+    
+    std::vector< Pathfinder::Query > queries;
+    for( int i = 0; i != 500; ++i )
+    {
+        const float f = static_cast< float >( i % 10 ) * 0.09f + 0.05f;
+        queries.push_back( Pathfinder::Query{ { f, 2.0f + f }, { 2.0f + f, 2.0f + f } } );
+    }
+    
+    ThreadPool pool( 4U );
+    std::vector< Pathfinder::Path > paths;
+    pathfinder.findPaths( pool, queries, paths );
+    ASSERT_EQ( paths.size(), queries.size() );
+    
+    Pathfinder::Scratch scratch( pathfinder );
+    Pathfinder::Path path;
+    for( std::size_t sz = 0U; sz != queries.size(); ++sz )
+    {
+        ASSERT_TRUE( pathfinder.findPath( queries[ sz ].start, queries[ sz ].goal, scratch, path ) );
+        ASSERT_EQ( path.size(), paths[ sz ].size() );
+        for( std::size_t szPoint = 0U; szPoint != path.size(); ++szPoint )
+        {
+            ASSERT_EQ( path[ szPoint ].x, paths[ sz ].at( szPoint ).x );
+            ASSERT_EQ( path[ szPoint ].y, paths[ sz ].at( szPoint ).y );
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include "blueprint/segmentBVH.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    //a closed walk around a comb with teeth ending at coordinates which doubles cannot
+    //represent so the interval filter has to defer to the exact kernel
+    std::vector< Blueprint::Point > getWalk()
+    {
+        using namespace Blueprint;
+        const Kernel::FT third = Kernel::FT( 1 ) / Kernel::FT( 3 );
+        std::vector< Point > walk = { Point( 0, 0 ), Point( 20, 0 ), Point( 20, 10 ) };
+        for( int i = 4; i >= 0; --i )
+        {
+            walk.push_back( Point( Kernel::FT( i * 4 + 3 ), Kernel::FT( 10 ) ) );
+            walk.push_back( Point( Kernel::FT( i * 4 + 2 ) + third, Kernel::FT( 4 ) + third ) );
+            walk.push_back( Point( Kernel::FT( i * 4 + 1 ), Kernel::FT( 10 ) ) );
+        }
+        walk.push_back( Point( 0, 10 ) );
+        return walk;
+    }
+
+    std::vector< Blueprint::Segment > getSegments( const std::vector< Blueprint::Point >& walk )
+    {
+        std::vector< Blueprint::Segment > segments;
+        for( std::size_t sz = 0U; sz != walk.size(); ++sz )
+            segments.push_back( Blueprint::Segment( walk[ sz ], walk[ ( sz + 1U ) % walk.size() ] ) );
+        return segments;
+    }
+
+    std::vector< Blueprint::Point > getQueryPoints( const std::vector< Blueprint::Point >& walk )
+    {
+        using namespace Blueprint;
+        const Kernel::FT third = Kernel::FT( 1 ) / Kernel::FT( 3 );
+        std::vector< Point > points = walk;
+        for( int x = -1; x != 22; x += 3 )
+        {
+            for( int y = -1; y != 12; y += 2 )
+            {
+                points.push_back( Point( x, y ) );
+                points.push_back( Point( Kernel::FT( x ) + third, Kernel::FT( y ) - third ) );
+            }
+        }
+        //exactly on a tooth but not representable as doubles
+        points.push_back( CGAL::midpoint( walk[ 3 ], walk[ 4 ] ) );
+        return points;
+    }
+}
+
+TEST( SegmentBVH, QueriesMatchBruteForce )
+{
+    using namespace Blueprint;
+    const std::vector< Point > walk = getWalk();
+    const std::vector< Segment > segments = getSegments( walk );
+    const SegmentBVH bvh( segments );
+    ASSERT_EQ( bvh.size(), segments.size() );
+
+    const Polygon polygon( walk.begin(), walk.end() );
+    ASSERT_TRUE( polygon.is_simple() );
+
+    const std::vector< Point > points = getQueryPoints( walk );
+    for( const Point& pt : points )
+    {
+        const bool bOnAny = std::any_of( segments.begin(), segments.end(),
+            [ &pt ]( const Segment& segment ){ return segment.has_on( pt ); } );
+        ASSERT_EQ( bvh.isOnAny( pt ), bOnAny ) << pt;
+        if( !bOnAny )
+        {
+            const bool bInside = polygon.bounded_side( pt ) == CGAL::ON_BOUNDED_SIDE;
+            ASSERT_EQ( bvh.countCrossings( pt ) % 2U == 1U, bInside ) << pt;
+        }
+    }
+
+    for( std::size_t i = 0U; i != points.size(); i += 3U )
+    {
+        for( std::size_t j = 1U; j < points.size(); j += 5U )
+        {
+            if( points[ i ] == points[ j ] )
+                continue;
+            const Segment query( points[ i ], points[ j ] );
+
+            std::vector< Point > expected;
+            for( const Segment& segment : segments )
+            {
+                if( const auto result = CGAL::intersection( query, segment ) )
+                {
+                    if( const Point* pPoint = boost::get< Point >( &result.get() ) )
+                        expected.push_back( *pPoint );
+                    else if( const Segment* pOverlap = boost::get< Segment >( &result.get() ) )
+                        expected.insert( expected.end(), { pOverlap->source(), pOverlap->target() } );
+                }
+            }
+            ASSERT_EQ( bvh.doIntersect( query ), !expected.empty() ) << query;
+
+            std::vector< Point > actual;
+            bvh.getIntersections( query, actual );
+            std::sort( expected.begin(), expected.end() );
+            std::sort( actual.begin(), actual.end() );
+            ASSERT_TRUE( expected == actual ) << query;
+        }
+    }
+}
+
+TEST( SegmentBVH, ShootRayMatchesBruteForce )
+{
+    using namespace Blueprint;
+
+    //a fan of walls around the origins so rays hit them at many angles
+    std::vector< Segment > segments;
+    for( int i = 0; i != 24; ++i )
+    {
+        const double x = ( i % 6 ) * 7.0 - 18.0, y = ( i / 6 ) * 9.0 - 14.0;
+        segments.push_back( Segment( Point( x, y ), Point( x + 3.0 + i % 4, y + 5.0 - i % 3 ) ) );
+    }
+    const SegmentBVH bvh( segments );
+
+    const std::vector< Point > origins = { Point( 0.5, 0.25 ), Point( -7.5, 3.25 ), Point( 11.5, -2.75 ) };
+    for( const Point& ptOrigin : origins )
+    {
+        ASSERT_FALSE( bvh.isOnAny( ptOrigin ) );
+        for( int iDirection = 0; iDirection != 32; ++iDirection )
+        {
+            const Vector direction( static_cast< double >( iDirection % 8 - 4 ), 
+                static_cast< double >( iDirection / 8 * 2 - 3 + iDirection % 3 ) );
+            if( direction == CGAL::NULL_VECTOR )
+                continue;
+
+            boost::optional< Point > expected;
+            const Kernel::Ray_2 ray( ptOrigin, direction );
+            for( const Segment& segment : segments )
+            {
+                if( const auto result = CGAL::intersection( ray, segment ) )
+                {
+                    std::vector< Point > hits;
+                    if( const Point* pPoint = boost::get< Point >( &result.get() ) )
+                        hits.push_back( *pPoint );
+                    else if( const Segment* pOverlap = boost::get< Segment >( &result.get() ) )
+                        hits.insert( hits.end(), { pOverlap->source(), pOverlap->target() } );
+                    for( const Point& pt : hits )
+                    {
+                        if( !expected || CGAL::has_smaller_distance_to_point( ptOrigin, pt, expected.get() ) )
+                            expected = pt;
+                    }
+                }
+            }
+
+            const boost::optional< Point > actual = bvh.shootRay( ptOrigin, direction );
+            ASSERT_EQ( static_cast< bool >( actual ), static_cast< bool >( expected ) );
+            if( actual )
+            {
+                ASSERT_EQ( actual.get(), expected.get() );
+            }
+        }
+    }
+}
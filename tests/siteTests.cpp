@@ -0,0 +1,216 @@
+#include "blueprint/blueprint.h"
+#include "blueprint/space.h"
+#include "blueprint/offsetCache.h"
+#include "blueprint/threadPool.h"
+
+#include "blueprintTestUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace
+{
+    using namespace BlueprintTest;
+    
+    Blueprint::Site::EvaluationResults evaluateSites( Blueprint::Blueprint::Ptr pBlueprint, 
+        const Blueprint::Site::EvaluationMode& mode )
+    {
+        Blueprint::Site::EvaluationResults results;
+        pBlueprint->evaluate( mode, results );
+        return results;
+    }
+    
+    //rows of rooms with identical inner spaces, some with self intersecting contours which
+    //report errors, and pasted copies which share their geometry with the originals
+    Blueprint::Blueprint::Ptr makeRooms()
+    {
+        using namespace Blueprint;
+        Polygon bowTie;
+        bowTie.push_back( Point( 20, 20 ) );
+        bowTie.push_back( Point( 30, 30 ) );
+        bowTie.push_back( Point( 30, 20 ) );
+        bowTie.push_back( Point( 20, 30 ) );
+        
+        Blueprint::Blueprint::Ptr pBlueprint( new Blueprint::Blueprint( "test" ) );
+        for( int i = 0; i != 6; ++i )
+        {
+            Space::Ptr pRoom = addSpace( pBlueprint, "room_" + std::to_string( i ), 
+                makeRect( i * 50, 0, i * 50 + 40, 40 ) );
+            addSpace( pRoom, "inner", makeRect( 8, 8, 16, 16 ) );
+            if( i % 2 )
+                addSpace( pRoom, "bad_" + std::to_string( i ), bowTie );
+        }
+        for( int i = 0; i != 3; ++i )
+        {
+            Site::Ptr pOriginal = pBlueprint->getSites()[ i * 2 + 1 ];
+            Site::Ptr pCopy = boost::dynamic_pointer_cast< Site >( 
+                pOriginal->copy( pBlueprint, "copy_" + std::to_string( i ) ) );
+            pCopy->set( 0.0f, 100.0f + i * 50.0f );
+            pBlueprint->add( pCopy );
+        }
+        return pBlueprint;
+    }
+    
+    void expectSameSpaces( Blueprint::Site::Ptr pExpected, Blueprint::Site::Ptr pActual )
+    {
+        using namespace Blueprint;
+        ASSERT_EQ( pExpected->getSites().size(), pActual->getSites().size() );
+        if( Space::Ptr pExpectedSpace = boost::dynamic_pointer_cast< Space >( pExpected ) )
+        {
+            Space::Ptr pActualSpace = boost::dynamic_pointer_cast< Space >( pActual );
+            ASSERT_TRUE( pActualSpace );
+            ASSERT_TRUE( pExpectedSpace->getInteriorPolygon() == pActualSpace->getInteriorPolygon() );
+            ASSERT_TRUE( pExpectedSpace->getExteriorPolygon() == pActualSpace->getExteriorPolygon() );
+        }
+        for( std::size_t sz = 0U; sz != pExpected->getSites().size(); ++sz )
+        {
+            expectSameSpaces( pExpected->getSites()[ sz ], pActual->getSites()[ sz ] );
+        }
+    }
+}
+
+TEST( Site, SkipsUnchangedSubtrees )
+{
+    using namespace Blueprint;
+    Blueprint::Blueprint::Ptr pBlueprint( new Blueprint::Blueprint( "test" ) );
+    Space::Ptr pOuter = addSpace( pBlueprint, "outer", makeRect( 0, 0, 40, 40 ) );
+    Space::Ptr pInner = addSpace( pOuter, "inner", makeRect( 8, 8, 16, 16 ) );
+    Space::Ptr pOther = addSpace( pBlueprint, "other", makeRect( 50, 0, 90, 40 ) );
+    
+    Site::EvaluationMode mode;
+    mode.bArrangement = true;
+    {
+        const Site::EvaluationResults results = evaluateSites( pBlueprint, mode );
+        ASSERT_EQ( results.szSitesEvaluated, 3U );
+        ASSERT_EQ( results.szSitesSkipped, 0U );
+    }
+    
+    //nothing changed
+    {
+        const Site::EvaluationResults results = evaluateSites( pBlueprint, mode );
+        ASSERT_EQ( results.szSitesEvaluated, 0U );
+        ASSERT_EQ( results.szSitesSkipped, 3U );
+    }
+    
+    //a contour change deep in the tree re-evaluates its ancestors but not the sibling
+    pInner->getContour()->set( makeRect( 8, 8, 20, 16 ) );
+    ASSERT_FALSE( pOuter->isEvaluated( mode ) );
+    ASSERT_TRUE( pOther->isEvaluated( mode ) );
+    {
+        const Site::EvaluationResults results = evaluateSites( pBlueprint, mode );
+        ASSERT_EQ( results.szSitesEvaluated, 2U );
+        ASSERT_EQ( results.szSitesSkipped, 1U );
+        ASSERT_TRUE( pInner->isEvaluated( mode ) );
+        ASSERT_TRUE( pOuter->isEvaluated( mode ) );
+    }
+    
+    //as does moving a single point of the contour feature
+    pInner->getContour()->set( 0, 10.0f, 8.0f );
+    {
+        const Site::EvaluationResults results = evaluateSites( pBlueprint, mode );
+        ASSERT_EQ( results.szSitesEvaluated, 2U );
+        ASSERT_EQ( results.szSitesSkipped, 1U );
+    }
+    
+    //the skipped count includes the whole unchanged subtree
+    pOther->getContour()->set( makeRect( 50, 0, 80, 40 ) );
+    {
+        const Site::EvaluationResults results = evaluateSites( pBlueprint, mode );
+        ASSERT_EQ( results.szSitesEvaluated, 1U );
+        ASSERT_EQ( results.szSitesSkipped, 2U );
+    }
+    
+    //and a different mode evaluates everything
+    mode.bClipper = true;
+    {
+        const Site::EvaluationResults results = evaluateSites( pBlueprint, mode );
+        ASSERT_EQ( results.szSitesEvaluated, 3U );
+        ASSERT_EQ( results.szSitesSkipped, 0U );
+    }
+}
+
+TEST( Site, AncestorTransformInvalidatesAbsolute )
+{
+    using namespace Blueprint;
+    Blueprint::Blueprint::Ptr pBlueprint( new Blueprint::Blueprint( "test" ) );
+    Space::Ptr pOuter = addSpace( pBlueprint, "outer", makeRect( 0, 0, 40, 40 ) );
+    Space::Ptr pMiddle = addSpace( pOuter, "middle", makeRect( 4, 4, 30, 30 ) );
+    Space::Ptr pInner = addSpace( pMiddle, "inner", makeRect( 8, 8, 16, 16 ) );
+    pMiddle->setTransform( translate( Vector( 2, 3 ) ) );
+    
+    //populate the cached absolute transforms
+    ASSERT_TRUE( pInner->getAbsoluteTransform()( Point( 1, 1 ) ) == Point( 3, 4 ) );
+    {
+        double x = 1.0, y = 1.0;
+        pInner->getAbsoluteTransformDouble()( x, y );
+        ASSERT_DOUBLE_EQ( x, 3.0 );
+        ASSERT_DOUBLE_EQ( y, 4.0 );
+    }
+    
+    //changing the grandparent must reach the grandchild
+    pOuter->setTransform( translate( Vector( 10, 20 ) ) );
+    ASSERT_TRUE( pInner->getAbsoluteTransform()( Point( 1, 1 ) ) == Point( 13, 24 ) );
+    {
+        double x = 1.0, y = 1.0;
+        pInner->getAbsoluteTransformDouble()( x, y );
+        ASSERT_DOUBLE_EQ( x, 13.0 );
+        ASSERT_DOUBLE_EQ( y, 24.0 );
+    }
+    ASSERT_TRUE( pMiddle->getAbsoluteTransform()( Point( 0, 0 ) ) == Point( 12, 23 ) );
+}
+
+TEST( Site, DiscreteTransformFollowsTransform )
+{
+    using namespace Blueprint;
+    Blueprint::Blueprint::Ptr pBlueprint( new Blueprint::Blueprint( "test" ) );
+    Space::Ptr pOuter = addSpace( pBlueprint, "outer", makeRect( 0, 0, 40, 40 ) );
+    Space::Ptr pInner = addSpace( pOuter, "inner", makeRect( 8, 8, 16, 16 ) );
+    ASSERT_TRUE( pInner->getDiscreteTransform() );
+    
+    pOuter->set( 10.5f, 20.0f );
+    pInner->cmd_rotateLeft( Rect( Point( 8, 8 ), Point( 16, 16 ) ) );
+    pInner->cmd_flipHorizontally( Rect( Point( 8, 8 ), Point( 16, 16 ) ) );
+    for( Space::Ptr pSpace : { pOuter, pInner } )
+    {
+        ASSERT_TRUE( pSpace->getDiscreteTransform() );
+        ASSERT_TRUE( pSpace->getDiscreteTransform() == DiscreteTransform::fromTransform( pSpace->getTransform() ) );
+    }
+    const boost::optional< DiscreteTransform > absolute = pInner->getAbsoluteDiscreteTransform();
+    ASSERT_TRUE( absolute );
+    ASSERT_TRUE( absolute == DiscreteTransform::fromTransform( pInner->getAbsoluteTransform() ) );
+    
+    //an arbitrary transform has no discrete form and neither do its descendants
+    pOuter->setTransform( translate( Vector( 0.25, 0.0 ) ) );
+    ASSERT_FALSE( pOuter->getDiscreteTransform() );
+    ASSERT_TRUE( pInner->getDiscreteTransform() );
+    ASSERT_FALSE( pInner->getAbsoluteDiscreteTransform() );
+    
+    pOuter->setTransform( translate( Vector( 2, 3 ) ) );
+    ASSERT_TRUE( pOuter->getDiscreteTransform() );
+    ASSERT_TRUE( pInner->getAbsoluteDiscreteTransform() );
+}
+
+TEST( Site, ParallelEvaluationMatchesSerial )
+{
+    using namespace Blueprint;
+    Site::EvaluationMode mode;
+    mode.bArrangement = true;
+    
+    //both share offsets through a cache so the skeletons start from the same vertices
+    OffsetCache::setInstance( OffsetCache::Ptr( new OffsetCache ) );
+    Blueprint::Blueprint::Ptr pSerial = makeRooms();
+    const Site::EvaluationResults serial = evaluateSites( pSerial, mode );
+    
+    OffsetCache::setInstance( OffsetCache::Ptr( new OffsetCache ) );
+    ThreadPool pool( 4U );
+    mode.pPool = &pool;
+    Blueprint::Blueprint::Ptr pParallel = makeRooms();
+    const Site::EvaluationResults parallel = evaluateSites( pParallel, mode );
+    OffsetCache::setInstance( OffsetCache::Ptr() );
+    
+    ASSERT_EQ( serial.errors.size(), 6U );
+    ASSERT_EQ( serial.errors, parallel.errors );
+    ASSERT_EQ( serial.szSitesEvaluated, parallel.szSitesEvaluated );
+    expectSameSpaces( pSerial, pParallel );
+}
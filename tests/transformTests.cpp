@@ -194,4 +194,57 @@ TEST( Transform, Decompose )
         }
     }
     
-}*/
\ No newline at end of file
+}*/
+
+TEST( DiscreteTransform, MatchesTransform )
+{
+    std::vector< Blueprint::DiscreteTransform > transforms;
+    for( int iQuarterTurns = 0; iQuarterTurns != 4; ++iQuarterTurns )
+    {
+        for( bool bMirror : { false, true } )
+        {
+            Blueprint::DiscreteTransform orientation = Blueprint::DiscreteTransform::quarterTurns( iQuarterTurns );
+            if( bMirror )
+                orientation = orientation * Blueprint::DiscreteTransform::mirrorX();
+            ASSERT_EQ( orientation.getOrientationCode(), bMirror ? iQuarterTurns + 4 : iQuarterTurns );
+            transforms.push_back( Blueprint::DiscreteTransform::translation( 3, -7 ) * orientation );
+        }
+    }
+    
+    const std::vector< Blueprint::Point > points = 
+    {
+        Blueprint::Point( 0.0, 0.0 ),
+        Blueprint::Point( 1.5, -2.0 ),
+        Blueprint::Point( -123.0, 321.5 ),
+        Blueprint::Point( 0.3, 0.7 )
+    };
+    
+    for( const Blueprint::DiscreteTransform& first : transforms )
+    {
+        ASSERT_TRUE( first * first.inverse() == Blueprint::DiscreteTransform() );
+        
+        const boost::optional< Blueprint::DiscreteTransform > roundTrip = 
+            Blueprint::DiscreteTransform::fromTransform( first.toTransform() );
+        ASSERT_TRUE( roundTrip );
+        ASSERT_TRUE( roundTrip.get() == first );
+        
+        for( const Blueprint::DiscreteTransform& second : transforms )
+        {
+            const Blueprint::Transform composed = first.toTransform() * second.toTransform();
+            for( const Blueprint::Point& pt : points )
+            {
+                ASSERT_EQ( ( first * second )( pt ), composed( pt ) );
+            }
+        }
+    }
+}
+
+TEST( DiscreteTransform, FromTransform )
+{
+    ASSERT_TRUE( Blueprint::DiscreteTransform::fromTransform( 
+        Blueprint::rotate( Math::Angle< 8 >::eNorth ) * Blueprint::translate( Blueprint::Vector( 1.5, -2.0 ) ) ) );
+    ASSERT_TRUE( Blueprint::DiscreteTransform::fromTransform( Blueprint::mirrorY() ) );
+    ASSERT_FALSE( Blueprint::DiscreteTransform::fromTransform( Blueprint::translate( Blueprint::Vector( 0.25, 0.0 ) ) ) );
+    ASSERT_FALSE( Blueprint::DiscreteTransform::fromTransform( 
+        Blueprint::Transform( CGAL::ROTATION, 3, 4, 5 ) ) );
+}
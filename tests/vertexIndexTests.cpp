@@ -0,0 +1,114 @@
+
+#include "blueprint/cgalSettings.h"
+#include "blueprint/vertexIndex.h"
+#include "blueprint/arrangementFormat.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    //floor like grid of rooms
+    void buildGrid( Blueprint::Arrangement& arr, int iSize )
+    {
+        using namespace Blueprint;
+        std::vector< Curve > curves;
+        for( int i = 0; i <= iSize; ++i )
+        {
+            curves.push_back( Curve( Point( i * 4.0, 0.0 ), Point( i * 4.0, iSize * 4.0 ) ) );
+            curves.push_back( Curve( Point( 0.0, i * 4.0 ), Point( iSize * 4.0, i * 4.0 ) ) );
+        }
+        CGAL::insert( arr, curves.begin(), curves.end() );
+    }
+    
+    Blueprint::Arrangement::Vertex_const_handle findByScan( const Blueprint::Arrangement& arr, const Blueprint::Point& pt )
+    {
+        for( auto i = arr.vertices_begin(); i != arr.vertices_end(); ++i )
+        {
+            if( i->point() == pt )
+                return i;
+        }
+        return Blueprint::Arrangement::Vertex_const_handle();
+    }
+}
+
+TEST( VertexIndex, TracksArrangementChanges )
+{
+    using namespace Blueprint;
+    Arrangement arr;
+    buildGrid( arr, 4 );
+    
+    VertexIndex index( arr );
+    ASSERT_EQ( index.size(), arr.number_of_vertices() );
+    ASSERT_TRUE( index.find( Point( 8.0, 8.0 ) ) );
+    ASSERT_FALSE( index.find( Point( 2.0, 2.0 ) ) );
+    
+    //splitting edges creates vertices
+    CGAL::insert( arr, Curve( Point( 2.0, 2.0 ), Point( 6.0, 2.5 ) ) );
+    ASSERT_EQ( index.size(), arr.number_of_vertices() );
+    ASSERT_TRUE( index.find( Point( 2.0, 2.0 ) ) );
+    ASSERT_TRUE( index.find( Point( 4.0, 2.25 ) ) );
+    
+    //removing the curve removes them again
+    CGAL::remove_curve( arr, --arr.curves_end() );
+    ASSERT_EQ( index.size(), arr.number_of_vertices() );
+    ASSERT_FALSE( index.find( Point( 2.0, 2.0 ) ) );
+    
+    //wholesale replacement
+    Arrangement other;
+    buildGrid( other, 2 );
+    arr = other;
+    ASSERT_EQ( index.size(), arr.number_of_vertices() );
+    ASSERT_FALSE( index.find( Point( 16.0, 16.0 ) ) );
+}
+
+TEST( VertexIndex, ResyncsAfterRead )
+{
+    using namespace Blueprint;
+    Arrangement saved;
+    buildGrid( saved, 3 );
+    //an intersection which is not a quantised coordinate
+    CGAL::insert( saved, Curve( Point( 0.0, 1.0 ), Point( 12.0, 2.0 ) ) );
+    CGAL::insert( saved, Curve( Point( 1.0, 0.0 ), Point( 1.0 / 3.0, 12.0 ) ) );
+    
+    for( ArrangementFormat format : { eArrFormat_Text, eArrFormat_Binary } )
+    {
+        std::stringstream ss;
+        writeArrangement( ss, saved, format );
+        
+        Arrangement arr;
+        buildGrid( arr, 5 );
+        VertexIndex index( arr );
+        readArrangement( ss, arr, format );
+        
+        ASSERT_EQ( index.size(), arr.number_of_vertices() );
+        ASSERT_EQ( index.size(), saved.number_of_vertices() );
+        ASSERT_FALSE( index.find( Point( 20.0, 20.0 ) ) );
+        for( auto i = saved.vertices_begin(); i != saved.vertices_end(); ++i )
+        {
+            boost::optional< Arrangement::Vertex_const_handle > vOpt = index.find( i->point() );
+            ASSERT_TRUE( vOpt );
+            ASSERT_TRUE( findByScan( arr, i->point() ) == vOpt.get() );
+        }
+    }
+}
+
+TEST( VertexIndex, MatchesScan )
+{
+    using namespace Blueprint;
+    Arrangement arr;
+    buildGrid( arr, 8 );
+    
+    VertexIndex index( arr );
+    ASSERT_EQ( index.size(), arr.number_of_vertices() );
+    ASSERT_EQ( index.size(), 81U );
+    
+    for( auto i = arr.vertices_begin(); i != arr.vertices_end(); ++i )
+    {
+        boost::optional< Arrangement::Vertex_const_handle > vOpt = index.find( i->point() );
+        ASSERT_TRUE( vOpt );
+        ASSERT_TRUE( findByScan( arr, i->point() ) == vOpt.get() );
+    }
+}